@@ -0,0 +1,237 @@
+#if defined(PLATFORMER_HEAP_HOOKS) && defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include "alloc.h"
+#include "logging.h"
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <assert.h>
+#if defined(__GLIBC__) || defined(__linux__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+#if defined(PLATFORMER_HEAP_HOOKS) && defined(__GLIBC__)
+#define ALLOC_HOOKS 1
+#else
+#define ALLOC_HOOKS 0
+#endif
+
+#ifdef _MSC_VER
+#define ALLOC_THREAD_LOCAL __declspec(thread)
+#else
+#define ALLOC_THREAD_LOCAL _Thread_local
+#endif
+
+// Counters are bumped from any thread, including from inside malloc itself
+typedef struct {
+    SDL_atomic_t frameAllocations;
+    SDL_atomic_t frameBytes;
+    SDL_atomic_t live;
+    SDL_atomic_t totalAllocations;
+} AllocCounter;
+
+static AllocCounter g_counters[ALLOC_TAG_COUNT];
+static ALLOC_THREAD_LOCAL AllocTag g_tag = ALLOC_TAG_OTHER;
+static int g_highWater = 0;
+static int g_frames = 0;
+static bool g_strict = false;
+
+static const char *tagNames[ALLOC_TAG_COUNT] = {
+    "other", "physics", "render", "sprite", "streaming", "logging", "platform", "jobs", "capture", "audio"
+};
+
+const char *allocTagName(AllocTag tag) {
+    return (tag >= 0 && tag < ALLOC_TAG_COUNT) ? tagNames[tag] : "unknown";
+}
+
+AllocTag allocSetTag(AllocTag tag) {
+    AllocTag previous = g_tag;
+    g_tag = tag;
+    return previous;
+}
+
+bool allocHooksActive(void) {
+    return ALLOC_HOOKS;
+}
+
+static size_t usableSize(void *ptr) {
+    if (!ptr) {
+        return 0;
+    }
+#if defined(__GLIBC__) || defined(__linux__)
+    return malloc_usable_size(ptr);
+#elif defined(__APPLE__)
+    return malloc_size(ptr);
+#elif defined(_WIN32)
+    return _msize(ptr);
+#else
+    return 0;
+#endif
+}
+
+static void recordAlloc(AllocTag tag, size_t bytes) {
+    AllocCounter *c = &g_counters[tag];
+    SDL_AtomicAdd(&c->frameAllocations, 1);
+    SDL_AtomicAdd(&c->totalAllocations, 1);
+    SDL_AtomicAdd(&c->frameBytes, (int)bytes);
+    SDL_AtomicAdd(&c->live, (int)bytes);
+}
+
+// Frees are charged to the freeing thread's tag; only the live total is meaningful
+static void recordFree(AllocTag tag, size_t bytes) {
+    SDL_AtomicAdd(&g_counters[tag].live, -(int)bytes);
+}
+
+#if ALLOC_HOOKS
+// Interpose the process-wide allocator so Chipmunk, SDL and libc traffic is
+// counted too. glibc exports its implementation under __libc_* names.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    if (ptr) recordAlloc(g_tag, usableSize(ptr));
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+    void *ptr = __libc_calloc(count, size);
+    if (ptr) recordAlloc(g_tag, usableSize(ptr));
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    size_t old = usableSize(ptr);
+    void *result = __libc_realloc(ptr, size);
+    if (result || size == 0) {
+        recordFree(g_tag, old);
+        if (result) recordAlloc(g_tag, usableSize(result));
+    }
+    return result;
+}
+
+void *memalign(size_t alignment, size_t size) {
+    void *ptr = __libc_memalign(alignment, size);
+    if (ptr) recordAlloc(g_tag, usableSize(ptr));
+    return ptr;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    void *ptr = memalign(alignment, size);
+    if (!ptr) return 12;  // ENOMEM
+    *out = ptr;
+    return 0;
+}
+
+void free(void *ptr) {
+    if (ptr) {
+        recordFree(g_tag, usableSize(ptr));
+        __libc_free(ptr);
+    }
+}
+#endif
+
+// With hooks the interposer does the counting; the wrappers only set the tag
+void *allocMalloc(AllocTag tag, size_t size) {
+    AllocTag previous = allocSetTag(tag);
+    void *ptr = malloc(size);
+    allocSetTag(previous);
+    if (!ALLOC_HOOKS && ptr) recordAlloc(tag, usableSize(ptr) ? usableSize(ptr) : size);
+    return ptr;
+}
+
+void *allocCalloc(AllocTag tag, size_t count, size_t size) {
+    AllocTag previous = allocSetTag(tag);
+    void *ptr = calloc(count, size);
+    allocSetTag(previous);
+    if (!ALLOC_HOOKS && ptr) recordAlloc(tag, usableSize(ptr) ? usableSize(ptr) : count * size);
+    return ptr;
+}
+
+void *allocRealloc(AllocTag tag, void *ptr, size_t size) {
+    size_t old = ALLOC_HOOKS ? 0 : usableSize(ptr);
+    AllocTag previous = allocSetTag(tag);
+    void *result = realloc(ptr, size);
+    allocSetTag(previous);
+    if (!ALLOC_HOOKS && result) {
+        recordFree(tag, old);
+        recordAlloc(tag, usableSize(result) ? usableSize(result) : size);
+    }
+    return result;
+}
+
+void allocFree(AllocTag tag, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    if (!ALLOC_HOOKS) {
+        recordFree(tag, usableSize(ptr));
+    }
+    AllocTag previous = allocSetTag(tag);
+    free(ptr);
+    allocSetTag(previous);
+}
+
+void allocSetStrict(bool strict) {
+    g_strict = strict;
+    g_frames = 0;
+}
+
+void allocFrameEnd(AllocFrameStats *stats) {
+    stats->allocations = 0;
+    stats->bytes = 0;
+    stats->liveBytes = 0;
+    int strictAllocations = 0;
+
+    for (int tag = 0; tag < ALLOC_TAG_COUNT; tag++) {
+        AllocCounter *c = &g_counters[tag];
+        int allocations = SDL_AtomicSet(&c->frameAllocations, 0);
+        stats->tagAllocations[tag] = allocations;
+        stats->allocations += allocations;
+        stats->bytes += SDL_AtomicSet(&c->frameBytes, 0);
+        stats->liveBytes += SDL_AtomicGet(&c->live);
+        if (ALLOC_STRICT_TAGS & (1 << tag)) {
+            strictAllocations += allocations;
+        }
+    }
+    if (stats->liveBytes > g_highWater) {
+        g_highWater = stats->liveBytes;
+    }
+    stats->highWater = g_highWater;
+
+    g_frames++;
+    if (g_strict && g_frames > ALLOC_WARMUP_FRAMES && strictAllocations > 0) {
+        char detail[256];
+        int len = 0;
+        for (int tag = 0; tag < ALLOC_TAG_COUNT && len < (int)sizeof(detail); tag++) {
+            if (stats->tagAllocations[tag] > 0) {
+                len += snprintf(detail + len, sizeof(detail) - len, " %s=%d",
+                                tagNames[tag], stats->tagAllocations[tag]);
+            }
+        }
+        LOG_ERROR("Steady-state frame %d allocated %d times (%d bytes):%s",
+                  g_frames, stats->allocations, stats->bytes, detail);
+        assert(!"heap allocation in the steady-state frame loop");
+    }
+}
+
+void allocReport(void) {
+    LOG_INFO("Heap (%s): high water %d bytes", ALLOC_HOOKS ? "all allocations" : "tracked allocations",
+             g_highWater);
+    for (int tag = 0; tag < ALLOC_TAG_COUNT; tag++) {
+        AllocCounter *c = &g_counters[tag];
+        int total = SDL_AtomicGet(&c->totalAllocations);
+        if (total > 0) {
+            LOG_INFO("  %-10s %8d allocations, %d bytes net", tagNames[tag], total, SDL_AtomicGet(&c->live));
+        }
+    }
+}
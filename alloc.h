@@ -0,0 +1,61 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Subsystems heap traffic is attributed to
+typedef enum {
+    ALLOC_TAG_OTHER,
+    ALLOC_TAG_PHYSICS,       // World, box pool, Chipmunk (with heap hooks)
+    ALLOC_TAG_RENDER,        // Snapshots, box batch, debug geometry
+    ALLOC_TAG_SPRITE,
+    ALLOC_TAG_STREAMING,     // Chunk loader
+    ALLOC_TAG_LOGGING,
+    ALLOC_TAG_PLATFORM,      // SDL events, window title
+    ALLOC_TAG_JOBS,
+    ALLOC_TAG_CAPTURE,       // Frame capture buffers and encoder
+    ALLOC_TAG_AUDIO,         // Decoded sound samples
+    ALLOC_TAG_COUNT
+} AllocTag;
+
+// Tags that must not allocate once the frame loop has warmed up (--alloc-strict)
+#define ALLOC_STRICT_TAGS ((1 << ALLOC_TAG_OTHER) | (1 << ALLOC_TAG_PHYSICS) | \
+                           (1 << ALLOC_TAG_RENDER) | (1 << ALLOC_TAG_SPRITE) | (1 << ALLOC_TAG_JOBS))
+
+// Frames before strict mode starts checking
+#define ALLOC_WARMUP_FRAMES 300
+
+// Heap traffic since the previous allocFrameEnd
+typedef struct {
+    int allocations;
+    int bytes;
+    int tagAllocations[ALLOC_TAG_COUNT];
+    int liveBytes;           // Sampled at frame end
+    int highWater;           // Most live bytes seen at a frame end
+} AllocFrameStats;
+
+// Tag for allocations made by the calling thread from now on. Returns the previous tag.
+AllocTag allocSetTag(AllocTag tag);
+
+const char *allocTagName(AllocTag tag);
+
+// Whether every malloc in the process is counted (PLATFORMER_HEAP_HOOKS on glibc),
+// or only allocations made through the wrappers below
+bool allocHooksActive(void);
+
+// Tracked allocation for our own code
+void *allocMalloc(AllocTag tag, size_t size);
+void *allocCalloc(AllocTag tag, size_t count, size_t size);
+void *allocRealloc(AllocTag tag, void *ptr, size_t size);
+void allocFree(AllocTag tag, void *ptr);
+
+// Collect and reset per-frame counters. In strict mode, after the warmup,
+// an allocation from a strict tag is logged and asserts.
+void allocFrameEnd(AllocFrameStats *stats);
+void allocSetStrict(bool strict);
+
+// Log lifetime totals per tag
+void allocReport(void);
+
+#endif // ALLOC_H
@@ -0,0 +1,319 @@
+#include "audio.h"
+#include "alloc.h"
+#include "logging.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define AUDIO_MASTER_GAIN 0.5f
+
+static const char *soundNames[AUDIO_SOUND_COUNT] = {"impact", "jump", "landing"};
+
+// Sustained rate and burst per sound
+static const double limiterRates[AUDIO_SOUND_COUNT][2] = {
+    [AUDIO_SOUND_IMPACT]  = {30.0, 6.0},
+    [AUDIO_SOUND_JUMP]    = {8.0, 2.0},
+    [AUDIO_SOUND_LANDING] = {8.0, 2.0},
+};
+
+// ---- Sample preparation (startup only) ----
+
+static bool allocateSample(AudioSample *sample, int length) {
+    sample->data = allocMalloc(ALLOC_TAG_AUDIO, sizeof(float) * (size_t)length);
+    sample->length = sample->data ? length : 0;
+    return sample->data != NULL;
+}
+
+// Decode a WAV of any format into mono float at the mixer rate
+static bool loadSample(AudioSample *sample, const char *path) {
+    SDL_AudioSpec spec;
+    Uint8 *buffer = NULL;
+    Uint32 bytes = 0;
+    if (!SDL_LoadWAV(path, &spec, &buffer, &bytes)) {
+        return false;
+    }
+
+    bool loaded = false;
+    SDL_AudioStream *stream = SDL_NewAudioStream(spec.format, spec.channels, spec.freq,
+                                                 AUDIO_F32SYS, 1, AUDIO_SAMPLE_RATE);
+    if (stream && SDL_AudioStreamPut(stream, buffer, (int)bytes) == 0 && SDL_AudioStreamFlush(stream) == 0) {
+        int available = SDL_AudioStreamAvailable(stream);
+        if (available > 0 && allocateSample(sample, available / (int)sizeof(float))) {
+            SDL_AudioStreamGet(stream, sample->data, sample->length * (int)sizeof(float));
+            loaded = true;
+        }
+    }
+    if (!loaded) {
+        LOG_WARNING("Failed to decode %s: %s", path, SDL_GetError());
+    }
+    if (stream) {
+        SDL_FreeAudioStream(stream);
+    }
+    SDL_FreeWAV(buffer);
+    return loaded;
+}
+
+static float noise(unsigned int *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return (float)(*state >> 8) / 8388608.0f - 1.0f;
+}
+
+// Built-in sounds, so the game has audio without any asset files
+static bool synthesizeSample(AudioSample *sample, AudioSound sound) {
+    static const float durations[AUDIO_SOUND_COUNT] = {0.12f, 0.15f, 0.18f};
+    if (!allocateSample(sample, (int)(durations[sound] * AUDIO_SAMPLE_RATE))) {
+        return false;
+    }
+
+    unsigned int state = 12345u + (unsigned int)sound;
+    float phase = 0.0f;
+    float smoothed = 0.0f;
+    for (int i = 0; i < sample->length; i++) {
+        float t = (float)i / AUDIO_SAMPLE_RATE;
+        float progress = (float)i / sample->length;
+        float value = 0.0f;
+        switch (sound) {
+            case AUDIO_SOUND_IMPACT:
+                // Noise crack over a short low knock
+                phase += 2.0f * (float)M_PI * 90.0f / AUDIO_SAMPLE_RATE;
+                value = 0.5f * noise(&state) * expf(-t * 45.0f) + 0.6f * sinf(phase) * expf(-t * 25.0f);
+                break;
+            case AUDIO_SOUND_JUMP:
+                // Rising chirp
+                phase += 2.0f * (float)M_PI * (300.0f + 400.0f * progress) / AUDIO_SAMPLE_RATE;
+                value = 0.4f * sinf(phase) * fminf(t / 0.005f, 1.0f) * (1.0f - progress);
+                break;
+            case AUDIO_SOUND_LANDING:
+                // Falling thump with a little low-passed grit
+                phase += 2.0f * (float)M_PI * (120.0f - 70.0f * progress) / AUDIO_SAMPLE_RATE;
+                smoothed += (noise(&state) - smoothed) * 0.05f;
+                value = (0.7f * sinf(phase) + 0.8f * smoothed) * expf(-t * 18.0f);
+                break;
+            default:
+                break;
+        }
+        sample->data[i] = value;
+    }
+    return true;
+}
+
+// ---- Mixer (audio callback) ----
+
+static void startVoice(AudioSystem *audio, const AudioCommand *command) {
+    const AudioSample *sample = &audio->samples[command->sound];
+    if (sample->length < 2) {
+        return;
+    }
+
+    // A free voice, or else the one with the least left to say
+    AudioVoice *voice = NULL;
+    float quietest = INFINITY;
+    for (int i = 0; i < AUDIO_VOICES; i++) {
+        AudioVoice *candidate = &audio->voices[i];
+        if (!candidate->sample) {
+            voice = candidate;
+            break;
+        }
+        float remaining = (candidate->gainLeft + candidate->gainRight) *
+                          (1.0f - candidate->position / candidate->sample->length);
+        if (remaining < quietest) {
+            quietest = remaining;
+            voice = candidate;
+        }
+    }
+    if (voice->sample) {
+        SDL_AtomicAdd(&audio->stolen, 1);
+    }
+
+    // Constant-power pan
+    float angle = (command->pan + 1.0f) * 0.25f * (float)M_PI;
+    voice->sample = sample;
+    voice->position = 0.0f;
+    voice->step = command->pitch;
+    voice->gainLeft = command->gain * cosf(angle);
+    voice->gainRight = command->gain * sinf(angle);
+    SDL_AtomicAdd(&audio->started, 1);
+}
+
+static void mixVoice(AudioVoice *voice, float *out, int frames) {
+    const float *data = voice->sample->data;
+    float end = (float)(voice->sample->length - 1);
+    float position = voice->position;
+
+    for (int i = 0; i < frames; i++) {
+        if (position >= end) {
+            voice->sample = NULL;
+            return;
+        }
+        int index = (int)position;
+        float frac = position - (float)index;
+        float value = data[index] + (data[index + 1] - data[index]) * frac;
+        out[i * 2] += value * voice->gainLeft;
+        out[i * 2 + 1] += value * voice->gainRight;
+        position += voice->step;
+    }
+    voice->position = position;
+}
+
+static void audioCallback(void *userdata, Uint8 *stream, int length) {
+    AudioSystem *audio = userdata;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    // Drain requests from the game thread
+    int tail = SDL_AtomicGet(&audio->tail);
+    int head = SDL_AtomicGet(&audio->head);
+    for (; tail != head; tail++) {
+        startVoice(audio, &audio->commands[tail & (AUDIO_COMMAND_CAPACITY - 1)]);
+    }
+    SDL_AtomicSet(&audio->tail, tail);  // Release the slots after reading them
+
+    float *out = (float *)stream;
+    int frames = length / (int)(sizeof(float) * 2);
+    memset(stream, 0, (size_t)length);
+
+    int active = 0;
+    for (int i = 0; i < AUDIO_VOICES; i++) {
+        if (audio->voices[i].sample) {
+            mixVoice(&audio->voices[i], out, frames);
+            active += audio->voices[i].sample != NULL;
+        }
+    }
+    // Rational tanh approximation: transparent at low levels, rounds off pile-ups instead of clipping
+    for (int i = 0; i < frames * 2; i++) {
+        float value = out[i] * AUDIO_MASTER_GAIN;
+        value = value > 3.0f ? 3.0f : value < -3.0f ? -3.0f : value;
+        out[i] = value * (27.0f + value * value) / (27.0f + 9.0f * value * value);
+    }
+
+    int ns = (int)((SDL_GetPerformanceCounter() - start) * 1000000000ull / audio->frequency);
+    SDL_AtomicSet(&audio->lastCallbackNs, ns);
+    int avg = SDL_AtomicGet(&audio->avgCallbackNs);
+    SDL_AtomicSet(&audio->avgCallbackNs, avg == 0 ? ns : avg + (ns - avg) / 64);
+    if (ns > SDL_AtomicGet(&audio->maxCallbackNs)) {
+        SDL_AtomicSet(&audio->maxCallbackNs, ns);  // Only the callback writes it
+    }
+    SDL_AtomicSet(&audio->activeVoices, active);
+    SDL_AtomicAdd(&audio->callbacks, 1);
+}
+
+// ---- Game thread ----
+
+bool audioInit(AudioSystem *audio) {
+    memset(audio, 0, sizeof(*audio));
+    audio->frequency = SDL_GetPerformanceFrequency();
+
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        LOG_WARNING("No audio: %s", SDL_GetError());
+        return false;
+    }
+
+    for (int i = 0; i < AUDIO_SOUND_COUNT; i++) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s.wav", AUDIO_SOUND_DIRECTORY, soundNames[i]);
+        bool ready = loadSample(&audio->samples[i], path) || synthesizeSample(&audio->samples[i], (AudioSound)i);
+        if (!ready) {
+            LOG_ERROR("Failed to prepare sound %s", soundNames[i]);
+            audioDestroy(audio);
+            return false;
+        }
+
+        AudioLimiter *limiter = &audio->limiters[i];
+        limiter->perSecond = limiterRates[i][0];
+        limiter->burst = limiterRates[i][1];
+        limiter->tokens = limiter->burst;
+        limiter->lastRefill = SDL_GetPerformanceCounter();
+    }
+
+    SDL_AudioSpec want = {0};
+    want.freq = AUDIO_SAMPLE_RATE;
+    want.format = AUDIO_F32SYS;
+    want.channels = 2;
+    want.samples = AUDIO_BUFFER_FRAMES;
+    want.callback = audioCallback;
+    want.userdata = audio;
+    // No allowed changes: SDL converts if the device wants something else
+    audio->device = SDL_OpenAudioDevice(NULL, 0, &want, &audio->spec, 0);
+    if (!audio->device) {
+        LOG_WARNING("Failed to open audio device: %s", SDL_GetError());
+        audioDestroy(audio);
+        return false;
+    }
+
+    audio->enabled = true;
+    SDL_PauseAudioDevice(audio->device, 0);
+    LOG_INFO("Audio: %s driver, %d Hz, %d frames per callback, %d voices",
+             SDL_GetCurrentAudioDriver(), audio->spec.freq, audio->spec.samples, AUDIO_VOICES);
+    return true;
+}
+
+void audioDestroy(AudioSystem *audio) {
+    if (audio->device) {
+        SDL_CloseAudioDevice(audio->device);  // Waits for the callback to finish
+        AudioStats stats = audioStats(audio);
+        LOG_INFO("Audio: %lu callbacks, avg %.1f us, max %.1f us of %.0f us, %lu sounds, "
+                 "%lu stolen, %lu rate limited, %lu queue full",
+                 stats.callbacks, stats.avgCallbackUs,
+                 stats.maxCallbackUs, stats.bufferUs, stats.started, stats.stolen,
+                 stats.rateLimited, stats.queueFull);
+    }
+    for (int i = 0; i < AUDIO_SOUND_COUNT; i++) {
+        allocFree(ALLOC_TAG_AUDIO, audio->samples[i].data);
+    }
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    memset(audio, 0, sizeof(*audio));
+}
+
+static bool takeToken(AudioLimiter *limiter, Uint64 frequency) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    limiter->tokens += (double)(now - limiter->lastRefill) / frequency * limiter->perSecond;
+    limiter->lastRefill = now;
+    if (limiter->tokens > limiter->burst) {
+        limiter->tokens = limiter->burst;
+    }
+    if (limiter->tokens < 1.0) {
+        return false;
+    }
+    limiter->tokens -= 1.0;
+    return true;
+}
+
+bool audioPlay(AudioSystem *audio, AudioSound sound, float gain, float pan, float pitch) {
+    if (!audio->enabled) {
+        return false;
+    }
+    if (!takeToken(&audio->limiters[sound], audio->frequency)) {
+        audio->rateLimited++;
+        return false;
+    }
+
+    int head = SDL_AtomicGet(&audio->head);
+    if (head - SDL_AtomicGet(&audio->tail) >= AUDIO_COMMAND_CAPACITY) {
+        audio->queueFull++;
+        return false;
+    }
+    AudioCommand *command = &audio->commands[head & (AUDIO_COMMAND_CAPACITY - 1)];
+    command->sound = sound;
+    command->gain = gain < 0.0f ? 0.0f : gain > 1.0f ? 1.0f : gain;
+    command->pan = pan < -1.0f ? -1.0f : pan > 1.0f ? 1.0f : pan;
+    command->pitch = pitch > 0.0f ? pitch : 1.0f;
+    SDL_AtomicSet(&audio->head, head + 1);  // Publish after the slot is written
+    return true;
+}
+
+AudioStats audioStats(AudioSystem *audio) {
+    AudioStats stats = {0};
+    stats.callbacks = (unsigned long)SDL_AtomicGet(&audio->callbacks);
+    stats.lastCallbackUs = SDL_AtomicGet(&audio->lastCallbackNs) / 1000.0;
+    stats.avgCallbackUs = SDL_AtomicGet(&audio->avgCallbackNs) / 1000.0;
+    stats.maxCallbackUs = SDL_AtomicGet(&audio->maxCallbackNs) / 1000.0;
+    stats.bufferUs = audio->spec.freq ? audio->spec.samples * 1e6 / audio->spec.freq : 0.0;
+    stats.activeVoices = SDL_AtomicGet(&audio->activeVoices);
+    stats.started = (unsigned long)SDL_AtomicGet(&audio->started);
+    stats.stolen = (unsigned long)SDL_AtomicGet(&audio->stolen);
+    stats.rateLimited = audio->rateLimited;
+    stats.queueFull = audio->queueFull;
+    return stats;
+}
@@ -0,0 +1,106 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_BUFFER_FRAMES 256         // ~5 ms per callback
+#define AUDIO_VOICES 16                 // Fixed mixer voices; more sounds steal the quietest
+#define AUDIO_COMMAND_CAPACITY 256      // Power of two
+#define AUDIO_SOUND_DIRECTORY "assets/sounds"
+
+typedef enum {
+    AUDIO_SOUND_IMPACT,
+    AUDIO_SOUND_JUMP,
+    AUDIO_SOUND_LANDING,
+    AUDIO_SOUND_COUNT
+} AudioSound;
+
+// Mono float PCM at AUDIO_SAMPLE_RATE, decoded once at startup
+typedef struct {
+    float *data;
+    int length;                     // Frames
+} AudioSample;
+
+// Game thread -> audio callback
+typedef struct {
+    AudioSound sound;
+    float gain;                     // 0..1
+    float pan;                      // -1 left .. 1 right
+    float pitch;                    // Playback rate, 1 = original
+} AudioCommand;
+
+// Owned by the callback
+typedef struct {
+    const AudioSample *sample;      // NULL = free
+    float position;                 // Frames into the sample
+    float step;
+    float gainLeft, gainRight;
+} AudioVoice;
+
+// Token bucket per sound, so a collapsing pile can't flood the queue
+typedef struct {
+    double tokens;
+    double perSecond;
+    double burst;
+    Uint64 lastRefill;
+} AudioLimiter;
+
+// Live numbers, readable from any thread
+typedef struct {
+    unsigned long callbacks;
+    double lastCallbackUs;
+    double avgCallbackUs;           // Moving average
+    double maxCallbackUs;
+    double bufferUs;                // Audio length of one callback, the hard deadline
+    int activeVoices;
+    unsigned long started;
+    unsigned long stolen;           // Voices cut off for a new sound
+    unsigned long rateLimited;      // Requests refused by the limiter
+    unsigned long queueFull;        // Requests the callback hadn't drained yet
+} AudioStats;
+
+// Audio subsystem. The game thread only pushes commands into a lock-free
+// single producer / single consumer queue; the SDL callback drains it,
+// starts voices and mixes. The callback never locks or allocates.
+typedef struct {
+    bool enabled;
+    SDL_AudioDeviceID device;
+    SDL_AudioSpec spec;
+    AudioSample samples[AUDIO_SOUND_COUNT];
+
+    AudioCommand commands[AUDIO_COMMAND_CAPACITY];
+    SDL_atomic_t head;              // Next slot to write (game thread)
+    SDL_atomic_t tail;              // Next slot to read (callback)
+
+    AudioVoice voices[AUDIO_VOICES];
+    AudioLimiter limiters[AUDIO_SOUND_COUNT];
+    Uint64 frequency;               // Performance counter ticks per second
+
+    // Game thread counters
+    unsigned long rateLimited;
+    unsigned long queueFull;
+
+    // Callback counters, published through atomics
+    SDL_atomic_t callbacks;
+    SDL_atomic_t lastCallbackNs;
+    SDL_atomic_t avgCallbackNs;
+    SDL_atomic_t maxCallbackNs;
+    SDL_atomic_t activeVoices;
+    SDL_atomic_t started;
+    SDL_atomic_t stolen;
+} AudioSystem;
+
+// Open the default device (SDL_AUDIODRIVER=dummy or disk work headless) and
+// decode the sounds: WAVs from AUDIO_SOUND_DIRECTORY when present, otherwise
+// synthesized. Returns false and stays silent if there is no audio device.
+bool audioInit(AudioSystem *audio);
+void audioDestroy(AudioSystem *audio);
+
+// Game thread: request a sound. Returns false if it was rate limited or the queue was full.
+bool audioPlay(AudioSystem *audio, AudioSound sound, float gain, float pan, float pitch);
+
+AudioStats audioStats(AudioSystem *audio);
+
+#endif // AUDIO_H
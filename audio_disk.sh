@@ -0,0 +1,62 @@
+#!/bin/sh
+# Run a box rain with SDL's disk audio driver, which calls the mixer on its
+# usual schedule and writes the output to a file. Fails unless the callback
+# ran, impacts produced sounds, the output isn't silent and the callback
+# stayed well inside its buffer time.
+#
+#   ./audio_disk.sh [path/to/platformer]
+#
+# AUDIO_FRAMES overrides the frame count.
+
+GAME=${1:-./platformer}
+FRAMES=${AUDIO_FRAMES:-300}
+
+case "$GAME" in
+    /*) ;;
+    *) GAME="$(pwd)/$GAME" ;;
+esac
+
+export SDL_VIDEODRIVER=${SDL_VIDEODRIVER:-dummy}
+export SDL_AUDIODRIVER=disk
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+export SDL_DISKAUDIOFILE="$WORK/audio.raw"
+
+(cd "$WORK" && "$GAME" --scenario rain --frames "$FRAMES" > out.txt 2>&1)
+STATUS=$?
+
+SUMMARY=$(grep "^audio:" "$WORK/out.txt")
+if [ -z "$SUMMARY" ]; then
+    echo "no audio summary:"
+    cat "$WORK/out.txt"
+    exit 1
+fi
+echo "$SUMMARY"
+
+FAILED=0
+CALLBACKS=$(echo "$SUMMARY" | sed 's/audio: \([0-9]*\) callbacks.*/\1/')
+SOUNDS=$(echo "$SUMMARY" | sed 's/.* \([0-9]*\) sounds.*/\1/')
+MAX_US=$(echo "$SUMMARY" | sed 's/.*max \([0-9]*\)\.[0-9]* us.*/\1/')
+BUFFER_US=$(echo "$SUMMARY" | sed 's/.*buffer \([0-9]*\) us.*/\1/')
+if [ "$CALLBACKS" -eq 0 ]; then
+    echo "the audio callback never ran"
+    FAILED=1
+fi
+if [ "$SOUNDS" -eq 0 ]; then
+    echo "no sounds were played"
+    FAILED=1
+fi
+# One slow callback is an audible dropout; allow a quarter of the buffer
+if [ "$MAX_US" -gt $((BUFFER_US / 4)) ]; then
+    echo "slowest callback took ${MAX_US} us of a ${BUFFER_US} us buffer"
+    FAILED=1
+fi
+if [ ! -s "$SDL_DISKAUDIOFILE" ] || [ "$(tr -d '\000' < "$SDL_DISKAUDIOFILE" | head -c 1 | wc -c)" -eq 0 ]; then
+    echo "disk audio output is missing or silent"
+    FAILED=1
+fi
+if [ "$STATUS" -ne 0 ]; then
+    echo "exit status: $STATUS"
+    FAILED=1
+fi
+exit $FAILED
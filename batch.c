@@ -0,0 +1,269 @@
+#include "batch.h"
+#include "world.h"
+#include "jobs.h"
+#include "simulation.h"
+#include "logging.h"
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_DT (1.0 / 60.0)
+#define BATCH_WORLD_BOXES 1024      // Pool per world when the scenario count is smaller
+
+// One independent world and what it measured. Only the job stepping it touches it.
+typedef struct {
+    World world;
+    unsigned int seed;
+    InputScript generated;       // Scripted input when no recording is shared
+    const InputScript *input;
+    int inputCursor;
+    unsigned long tick;
+    int bodies;
+
+    double stepMsTotal;
+    double stepMsMax;
+    cpFloat maxPlayerX;
+    bool ready;
+} BatchWorld;
+
+typedef struct {
+    BatchWorld *worlds;
+    int steps;
+} BatchRun;
+
+bool parseBatchMode(const char *name, BatchMode *mode) {
+    if (strcmp(name, "lockstep") == 0) {
+        *mode = BATCH_LOCKSTEP;
+    } else if (strcmp(name, "free") == 0) {
+        *mode = BATCH_FREE_RUNNING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool addInputEvent(InputScript *script, unsigned long tick, int held) {
+    if (script->count == script->capacity) {
+        int capacity = script->capacity ? script->capacity * 2 : 64;
+        InputEvent *events = realloc(script->events, sizeof(InputEvent) * capacity);
+        if (!events) {
+            return false;
+        }
+        script->events = events;
+        script->capacity = capacity;
+    }
+    script->events[script->count].tick = tick;
+    script->events[script->count].held = held;
+    script->count++;
+    return true;
+}
+
+bool inputScriptLoad(InputScript *script, const char *path) {
+    memset(script, 0, sizeof(*script));
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        LOG_ERROR("Failed to open input recording %s", path);
+        return false;
+    }
+
+    char line[128];
+    unsigned long tick;
+    int held;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%lu %d", &tick, &held) == 2) {
+            ok = addInputEvent(script, tick, held);
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+static unsigned int nextRandom(unsigned int *state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7fff;
+}
+
+// Runs of walking left or right with the odd jump and pause
+bool inputScriptGenerate(InputScript *script, unsigned int seed, int steps) {
+    memset(script, 0, sizeof(*script));
+    unsigned int state = seed;
+    unsigned long tick = 0;
+    while (tick < (unsigned long)steps) {
+        int held = 0;
+        switch (nextRandom(&state) % 4) {
+            case 0: held = INPUT_RIGHT; break;
+            case 1: held = INPUT_LEFT; break;
+            case 2: held = INPUT_RIGHT | INPUT_JUMP; break;
+            case 3: held = 0; break;
+        }
+        if (!addInputEvent(script, tick, held)) {
+            return false;
+        }
+        tick += 15 + nextRandom(&state) % 90;
+    }
+    return true;
+}
+
+void inputScriptFree(InputScript *script) {
+    free(script->events);
+    memset(script, 0, sizeof(*script));
+}
+
+int inputScriptHeld(const InputScript *script, unsigned long tick, int *cursor) {
+    while (*cursor + 1 < script->count && script->events[*cursor + 1].tick <= tick) {
+        (*cursor)++;
+    }
+    if (*cursor < script->count && script->events[*cursor].tick <= tick) {
+        return script->events[*cursor].held;
+    }
+    return 0;
+}
+
+// Same order as simulationTick: despawn, player input, step
+static void stepBatchWorld(BatchWorld *bw) {
+    World *world = &bw->world;
+    despawnOutOfBounds(world);
+
+    int held = inputScriptHeld(bw->input, bw->tick, &bw->inputCursor);
+    if (world->playerBody) {
+        updatePlayerMovement(world->space, world->playerBody,
+                             held & INPUT_LEFT, held & INPUT_RIGHT, held & INPUT_JUMP);
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    cpSpaceStep(world->space, BATCH_DT);
+    double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    bw->stepMsTotal += ms;
+    if (ms > bw->stepMsMax) {
+        bw->stepMsMax = ms;
+    }
+    if (world->playerBody) {
+        cpFloat x = cpBodyGetPosition(world->playerBody).x;
+        if (x > bw->maxPlayerX) {
+            bw->maxPlayerX = x;
+        }
+    }
+    bw->tick++;
+}
+
+static void stepWorldsJob(void *data, int begin, int end) {
+    BatchRun *run = data;
+    for (int i = begin; i < end; i++) {
+        if (run->worlds[i].ready) {
+            stepBatchWorld(&run->worlds[i]);
+        }
+    }
+}
+
+static void runWorldsJob(void *data, int begin, int end) {
+    BatchRun *run = data;
+    for (int i = begin; i < end; i++) {
+        BatchWorld *bw = &run->worlds[i];
+        for (int s = 0; bw->ready && s < run->steps; s++) {
+            stepBatchWorld(bw);
+        }
+    }
+}
+
+static bool initBatchWorld(BatchWorld *bw, const BatchConfig *config, const InputScript *recorded, int index) {
+    memset(bw, 0, sizeof(*bw));
+    bw->seed = config->seed + (unsigned int)index;
+
+    // Pools are preallocated, so size them for the scenario rather than MAX_BOXES
+    int capacity = config->scenarioCount + 64 > BATCH_WORLD_BOXES ? config->scenarioCount + 64 : BATCH_WORLD_BOXES;
+    if (!createWorld(&bw->world, capacity)) {
+        return false;
+    }
+    if (!spawnPlayer(&bw->world)) {
+        destroyWorld(&bw->world);
+        return false;
+    }
+    bw->maxPlayerX = cpBodyGetPosition(bw->world.playerBody).x;
+    if (config->scenario != SCENARIO_NONE) {
+        spawnScenario(&bw->world, config->scenario, config->scenarioCount, bw->seed);
+    }
+    bw->bodies = bw->world.boxCount;
+
+    if (recorded) {
+        bw->input = recorded;
+    } else {
+        if (!inputScriptGenerate(&bw->generated, bw->seed, config->steps)) {
+            destroyWorld(&bw->world);
+            return false;
+        }
+        bw->input = &bw->generated;
+    }
+    bw->ready = true;
+    return true;
+}
+
+bool runBatch(const BatchConfig *config, FILE *out) {
+    InputScript recorded = {0};
+    if (config->inputPath && !inputScriptLoad(&recorded, config->inputPath)) {
+        return false;
+    }
+
+    BatchWorld *worlds = calloc(config->worlds, sizeof(BatchWorld));
+    JobSystem jobs;
+    if (!worlds || !jobSystemInit(&jobs, config->workers)) {
+        free(worlds);
+        inputScriptFree(&recorded);
+        return false;
+    }
+
+    int ready = 0;
+    for (int i = 0; i < config->worlds; i++) {
+        if (initBatchWorld(&worlds[i], config, config->inputPath ? &recorded : NULL, i)) {
+            ready++;
+        } else {
+            LOG_WARNING("Batch world %d failed to build", i);
+        }
+    }
+
+    // One world per job; stealing balances worlds that cost more than others
+    BatchRun run = {worlds, config->steps};
+    JobCounter counter = {{0}};
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (config->mode == BATCH_LOCKSTEP) {
+        for (int s = 0; s < config->steps; s++) {
+            jobParallelFor(&jobs, config->worlds, 1, stepWorldsJob, &run, &counter);
+            jobWait(&jobs, &counter);
+        }
+    } else {
+        jobParallelFor(&jobs, config->worlds, 1, runWorldsJob, &run, &counter);
+        jobWait(&jobs, &counter);
+    }
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    fprintf(out, "world,seed,bodies,steps,step_ms_avg,step_ms_max,player_x,player_y,max_player_x,final_bodies\n");
+    for (int i = 0; i < config->worlds; i++) {
+        BatchWorld *bw = &worlds[i];
+        if (!bw->ready) {
+            continue;
+        }
+        cpVect player = bw->world.playerBody ? cpBodyGetPosition(bw->world.playerBody) : cpvzero;
+        fprintf(out, "%d,%u,%d,%lu,%.4f,%.4f,%.1f,%.1f,%.1f,%d\n",
+                i, bw->seed, bw->bodies, bw->tick,
+                bw->tick ? bw->stepMsTotal / bw->tick : 0.0, bw->stepMsMax,
+                player.x, player.y, bw->maxPlayerX, bw->world.boxCount);
+    }
+
+    double worldSteps = (double)ready * config->steps;
+    fprintf(out, "# %d worlds x %d steps (%s) on %d workers: %.2f s, %.0f world-steps/s, %d jobs stolen\n",
+            ready, config->steps, config->mode == BATCH_LOCKSTEP ? "lockstep" : "free",
+            jobs.workerCount, seconds, seconds > 0.0 ? worldSteps / seconds : 0.0,
+            SDL_AtomicGet(&jobs.stolen));
+
+    jobSystemDestroy(&jobs);
+    for (int i = 0; i < config->worlds; i++) {
+        if (worlds[i].ready) {
+            destroyWorld(&worlds[i].world);
+            inputScriptFree(&worlds[i].generated);
+        }
+    }
+    free(worlds);
+    inputScriptFree(&recorded);
+    return ready == config->worlds;
+}
@@ -0,0 +1,54 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "scenario.h"
+
+// How batch worlds are advanced
+typedef enum {
+    BATCH_LOCKSTEP,          // Every world finishes tick N before any starts N + 1
+    BATCH_FREE_RUNNING       // Each world runs all its steps as one job
+} BatchMode;
+
+// Held input over time: each event sets the held InputBits from its tick on
+typedef struct {
+    unsigned long tick;
+    int held;
+} InputEvent;
+
+typedef struct {
+    InputEvent *events;
+    int count;
+    int capacity;
+} InputScript;
+
+typedef struct {
+    int worlds;
+    int steps;
+    BatchMode mode;
+    int workers;             // Job system workers, 0 = one per CPU
+    ScenarioType scenario;   // Loaded into every world, world i uses seed + i
+    int scenarioCount;
+    unsigned int seed;
+    const char *inputPath;   // Recorded input replayed by every world, NULL = scripted
+} BatchConfig;
+
+bool parseBatchMode(const char *name, BatchMode *mode);
+
+// Read a file written by the input recorder ("tick held" per line)
+bool inputScriptLoad(InputScript *script, const char *path);
+
+// Deterministic walk/jump pattern for `steps` ticks
+bool inputScriptGenerate(InputScript *script, unsigned int seed, int steps);
+
+void inputScriptFree(InputScript *script);
+
+// Held bits at `tick`. `cursor` caches the position for monotonically increasing ticks.
+int inputScriptHeld(const InputScript *script, unsigned long tick, int *cursor);
+
+// Build and step `worlds` independent worlds headless on the job system.
+// Writes one CSV line per world and an aggregate world-steps/sec summary.
+bool runBatch(const BatchConfig *config, FILE *out);
+
+#endif // BATCH_H
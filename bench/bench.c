@@ -0,0 +1,636 @@
+// Performance regression suite. Each benchmark reports one number (lower is
+// better) that is compared against a ceiling in a checked-in baseline.
+#include <SDL2/SDL.h>
+#include <chipmunk/chipmunk.h>
+#include "world.h"
+#include "scenario.h"
+#include "sprite.h"
+#include "snapshot.h"
+#include "render.h"
+#include "jobs.h"
+#include "net.h"
+#include "particles.h"
+#include "effects.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define BENCH_REPEATS 5             // Median of this many runs is reported
+#define BENCH_DEFAULT_TOLERANCE 0.25
+#define BENCH_BASELINE_MARGIN 1.25  // --write-baseline ceiling = measured * margin; the tolerance comes on top
+
+typedef enum {
+    SUITE_MICRO = 1 << 0,
+    SUITE_MACRO = 1 << 1
+} BenchSuite;
+
+// Shared state some benchmarks need
+typedef struct {
+    JobSystem jobs;
+    SDL_Window *window;             // Hidden, on the dummy video driver in CI
+    SDL_Renderer *renderer;
+} BenchContext;
+
+typedef double (*BenchFunc)(BenchContext *context);
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    BenchSuite suite;
+    BenchFunc run;
+} Benchmark;
+
+static double secondsSince(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+// ---- Micro benchmarks ----
+
+static double benchSpawnBox(BenchContext *context) {
+    (void)context;
+    const int count = 2000;
+    World world;
+    if (!createWorld(&world, count)) {
+        return -1.0;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < count; i++) {
+        spawnBox(&world, cpv(20 + (i % 38) * 20, 100 + (i / 38) * 20), 18, 18);
+    }
+    while (world.boxCount > 0) {
+        despawnBox(&world, world.boxCount - 1);
+    }
+    double us = secondsSince(start) * 1e6 / count;
+
+    destroyWorld(&world);
+    return us;
+}
+
+static double benchIsOnGround(BenchContext *context) {
+    (void)context;
+    const int queries = 20000;
+    World world;
+    if (!createWorld(&world, 600)) {
+        return -1.0;
+    }
+    if (!spawnPlayer(&world)) {
+        destroyWorld(&world);
+        return -1.0;
+    }
+    // On the floor at the edge, clear of the pile that collapses around the centre
+    cpBodySetPosition(world.playerBody, cpv(BOX_SIZE, GROUND_HEIGHT + BOX_SIZE / 2));
+    spawnScenario(&world, SCENARIO_PILE, 500, 1);
+    for (int i = 0; i < 120; i++) {
+        cpSpaceStep(world.space, 1.0 / 60.0);
+    }
+
+    int grounded = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < queries; i++) {
+        grounded += isOnGround(world.space, world.playerBody);
+    }
+    double us = secondsSince(start) * 1e6 / queries;
+
+    destroyWorld(&world);
+    // The player has rested on the floor for two seconds; any miss is a broken query
+    if (grounded != queries) {
+        fprintf(stderr, "is_on_ground_us: player grounded in %d of %d queries\n", grounded, queries);
+        return -1.0;
+    }
+    return us;
+}
+
+static double benchSpriteUpdate(BenchContext *context) {
+    (void)context;
+    const int updates = 1000000;
+    SpriteFrame frames[4] = {{0, 32, 32, 32}, {32, 32, 32, 32}, {64, 32, 32, 32}, {96, 32, 32, 32}};
+    Animation animations[ANIM_COUNT] = {
+        {frames, 1, 1.0f, true},
+        {frames, 4, 0.15f, true},
+        {frames, 1, 1.0f, false}
+    };
+    Sprite sprite = {0};
+    sprite.animations = animations;
+    sprite.animationCount = ANIM_COUNT;
+    sprite.isPlaying = true;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < updates; i++) {
+        setSpriteAnimation(&sprite, (i / 1000) % 2 ? ANIM_WALK : ANIM_IDLE);
+        updateSprite(&sprite, 1.0f / 60.0f);
+    }
+    return secondsSince(start) * 1e9 / updates;
+}
+
+static double benchLogger(BenchContext *context) {
+    (void)context;
+    const int lines = 20000;
+    log_init("bench.log");
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < lines; i++) {
+        LOG_INFO("Benchmark line %d: %d bodies, %.3f ms", i, i * 7, i * 0.001);
+    }
+    double us = secondsSince(start) * 1e6 / lines;
+
+    log_close();
+    remove("bench.log");
+    return us;
+}
+
+// Boxes spread over and around the window so culling has work to do
+static bool fillSnapshot(RenderSnapshot *snapshot, int count) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->boxes = malloc(sizeof(SnapshotBox) * count);
+    if (!snapshot->boxes) {
+        return false;
+    }
+    unsigned int state = 1;
+    for (int i = 0; i < count; i++) {
+        SnapshotBox *box = &snapshot->boxes[i];
+        state = state * 1103515245u + 12345u;
+        box->x = (float)((state >> 16) % (WINDOW_WIDTH * 2)) - WINDOW_WIDTH / 2;
+        state = state * 1103515245u + 12345u;
+        box->y = (float)((state >> 16) % (WINDOW_HEIGHT * 2)) - WINDOW_HEIGHT / 2;
+        box->angle = (float)(i % 628) / 100.0f;
+        box->width = box->height = 20.0f;
+        box->color = (SDL_Color){255, 100, 100, 255};
+    }
+    snapshot->boxCount = count;
+    snapshot->capacity = count;
+    return true;
+}
+
+static double benchBatchBuild(BenchContext *context) {
+    const int count = 20000;
+    const int iterations = 50;
+    RenderSnapshot snapshot;
+    BoxBatch batch;
+    if (!fillSnapshot(&snapshot, count) || !boxBatchInit(&batch, count, 0)) {
+        free(snapshot.boxes);
+        return -1.0;
+    }
+
+    boxBatchBuild(&batch, &context->jobs, &snapshot);
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; i++) {
+        boxBatchBuild(&batch, &context->jobs, &snapshot);
+    }
+    double ms = secondsSince(start) * 1e3 / iterations;
+
+    boxBatchDestroy(&batch);
+    free(snapshot.boxes);
+    return ms;
+}
+
+// Integrate and build vertices for 100k live particles, one frame's worth each
+static double benchParticles(BenchContext *context) {
+    (void)context;
+    const int count = 100000;
+    const int iterations = 30;
+    ParticleSystem particles;
+    if (!particleSystemInit(&particles, count)) {
+        return -1.0;
+    }
+    // Spread over the window; 30 frames at 1/600 s stay well inside every preset's lifetime
+    for (int i = 0; i < count / 100; i++) {
+        particleSystemEmit(&particles, (ParticleBurst)(i % PARTICLE_BURST_COUNT),
+                           (float)(i * 37 % WINDOW_WIDTH), GROUND_HEIGHT + (float)(i * 13 % 400), 1.0f, 100);
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; i++) {
+        particleSystemUpdate(&particles, 1.0f / 600.0f);
+        particleSystemBuild(&particles, 0.0f);
+    }
+    double ms = secondsSince(start) * 1e3 / iterations;
+
+    particleSystemDestroy(&particles);
+    return ms;
+}
+
+// 100 overlapping explosions batched over a 100x100 grid of boxes, one tick's apply each
+static double benchEffects(BenchContext *context) {
+    (void)context;
+    const int side = 100;
+    const int effects = 100;
+    const int iterations = 30;
+    World world;
+    EffectSystem fx;
+    if (!createWorld(&world, side * side)) {
+        return -1.0;
+    }
+    if (!effectSystemInit(&fx, world.pool.capacity)) {
+        destroyWorld(&world);
+        return -1.0;
+    }
+    for (int i = 0; i < side * side; i++) {
+        spawnBox(&world, cpv(20 + (i % side) * 8, 100 + (i / side) * 8), 6, 6);
+    }
+
+    unsigned int seed = 12345;
+    bool applied = true;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 0; j < effects; j++) {
+            seed = seed * 1103515245u + 12345u;
+            cpVect center = cpv(20 + (seed >> 8) % (side * 8), 100 + (seed >> 20) % (side * 8));
+            AreaEffect explosion = effectExplosion(center, 60, 100);
+            effectQueue(&fx, &explosion);
+        }
+        // Every center is inside the grid, so a pass that pushes nothing skipped the work
+        applied &= effectSystemApply(&fx, &world) > 0 && fx.stats.effects == effects;
+    }
+    double ms = secondsSince(start) * 1e3 / iterations;
+
+    effectSystemDestroy(&fx);
+    destroyWorld(&world);
+    if (!applied) {
+        fprintf(stderr, "effects_100x10k_ms: a pass didn't apply its %d explosions\n", effects);
+        return -1.0;
+    }
+    return ms;
+}
+
+// ---- Macro benchmarks ----
+
+static double stepScenario(int bodies) {
+    const int warmup = 60;
+    const int steps = 120;
+    World world;
+    if (!createWorld(&world, bodies + 16)) {
+        return -1.0;
+    }
+    spawnScenario(&world, SCENARIO_PILE, bodies, 1);
+
+    for (int i = 0; i < warmup; i++) {
+        cpSpaceStep(world.space, 1.0 / 60.0);
+    }
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < steps; i++) {
+        cpSpaceStep(world.space, 1.0 / 60.0);
+    }
+    double ms = secondsSince(start) * 1e3 / steps;
+
+    destroyWorld(&world);
+    return ms;
+}
+
+static double benchStep100(BenchContext *context) { (void)context; return stepScenario(100); }
+static double benchStep500(BenchContext *context) { (void)context; return stepScenario(500); }
+static double benchStep2000(BenchContext *context) { (void)context; return stepScenario(2000); }
+
+// Long linkages through the sweep's measurement: average step cost, or the
+// worst joint stretch while the structure swings and settles
+static double measureJoints(ScenarioType type, int links, int iterations, bool jointError) {
+    SolverSettings settings = {iterations, 1.0, INFINITY, links};
+    ScenarioMetrics metrics;
+    if (!measureScenario(type, &settings, 1, &metrics) || metrics.bodies < links) {
+        return -1.0;
+    }
+    return jointError ? metrics.jointError : metrics.stepMicros / 1000.0;
+}
+
+static double benchChainStep200(BenchContext *context) { (void)context; return measureJoints(SCENARIO_CHAIN, 200, 10, false); }
+static double benchChainError200(BenchContext *context) { (void)context; return measureJoints(SCENARIO_CHAIN, 200, 10, true); }
+static double benchBridgeError100(BenchContext *context) { (void)context; return measureJoints(SCENARIO_BRIDGE, 100, 10, true); }
+
+// Restore a saved state and re-simulate 8 ticks, the work of a typical rollback
+static double benchRollback(BenchContext *context) {
+    (void)context;
+    World world;
+    if (!createWorld(&world, 256)) {
+        return -1.0;
+    }
+    spawnPlayer(&world);
+    spawnScenario(&world, SCENARIO_PILE, 200, 1);
+    double ms = netBenchmarkRollback(&world, 8, 20);
+    destroyWorld(&world);
+    return ms;
+}
+
+// A settled 500-box pile with the player, as a rollback session starts it
+static bool settledPile(World *world) {
+    if (!createWorld(world, 516)) {
+        return false;
+    }
+    if (!spawnPlayer(world)) {
+        destroyWorld(world);
+        return false;
+    }
+    spawnScenario(world, SCENARIO_PILE, 500, 1);
+    for (int i = 0; i < 300; i++) {
+        cpSpaceStep(world->space, 1.0 / 60.0);
+    }
+    return true;
+}
+
+// Cost of a session tick, to compare with space_step_500_ms
+static double benchNetTick500(BenchContext *context) {
+    (void)context;
+    World world;
+    if (!settledPile(&world)) {
+        return -1.0;
+    }
+    double ms = netBenchmarkTicks(&world, 120);
+    destroyWorld(&world);
+    return ms;
+}
+
+// A peer that keeps rolling back must end where one that never does ends
+static double benchNetDrift500(BenchContext *context) {
+    (void)context;
+    World straight;
+    World rolled;
+    if (!settledPile(&straight)) {
+        return -1.0;
+    }
+    if (!settledPile(&rolled)) {
+        destroyWorld(&straight);
+        return -1.0;
+    }
+    double px = netBenchmarkDivergence(&straight, &rolled, 240, 5);
+    destroyWorld(&rolled);
+    destroyWorld(&straight);
+    return px;
+}
+
+static double benchRenderFrame(BenchContext *context) {
+    const int count = 5000;
+    const int frames = 30;
+    if (!context->renderer) {
+        return -1.0;
+    }
+    RenderSnapshot snapshot;
+    BoxBatch batch;
+    if (!fillSnapshot(&snapshot, count) || !boxBatchInit(&batch, count, 0)) {
+        free(snapshot.boxes);
+        return -1.0;
+    }
+    Sprite noSprite = {0};
+
+    renderSnapshot(context->renderer, &noSprite, &batch, &context->jobs, &snapshot, NULL, NULL, 0);
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < frames; i++) {
+        renderSnapshot(context->renderer, &noSprite, &batch, &context->jobs, &snapshot, NULL, NULL, 0);
+        SDL_RenderPresent(context->renderer);
+    }
+    double ms = secondsSince(start) * 1e3 / frames;
+
+    boxBatchDestroy(&batch);
+    free(snapshot.boxes);
+    return ms;
+}
+
+// Settled scene with one moving box, redrawn through damage tracking by a
+// software renderer into a persistent surface
+static double benchRenderDirty(BenchContext *context) {
+    const int count = 5000;
+    const int frames = 30;
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    RenderSnapshot snapshot;
+    BoxBatch batch;
+    DirtyRedraw dirty;
+    if (!renderer || !fillSnapshot(&snapshot, count)) {
+        if (renderer) SDL_DestroyRenderer(renderer);
+        if (surface) SDL_FreeSurface(surface);
+        return -1.0;
+    }
+    if (!boxBatchInit(&batch, count, 0) || !dirtyRedrawInit(&dirty, WINDOW_WIDTH, WINDOW_HEIGHT, count * 4)) {
+        free(snapshot.boxes);
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+        return -1.0;
+    }
+    Sprite noSprite = {0};
+
+    renderSnapshotDirty(renderer, &noSprite, &batch, &context->jobs, &snapshot, NULL, &dirty, 0);
+    SDL_RenderFlush(renderer);
+    SnapshotBox *mover = &snapshot.boxes[count / 2];
+    mover->x = WINDOW_WIDTH / 4;
+    mover->y = WINDOW_HEIGHT / 2;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < frames; i++) {
+        mover->x += 3.0f;
+        renderSnapshotDirty(renderer, &noSprite, &batch, &context->jobs, &snapshot, NULL, &dirty, 0);
+        SDL_RenderFlush(renderer);
+    }
+    double ms = secondsSince(start) * 1e3 / frames;
+
+    dirtyRedrawDestroy(&dirty);
+    boxBatchDestroy(&batch);
+    free(snapshot.boxes);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return ms;
+}
+
+static const Benchmark benchmarks[] = {
+    {"spawn_box_us",        "us",  SUITE_MICRO, benchSpawnBox},
+    {"is_on_ground_us",     "us",  SUITE_MICRO, benchIsOnGround},
+    {"sprite_update_ns",    "ns",  SUITE_MICRO, benchSpriteUpdate},
+    {"log_line_us",         "us",  SUITE_MICRO, benchLogger},
+    {"batch_build_20k_ms",  "ms",  SUITE_MICRO, benchBatchBuild},
+    {"particles_100k_ms",   "ms",  SUITE_MICRO, benchParticles},
+    {"effects_100x10k_ms",  "ms",  SUITE_MICRO, benchEffects},
+    {"space_step_100_ms",   "ms",  SUITE_MACRO, benchStep100},
+    {"space_step_500_ms",   "ms",  SUITE_MACRO, benchStep500},
+    {"space_step_2000_ms",  "ms",  SUITE_MACRO, benchStep2000},
+    {"chain_step_200_ms",   "ms",  SUITE_MACRO, benchChainStep200},
+    {"chain_error_200_px",  "px",  SUITE_MACRO, benchChainError200},
+    {"bridge_error_100_px", "px",  SUITE_MACRO, benchBridgeError100},
+    {"render_frame_5k_ms",  "ms",  SUITE_MACRO, benchRenderFrame},
+    {"render_dirty_5k_ms",  "ms",  SUITE_MACRO, benchRenderDirty},
+    {"rollback_8_ticks_ms", "ms",  SUITE_MACRO, benchRollback},
+    {"net_tick_500_ms",     "ms",  SUITE_MACRO, benchNetTick500},
+    {"net_drift_500_px",    "px",  SUITE_MACRO, benchNetDrift500},
+};
+
+#define BENCHMARK_COUNT ((int)(sizeof(benchmarks) / sizeof(benchmarks[0])))
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Median of several runs; negative when the benchmark could not run
+static double runBenchmark(const Benchmark *bench, BenchContext *context) {
+    double samples[BENCH_REPEATS];
+    for (int i = 0; i < BENCH_REPEATS; i++) {
+        samples[i] = bench->run(context);
+        if (samples[i] < 0.0) {
+            return -1.0;
+        }
+    }
+    qsort(samples, BENCH_REPEATS, sizeof(double), compareDoubles);
+    return samples[BENCH_REPEATS / 2];
+}
+
+// The baseline is a flat JSON object of "name": ceiling pairs
+static char *readFile(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc(size + 1);
+    if (text && fread(text, 1, size, file) != (size_t)size) {
+        free(text);
+        text = NULL;
+    }
+    if (text) {
+        text[size] = '\0';
+    }
+    fclose(file);
+    return text;
+}
+
+static bool baselineCeiling(const char *baseline, const char *name, double *ceiling) {
+    char key[96];
+    snprintf(key, sizeof(key), "\"%s\"", name);
+    const char *found = strstr(baseline, key);
+    if (!found) {
+        return false;
+    }
+    const char *colon = strchr(found + strlen(key), ':');
+    if (!colon) {
+        return false;
+    }
+    char *end;
+    *ceiling = strtod(colon + 1, &end);
+    return end != colon + 1;
+}
+
+static void printUsage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --suite NAME          micro, macro or all (default all)\n");
+    printf("  --baseline FILE       Fail when a result exceeds its ceiling in FILE, or a\n");
+    printf("                        benchmark with a ceiling fails to run\n");
+    printf("  --tolerance X         Allowed fraction over the ceiling (default %.2f)\n", BENCH_DEFAULT_TOLERANCE);
+    printf("  --out FILE            Write JSON results to FILE instead of stdout\n");
+    printf("  --write-baseline FILE Write ceilings of %.2fx the measured values to FILE\n", BENCH_BASELINE_MARGIN);
+}
+
+int main(int argc, char *argv[]) {
+    int suites = SUITE_MICRO | SUITE_MACRO;
+    const char *baselinePath = NULL;
+    const char *outPath = NULL;
+    const char *writeBaselinePath = NULL;
+    double tolerance = BENCH_DEFAULT_TOLERANCE;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--suite") == 0 && value) {
+            suites = strcmp(value, "micro") == 0 ? SUITE_MICRO :
+                     strcmp(value, "macro") == 0 ? SUITE_MACRO : SUITE_MICRO | SUITE_MACRO;
+            i++;
+        } else if (strcmp(arg, "--baseline") == 0 && value) {
+            baselinePath = value;
+            i++;
+        } else if (strcmp(arg, "--tolerance") == 0 && value) {
+            tolerance = atof(value);
+            i++;
+        } else if (strcmp(arg, "--out") == 0 && value) {
+            outPath = value;
+            i++;
+        } else if (strcmp(arg, "--write-baseline") == 0 && value) {
+            writeBaselinePath = value;
+            i++;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    char *baseline = NULL;
+    if (baselinePath && !(baseline = readFile(baselinePath))) {
+        fprintf(stderr, "Failed to read baseline %s\n", baselinePath);
+        return 2;
+    }
+
+    // Rendering needs a window; SDL_VIDEODRIVER=dummy provides one without a display
+    BenchContext context = {0};
+    if (SDL_Init(SDL_INIT_VIDEO) == 0) {
+        context.window = SDL_CreateWindow("bench", 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN);
+        if (context.window) {
+            context.renderer = SDL_CreateRenderer(context.window, -1, SDL_RENDERER_SOFTWARE);
+        }
+    }
+    if (!context.renderer) {
+        fprintf(stderr, "No renderer (%s); rendering benchmarks can't run\n", SDL_GetError());
+    }
+    if (!jobSystemInit(&context.jobs, 0)) {
+        return 2;
+    }
+
+    FILE *out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Failed to open %s\n", outPath);
+        return 2;
+    }
+    FILE *written = writeBaselinePath ? fopen(writeBaselinePath, "w") : NULL;
+    if (written) {
+        fprintf(written, "{\n");
+    }
+
+    int regressions = 0;
+    int failures = 0;
+    bool first = true;
+    bool firstWritten = true;       // Skipped benchmarks leave no entry in the written baseline
+    fprintf(out, "{\n  \"workers\": %d,\n  \"tolerance\": %.3f,\n  \"results\": [", context.jobs.workerCount, tolerance);
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        const Benchmark *bench = &benchmarks[i];
+        if (!(bench->suite & suites)) {
+            continue;
+        }
+
+        double value = runBenchmark(bench, &context);
+        double ceiling = 0.0;
+        bool hasCeiling = baseline && baselineCeiling(baseline, bench->name, &ceiling);
+        const char *status = "ok";
+        if (value < 0.0 && hasCeiling) {
+            // A benchmark the baseline expects must run; a broken path is not a pass
+            status = "failed";
+            failures++;
+        } else if (value < 0.0) {
+            status = "skipped";
+        } else if (hasCeiling && value > ceiling * (1.0 + tolerance)) {
+            status = "regressed";
+            regressions++;
+        } else if (baseline && !hasCeiling) {
+            status = "no_baseline";
+        }
+
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"value\": %.6f, \"unit\": \"%s\", \"ceiling\": %.6f, \"status\": \"%s\"}",
+                first ? "" : ",", bench->name, value, bench->unit, hasCeiling ? ceiling : 0.0, status);
+        fflush(out);
+        fprintf(stderr, "%-22s %12.4f %-2s %s\n", bench->name, value, bench->unit, status);
+        if (written && value >= 0.0) {
+            fprintf(written, "%s  \"%s\": %.6f", firstWritten ? "" : ",\n", bench->name, value * BENCH_BASELINE_MARGIN);
+            firstWritten = false;
+        }
+        first = false;
+    }
+    fprintf(out, "\n  ],\n  \"regressions\": %d,\n  \"failures\": %d\n}\n", regressions, failures);
+
+    if (written) {
+        fprintf(written, "\n}\n");
+        fclose(written);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    jobSystemDestroy(&context.jobs);
+    if (context.renderer) SDL_DestroyRenderer(context.renderer);
+    if (context.window) SDL_DestroyWindow(context.window);
+    SDL_Quit();
+    free(baseline);
+    return regressions > 0 || failures > 0 ? 1 : 0;
+}
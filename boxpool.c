@@ -0,0 +1,80 @@
+#include "boxpool.h"
+#include "alloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+bool boxPoolInit(BoxPool *pool, int capacity) {
+    memset(pool, 0, sizeof(*pool));
+
+    pool->bodies = allocCalloc(ALLOC_TAG_PHYSICS, capacity, sizeof(cpBody));
+    pool->shapes = allocCalloc(ALLOC_TAG_PHYSICS, capacity, sizeof(cpPolyShape));
+    pool->freeSlots = allocMalloc(ALLOC_TAG_PHYSICS, sizeof(int) * capacity);
+    if (!pool->bodies || !pool->shapes || !pool->freeSlots) {
+        fprintf(stderr, "Failed to allocate box pool for %d boxes\n", capacity);
+        boxPoolDestroy(pool);
+        return false;
+    }
+
+    // Hand out low slots first so live boxes stay packed at the start of the slabs
+    for (int i = 0; i < capacity; i++) {
+        pool->freeSlots[i] = capacity - 1 - i;
+    }
+    pool->freeCount = capacity;
+    pool->capacity = capacity;
+    return true;
+}
+
+void boxPoolDestroy(BoxPool *pool) {
+    allocFree(ALLOC_TAG_PHYSICS, pool->bodies);
+    allocFree(ALLOC_TAG_PHYSICS, pool->shapes);
+    allocFree(ALLOC_TAG_PHYSICS, pool->freeSlots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+int boxPoolAcquire(BoxPool *pool, cpFloat mass, cpFloat width, cpFloat height) {
+    if (pool->freeCount == 0) {
+        pool->exhausted++;
+        return -1;
+    }
+
+    int slot = pool->freeSlots[--pool->freeCount];
+    cpBody *body = &pool->bodies[slot];
+    cpBodyInit(body, mass, cpMomentForBox(mass, width, height));
+    cpBoxShapeInit(&pool->shapes[slot], body, width, height, 0.0f);
+
+    pool->live++;
+    if (pool->live > pool->highWater) {
+        pool->highWater = pool->live;
+    }
+    pool->acquired++;
+    return slot;
+}
+
+cpBody *boxPoolBody(BoxPool *pool, int slot) {
+    return &pool->bodies[slot];
+}
+
+cpShape *boxPoolShape(BoxPool *pool, int slot) {
+    return (cpShape *)&pool->shapes[slot];
+}
+
+int boxPoolSlot(const BoxPool *pool, const cpBody *body) {
+    // Compare addresses as integers; pointers into other objects can't be subtracted
+    uintptr_t first = (uintptr_t)pool->bodies;
+    uintptr_t address = (uintptr_t)body;
+    if (address < first || address >= first + sizeof(cpBody) * (size_t)pool->capacity) {
+        return -1;
+    }
+    return (int)((address - first) / sizeof(cpBody));
+}
+
+void boxPoolRelease(BoxPool *pool, int slot) {
+    cpShapeDestroy(boxPoolShape(pool, slot));
+    cpBodyDestroy(boxPoolBody(pool, slot));
+
+    pool->freeSlots[pool->freeCount++] = slot;
+    pool->live--;
+    pool->released++;
+}
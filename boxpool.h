@@ -0,0 +1,46 @@
+#ifndef BOXPOOL_H
+#define BOXPOOL_H
+
+#include <chipmunk/chipmunk.h>
+#include <chipmunk/chipmunk_structs.h>
+#include <stdbool.h>
+
+// Preallocated slab storage for box bodies and shapes. Bodies and shapes are
+// initialized in place with cpBodyInit/cpBoxShapeInit, so spawning and
+// despawning never touch the heap once the pool exists.
+typedef struct {
+    cpBody *bodies;           // Slab of `capacity` bodies
+    cpPolyShape *shapes;      // Slab of `capacity` box shapes
+    int *freeSlots;           // Stack of unused slot indices
+    int freeCount;
+    int capacity;
+
+    // Allocation counters
+    int live;                 // Slots currently in use
+    int highWater;            // Most slots ever in use at once
+    unsigned long acquired;   // Total spawns served
+    unsigned long released;   // Total slots returned for reuse
+    unsigned long exhausted;  // Spawns refused because the pool was full
+} BoxPool;
+
+// Allocate the slabs. This is the only heap allocation the pool makes.
+bool boxPoolInit(BoxPool *pool, int capacity);
+
+// Free the slabs. Every slot must have been released (or its space freed) first.
+void boxPoolDestroy(BoxPool *pool);
+
+// Initialize a body and box shape in a free slot. Returns the slot index or -1 when full.
+int boxPoolAcquire(BoxPool *pool, cpFloat mass, cpFloat width, cpFloat height);
+
+// Body / shape stored in a slot
+cpBody *boxPoolBody(BoxPool *pool, int slot);
+cpShape *boxPoolShape(BoxPool *pool, int slot);
+
+// Slot holding `body`, or -1 when the body isn't from this pool
+int boxPoolSlot(const BoxPool *pool, const cpBody *body);
+
+// Destroy the body and shape in a slot and return it to the free list.
+// Both must already be removed from their space.
+void boxPoolRelease(BoxPool *pool, int slot);
+
+#endif // BOXPOOL_H
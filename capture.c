@@ -0,0 +1,259 @@
+#include "capture.h"
+#include "logging.h"
+#include "alloc.h"
+#include <SDL2/SDL_image.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+bool parseCaptureFormat(const char *name, CaptureFormat *format) {
+    if (strcmp(name, "png") == 0) {
+        *format = CAPTURE_PNG;
+    } else if (strcmp(name, "y4m") == 0) {
+        *format = CAPTURE_Y4M;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ---- Encoding (capture thread) ----
+
+static bool writePng(Capture *capture, const CaptureBuffer *buffer) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/frame_%06lu.png", capture->path, buffer->frame);
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        buffer->pixels, capture->width, capture->height, 32,
+        capture->width * 4, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) {
+        return false;
+    }
+    bool ok = IMG_SavePNG(surface, path) == 0;
+    SDL_FreeSurface(surface);
+    return ok;
+}
+
+// BT.601 studio range, chroma averaged over each 2x2 block
+static bool writeY4m(Capture *capture, const CaptureBuffer *buffer) {
+    int w = capture->width, h = capture->height;
+    int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    Uint8 *yPlane = capture->yuv;
+    Uint8 *uPlane = yPlane + w * h;
+    Uint8 *vPlane = uPlane + cw * ch;
+
+    for (int y = 0; y < h; y++) {
+        const Uint32 *row = buffer->pixels + y * w;
+        for (int x = 0; x < w; x++) {
+            int r = (row[x] >> 16) & 0xff, g = (row[x] >> 8) & 0xff, b = row[x] & 0xff;
+            yPlane[y * w + x] = (Uint8)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    for (int cy = 0; cy < ch; cy++) {
+        for (int cx = 0; cx < cw; cx++) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int dy = 0; dy < 2 && cy * 2 + dy < h; dy++) {
+                for (int dx = 0; dx < 2 && cx * 2 + dx < w; dx++) {
+                    Uint32 p = buffer->pixels[(cy * 2 + dy) * w + cx * 2 + dx];
+                    r += (p >> 16) & 0xff;
+                    g += (p >> 8) & 0xff;
+                    b += p & 0xff;
+                    n++;
+                }
+            }
+            r /= n; g /= n; b /= n;
+            uPlane[cy * cw + cx] = (Uint8)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[cy * cw + cx] = (Uint8)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+
+    size_t size = (size_t)w * h + 2 * (size_t)cw * ch;
+    return fputs("FRAME\n", capture->file) >= 0 && fwrite(capture->yuv, 1, size, capture->file) == size;
+}
+
+static int captureThread(void *data) {
+    Capture *capture = data;
+    allocSetTag(ALLOC_TAG_CAPTURE);
+
+    SDL_LockMutex(capture->lock);
+    while (true) {
+        while (!capture->queue && !capture->quit) {
+            SDL_CondWait(capture->wake, capture->lock);
+        }
+        // Finish what was captured before quitting
+        CaptureBuffer *buffer = capture->queue;
+        if (!buffer) {
+            break;
+        }
+        capture->queue = buffer->next;
+        if (!capture->queue) {
+            capture->queueTail = NULL;
+        }
+        SDL_UnlockMutex(capture->lock);
+
+        bool ok = capture->format == CAPTURE_PNG ? writePng(capture, buffer) : writeY4m(capture, buffer);
+
+        SDL_LockMutex(capture->lock);
+        if (ok) {
+            capture->stats.written++;
+        } else {
+            capture->stats.failed++;
+        }
+        buffer->next = capture->free;
+        capture->free = buffer;
+    }
+    SDL_UnlockMutex(capture->lock);
+    return 0;
+}
+
+// ---- Main loop side ----
+
+bool captureInit(Capture *capture, SDL_Renderer *renderer, CaptureFormat format,
+                 const char *path, double fps) {
+    memset(capture, 0, sizeof(*capture));
+    capture->format = format;
+    snprintf(capture->path, sizeof(capture->path), "%s", path);
+    if (SDL_GetRendererOutputSize(renderer, &capture->width, &capture->height) != 0) {
+        LOG_ERROR("Failed to get renderer size for capture: %s", SDL_GetError());
+        return false;
+    }
+
+    // All frame memory up front; capturing never allocates
+    size_t frameBytes = (size_t)capture->width * capture->height * sizeof(Uint32);
+    for (int i = 0; i < CAPTURE_BUFFERS; i++) {
+        capture->buffers[i].pixels = allocMalloc(ALLOC_TAG_CAPTURE, frameBytes);
+        if (!capture->buffers[i].pixels) {
+            captureDestroy(capture);
+            return false;
+        }
+        capture->buffers[i].next = capture->free;
+        capture->free = &capture->buffers[i];
+    }
+
+    if (format == CAPTURE_PNG) {
+#ifdef _WIN32
+        _mkdir(path);
+#else
+        mkdir(path, 0755);
+#endif
+    } else {
+        int cw = (capture->width + 1) / 2, ch = (capture->height + 1) / 2;
+        capture->yuv = allocMalloc(ALLOC_TAG_CAPTURE, (size_t)capture->width * capture->height + 2 * (size_t)cw * ch);
+        capture->file = fopen(path, "wb");
+        if (!capture->yuv || !capture->file) {
+            LOG_ERROR("Failed to open capture file %s", path);
+            captureDestroy(capture);
+            return false;
+        }
+        fprintf(capture->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+                capture->width, capture->height, (int)(fps + 0.5));
+    }
+
+    capture->lock = SDL_CreateMutex();
+    capture->wake = SDL_CreateCond();
+    if (!capture->lock || !capture->wake) {
+        LOG_ERROR("Failed to create capture lock: %s", SDL_GetError());
+        captureDestroy(capture);
+        return false;
+    }
+    capture->thread = SDL_CreateThread(captureThread, "capture encoder", capture);
+    if (!capture->thread) {
+        LOG_ERROR("Failed to create capture thread: %s", SDL_GetError());
+        captureDestroy(capture);
+        return false;
+    }
+
+    LOG_INFO("Capturing %dx%d frames as %s to %s", capture->width, capture->height,
+             format == CAPTURE_PNG ? "PNG" : "Y4M", path);
+    return true;
+}
+
+void captureDestroy(Capture *capture) {
+    if (capture->thread) {
+        SDL_LockMutex(capture->lock);
+        capture->quit = true;
+        SDL_CondSignal(capture->wake);
+        SDL_UnlockMutex(capture->lock);
+        SDL_WaitThread(capture->thread, NULL);
+        capture->thread = NULL;
+
+        CaptureStats *stats = &capture->stats;
+        LOG_INFO("Capture: %lu frames written, %lu dropped, %lu failed, "
+                 "main loop cost avg %.3f ms max %.3f ms",
+                 stats->written, stats->dropped, stats->failed,
+                 stats->captured ? stats->totalMs / stats->captured : 0.0, stats->maxMs);
+    }
+    if (capture->wake) {
+        SDL_DestroyCond(capture->wake);
+        capture->wake = NULL;
+    }
+    if (capture->lock) {
+        SDL_DestroyMutex(capture->lock);
+        capture->lock = NULL;
+    }
+    if (capture->file) {
+        fclose(capture->file);
+        capture->file = NULL;
+    }
+    allocFree(ALLOC_TAG_CAPTURE, capture->yuv);
+    capture->yuv = NULL;
+    for (int i = 0; i < CAPTURE_BUFFERS; i++) {
+        allocFree(ALLOC_TAG_CAPTURE, capture->buffers[i].pixels);
+        capture->buffers[i].pixels = NULL;
+    }
+}
+
+void captureFrame(Capture *capture, SDL_Renderer *renderer, unsigned long frame) {
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    SDL_LockMutex(capture->lock);
+    CaptureBuffer *buffer = capture->free;
+    if (buffer) {
+        capture->free = buffer->next;
+    } else {
+        capture->stats.dropped++;
+    }
+    SDL_UnlockMutex(capture->lock);
+    if (!buffer) {
+        return;  // Encoder is behind; skip this frame rather than wait
+    }
+
+    // SDL2 has no asynchronous readback, so this is the part that costs
+    bool ok = SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888,
+                                   buffer->pixels, capture->width * 4) == 0;
+    buffer->frame = frame;
+    buffer->next = NULL;
+    double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    SDL_LockMutex(capture->lock);
+    if (ok) {
+        if (capture->queueTail) {
+            capture->queueTail->next = buffer;
+        } else {
+            capture->queue = buffer;
+        }
+        capture->queueTail = buffer;
+        capture->stats.captured++;
+        SDL_CondSignal(capture->wake);
+    } else {
+        capture->stats.failed++;
+        buffer->next = capture->free;
+        capture->free = buffer;
+    }
+    capture->stats.lastMs = ms;
+    capture->stats.totalMs += ms;
+    if (ms > capture->stats.maxMs) {
+        capture->stats.maxMs = ms;
+    }
+    SDL_UnlockMutex(capture->lock);
+}
+
+CaptureStats captureStats(Capture *capture) {
+    SDL_LockMutex(capture->lock);
+    CaptureStats stats = capture->stats;
+    SDL_UnlockMutex(capture->lock);
+    return stats;
+}
@@ -0,0 +1,70 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#define CAPTURE_BUFFERS 4           // Frames in flight between the main loop and the encoder
+
+typedef enum {
+    CAPTURE_PNG,                    // One numbered PNG per frame in a directory
+    CAPTURE_Y4M                     // Raw YUV 4:2:0 stream in a single file
+} CaptureFormat;
+
+typedef struct CaptureBuffer {
+    Uint32 *pixels;                 // ARGB8888, width * height
+    unsigned long frame;            // Main loop frame number
+    struct CaptureBuffer *next;     // Free list or encode queue link
+} CaptureBuffer;
+
+typedef struct {
+    unsigned long captured;         // Frames handed to the encoder
+    unsigned long dropped;          // No free buffer: the encoder fell behind
+    unsigned long written;
+    unsigned long failed;           // Readback or write errors
+    double lastMs;                  // Main loop cost of the last capture
+    double totalMs;
+    double maxMs;
+} CaptureStats;
+
+// Reads presented frames back into a fixed pool of buffers and encodes them
+// on a background thread. When every buffer is busy the frame is dropped,
+// so the main loop never waits on the encoder.
+typedef struct {
+    CaptureFormat format;
+    char path[256];                 // Directory (PNG) or file (Y4M)
+    int width, height;
+    CaptureBuffer buffers[CAPTURE_BUFFERS];
+    Uint8 *yuv;                     // Encoder scratch for Y4M
+    FILE *file;                     // Y4M output
+
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *wake;
+    CaptureBuffer *free;            // Owned by the main loop between captures
+    CaptureBuffer *queue;           // FIFO, encoded in frame order
+    CaptureBuffer *queueTail;
+    bool quit;
+
+    CaptureStats stats;             // Written under `lock` by the encoder
+} Capture;
+
+bool parseCaptureFormat(const char *name, CaptureFormat *format);
+
+// Allocate the buffer pool for the renderer's output size, open the output
+// and start the encoder thread
+bool captureInit(Capture *capture, SDL_Renderer *renderer, CaptureFormat format,
+                 const char *path, double fps);
+
+// Encode what is still queued, then stop the thread and close the output
+void captureDestroy(Capture *capture);
+
+// Read back the frame just rendered. Call after drawing and before
+// SDL_RenderPresent, while the back buffer is still defined.
+void captureFrame(Capture *capture, SDL_Renderer *renderer, unsigned long frame);
+
+// Copy of the statistics, safe while the encoder runs
+CaptureStats captureStats(Capture *capture);
+
+#endif // CAPTURE_H
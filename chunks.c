@@ -0,0 +1,499 @@
+#include "chunks.h"
+#include "logging.h"
+#include "alloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// ---- Chunk data and files (no cpSpace access; safe on the loader thread) ----
+
+static ChunkData *newChunkData(int index) {
+    ChunkData *data = allocCalloc(ALLOC_TAG_STREAMING, 1, sizeof(ChunkData));
+    if (data) {
+        data->index = index;
+    }
+    return data;
+}
+
+static void freeChunkData(ChunkData *data) {
+    if (data) {
+        allocFree(ALLOC_TAG_STREAMING, data->boxes);
+        allocFree(ALLOC_TAG_STREAMING, data);
+    }
+}
+
+static bool addChunkBox(ChunkData *data, const ChunkBox *box) {
+    if (data->boxCount == data->boxCapacity) {
+        int capacity = data->boxCapacity ? data->boxCapacity * 2 : 32;
+        ChunkBox *boxes = allocRealloc(ALLOC_TAG_STREAMING, data->boxes, sizeof(ChunkBox) * capacity);
+        if (!boxes) {
+            return false;
+        }
+        data->boxes = boxes;
+        data->boxCapacity = capacity;
+    }
+    data->boxes[data->boxCount++] = *box;
+    return true;
+}
+
+static void addChunkSegment(ChunkData *data, cpVect a, cpVect b, cpFloat radius) {
+    if (data->segmentCount < CHUNK_MAX_SEGMENTS) {
+        ChunkSegment *segment = &data->segments[data->segmentCount++];
+        segment->a = a;
+        segment->b = b;
+        segment->radius = radius;
+    }
+}
+
+static void chunkPath(const ChunkStreamer *streamer, int index, char *path, size_t size) {
+    snprintf(path, size, "%s/chunk_%04d.txt", streamer->directory, index);
+}
+
+static unsigned int nextRandom(unsigned int *state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7fff;
+}
+
+// Ground across the chunk, two platforms and a few props on each
+static void generateChunk(ChunkData *data, unsigned int seed) {
+    unsigned int state = seed ^ (unsigned int)(data->index * 2654435761u);
+    cpFloat left = data->index * CHUNK_WIDTH;
+
+    addChunkSegment(data, cpv(left, GROUND_HEIGHT), cpv(left + CHUNK_WIDTH, GROUND_HEIGHT), 0.0);
+
+    for (int p = 0; p < 2; p++) {
+        cpFloat x = left + 100 + p * 350 + nextRandom(&state) % 100;
+        cpFloat y = GROUND_HEIGHT + 120 + nextRandom(&state) % 200;
+        cpFloat width = 120 + nextRandom(&state) % 80;
+        addChunkSegment(data, cpv(x, y), cpv(x + width, y), 4.0);
+
+        int props = 2 + nextRandom(&state) % 4;
+        for (int i = 0; i < props; i++) {
+            ChunkBox box = {0};
+            box.layer = LAYER_PROPS;
+            box.width = box.height = 20 + nextRandom(&state) % 20;
+            box.position = cpv(x + 10 + nextRandom(&state) % (int)(width - 20), y + 20 + i * 45);
+            addChunkBox(data, &box);
+        }
+    }
+}
+
+static bool writeChunkFile(const char *path, const ChunkData *data) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    fprintf(file, "# platformer chunk v1\n");
+    fprintf(file, "chunk %d\n", data->index);
+    for (int i = 0; i < data->segmentCount; i++) {
+        const ChunkSegment *s = &data->segments[i];
+        fprintf(file, "segment %.3f %.3f %.3f %.3f %.3f\n", s->a.x, s->a.y, s->b.x, s->b.y, s->radius);
+    }
+    for (int i = 0; i < data->boxCount; i++) {
+        const ChunkBox *b = &data->boxes[i];
+        fprintf(file, "box %s %.3f %.3f %.5f %.3f %.3f %.5f %.3f %.3f\n",
+                layerName(b->layer), b->position.x, b->position.y, b->angle,
+                b->velocity.x, b->velocity.y, b->angularVelocity, b->width, b->height);
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+static CollisionLayer layerFromName(const char *name) {
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        if (strcmp(name, layerName((CollisionLayer)layer)) == 0) {
+            return (CollisionLayer)layer;
+        }
+    }
+    return LAYER_PROPS;
+}
+
+static bool readChunkFile(const char *path, ChunkData *data) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        ChunkSegment s;
+        ChunkBox b = {0};
+        char layer[32];
+        double v[9];
+
+        if (sscanf(line, "segment %lf %lf %lf %lf %lf", &v[0], &v[1], &v[2], &v[3], &v[4]) == 5) {
+            s.a = cpv(v[0], v[1]);
+            s.b = cpv(v[2], v[3]);
+            addChunkSegment(data, s.a, s.b, v[4]);
+        } else if (sscanf(line, "box %31s %lf %lf %lf %lf %lf %lf %lf %lf", layer,
+                          &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) == 9) {
+            b.layer = layerFromName(layer);
+            b.position = cpv(v[0], v[1]);
+            b.angle = v[2];
+            b.velocity = cpv(v[3], v[4]);
+            b.angularVelocity = v[5];
+            b.width = v[6];
+            b.height = v[7];
+            addChunkBox(data, &b);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+// ---- Loader thread ----
+
+static void pushRequest(ChunkStreamer *streamer, ChunkData *data) {
+    data->next = NULL;
+    SDL_LockMutex(streamer->lock);
+    ChunkData **tail = &streamer->requests;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    *tail = data;
+    SDL_CondSignal(streamer->wake);
+    SDL_UnlockMutex(streamer->lock);
+}
+
+static int loaderThread(void *arg) {
+    ChunkStreamer *streamer = arg;
+    char path[300];
+    allocSetTag(ALLOC_TAG_STREAMING);
+
+    SDL_LockMutex(streamer->lock);
+    while (true) {
+        while (!streamer->requests && !streamer->quit) {
+            SDL_CondWait(streamer->wake, streamer->lock);
+        }
+        // Drain pending saves before quitting so no state is lost
+        ChunkData *data = streamer->requests;
+        if (!data) {
+            break;
+        }
+        streamer->requests = data->next;
+        SDL_UnlockMutex(streamer->lock);
+
+        chunkPath(streamer, data->index, path, sizeof(path));
+        if (data->save) {
+            if (!writeChunkFile(path, data)) {
+                LOG_ERROR("Failed to save chunk %d to %s", data->index, path);
+            }
+            freeChunkData(data);
+            SDL_LockMutex(streamer->lock);
+            continue;
+        }
+
+        if (!readChunkFile(path, data)) {
+            // First visit: generate the chunk and keep it on disk from now on
+            generateChunk(data, streamer->seed);
+            if (!writeChunkFile(path, data)) {
+                LOG_WARNING("Failed to write generated chunk %d to %s", data->index, path);
+            }
+        }
+
+        SDL_LockMutex(streamer->lock);
+        data->next = streamer->completed;
+        streamer->completed = data;
+    }
+    SDL_UnlockMutex(streamer->lock);
+    return 0;
+}
+
+// ---- Streaming (runs where the world is stepped) ----
+
+bool chunkStreamerInit(ChunkStreamer *streamer, World *world, const char *directory,
+                       int chunkCount, unsigned int seed) {
+    memset(streamer, 0, sizeof(*streamer));
+    snprintf(streamer->directory, sizeof(streamer->directory), "%s", directory);
+    streamer->chunkCount = chunkCount;
+    streamer->seed = seed;
+
+#ifdef _WIN32
+    _mkdir(directory);
+#else
+    mkdir(directory, 0755);
+#endif
+
+    streamer->lock = SDL_CreateMutex();
+    streamer->wake = SDL_CreateCond();
+    if (!streamer->lock || !streamer->wake) {
+        LOG_ERROR("Failed to create chunk loader sync: %s", SDL_GetError());
+        return false;
+    }
+    streamer->thread = SDL_CreateThread(loaderThread, "chunk loader", streamer);
+    if (!streamer->thread) {
+        LOG_ERROR("Failed to create chunk loader thread: %s", SDL_GetError());
+        return false;
+    }
+
+    // Level geometry comes from the chunks
+    removeGround(world);
+    world->minX = 0;
+    world->maxX = (cpFloat)chunkCount * CHUNK_WIDTH;
+
+    LOG_INFO("Streaming %d chunks from %s", chunkCount, directory);
+    return true;
+}
+
+static LoadedChunk *findSlot(ChunkStreamer *streamer, int index) {
+    for (int i = 0; i < CHUNK_MAX_LOADED; i++) {
+        LoadedChunk *slot = &streamer->slots[i];
+        if (slot->state != CHUNK_UNLOADED && slot->index == index) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static LoadedChunk *freeSlot(ChunkStreamer *streamer) {
+    for (int i = 0; i < CHUNK_MAX_LOADED; i++) {
+        if (streamer->slots[i].state == CHUNK_UNLOADED) {
+            return &streamer->slots[i];
+        }
+    }
+    return NULL;
+}
+
+// Chunk whose bodies are in the space that is closest to `index`
+static LoadedChunk *nearestResident(ChunkStreamer *streamer, int index) {
+    LoadedChunk *nearest = NULL;
+    for (int i = 0; i < CHUNK_MAX_LOADED; i++) {
+        LoadedChunk *slot = &streamer->slots[i];
+        if (slot->state != CHUNK_LOADED && slot->state != CHUNK_INTEGRATING) {
+            continue;
+        }
+        if (!nearest || abs(slot->index - index) < abs(nearest->index - index)) {
+            nearest = slot;
+        }
+    }
+    return nearest;
+}
+
+static int chunkIndexAt(const ChunkStreamer *streamer, cpFloat x) {
+    int index = (int)floor(x / CHUNK_WIDTH);
+    if (index < 0) return 0;
+    if (index >= streamer->chunkCount) return streamer->chunkCount - 1;
+    return index;
+}
+
+// Add static geometry and up to `budget` boxes. Returns the budget left.
+static int integrateChunk(LoadedChunk *slot, World *world, int budget) {
+    ChunkData *data = slot->data;
+
+    if (slot->integrated == 0 && slot->staticCount == 0) {
+        cpBody *staticBody = cpSpaceGetStaticBody(world->space);
+        for (int i = 0; i < data->segmentCount; i++) {
+            const ChunkSegment *s = &data->segments[i];
+            cpShape *shape = cpSegmentShapeNew(staticBody, s->a, s->b, s->radius);
+            cpShapeSetFriction(shape, 0.3f);
+            cpShapeSetFilter(shape, world->filters[LAYER_STATIC]);
+            slot->statics[slot->staticCount++] = cpSpaceAddShape(world->space, shape);
+        }
+    }
+
+    while (budget > 0 && slot->integrated < data->boxCount) {
+        const ChunkBox *b = &data->boxes[slot->integrated++];
+        Box *box = spawnBoxOnLayer(world, b->position, b->width, b->height, b->layer);
+        if (box) {
+            cpBodySetAngle(box->body, b->angle);
+            cpBodySetVelocity(box->body, b->velocity);
+            cpBodySetAngularVelocity(box->body, b->angularVelocity);
+        } else {
+            LOG_WARNING("World full, dropped a box from chunk %d", data->index);
+        }
+        budget--;
+    }
+    return budget;
+}
+
+// Move the slot's bodies (and not yet integrated boxes) into a save request and remove its geometry
+static ChunkData *evictChunk(ChunkStreamer *streamer, LoadedChunk *slot, World *world) {
+    ChunkData *data = newChunkData(slot->index);
+    if (!data) {
+        return NULL;
+    }
+    data->save = true;
+
+    // Static geometry is part of the chunk file
+    for (int i = 0; i < slot->staticCount; i++) {
+        cpShape *shape = slot->statics[i];
+        cpVect a = cpSegmentShapeGetA(shape);
+        cpVect b = cpSegmentShapeGetB(shape);
+        addChunkSegment(data, a, b, cpSegmentShapeGetRadius(shape));
+        cpSpaceRemoveShape(world->space, shape);
+        cpShapeFree(shape);
+    }
+    slot->staticCount = 0;
+
+    // Boxes belong to the nearest resident chunk, so strays outside the loaded area are kept
+    for (int i = world->boxCount - 1; i >= 0; i--) {
+        Box *box = &world->boxes[i];
+        if (box->body == world->playerBody) {
+            continue;
+        }
+        cpVect pos = cpBodyGetPosition(box->body);
+        if (nearestResident(streamer, chunkIndexAt(streamer, pos.x)) != slot) {
+            continue;
+        }
+
+        ChunkBox saved = {
+            box->layer, pos, cpBodyGetAngle(box->body), cpBodyGetVelocity(box->body),
+            cpBodyGetAngularVelocity(box->body), box->width, box->height
+        };
+        addChunkBox(data, &saved);
+        despawnBox(world, i);
+    }
+
+    if (slot->data) {
+        for (int i = slot->integrated; i < slot->data->boxCount; i++) {
+            addChunkBox(data, &slot->data->boxes[i]);
+        }
+        freeChunkData(slot->data);
+        slot->data = NULL;
+    }
+
+    if (slot->state == CHUNK_LOADED) {
+        streamer->loadedChunks--;
+    }
+    slot->state = CHUNK_UNLOADED;
+    slot->integrated = 0;
+    streamer->unloads++;
+    return data;
+}
+
+void chunkStreamerUpdate(ChunkStreamer *streamer, World *world, cpFloat focusX) {
+    int focus = chunkIndexAt(streamer, focusX);
+
+    // Request chunks entering the load radius
+    for (int index = focus - CHUNK_LOAD_RADIUS; index <= focus + CHUNK_LOAD_RADIUS; index++) {
+        if (index < 0 || index >= streamer->chunkCount || findSlot(streamer, index)) {
+            continue;
+        }
+        LoadedChunk *slot = freeSlot(streamer);
+        ChunkData *request = newChunkData(index);
+        if (!slot || !request) {
+            freeChunkData(request);
+            break;
+        }
+        slot->index = index;
+        slot->state = CHUNK_LOADING;
+        pushRequest(streamer, request);
+    }
+
+    // Pick up finished loads
+    SDL_LockMutex(streamer->lock);
+    ChunkData *completed = streamer->completed;
+    streamer->completed = NULL;
+    SDL_UnlockMutex(streamer->lock);
+
+    while (completed) {
+        ChunkData *data = completed;
+        completed = data->next;
+        LoadedChunk *slot = findSlot(streamer, data->index);
+        if (slot && slot->state == CHUNK_LOADING) {
+            slot->data = data;
+            slot->integrated = 0;
+            slot->state = CHUNK_INTEGRATING;
+        } else {
+            freeChunkData(data);
+        }
+    }
+
+    // Spread integration over ticks
+    int budget = CHUNK_BODIES_PER_TICK;
+    for (int i = 0; i < CHUNK_MAX_LOADED && budget > 0; i++) {
+        LoadedChunk *slot = &streamer->slots[i];
+        if (slot->state != CHUNK_INTEGRATING) {
+            continue;
+        }
+        budget = integrateChunk(slot, world, budget);
+        if (slot->integrated == slot->data->boxCount) {
+            freeChunkData(slot->data);
+            slot->data = NULL;
+            slot->state = CHUNK_LOADED;
+            streamer->loadedChunks++;
+            streamer->loads++;
+        }
+    }
+
+    // Save and remove the farthest chunk beyond the unload radius (one per tick)
+    LoadedChunk *farthest = NULL;
+    for (int i = 0; i < CHUNK_MAX_LOADED; i++) {
+        LoadedChunk *slot = &streamer->slots[i];
+        if (slot->state == CHUNK_LOADED && abs(slot->index - focus) > CHUNK_UNLOAD_RADIUS &&
+            (!farthest || abs(slot->index - focus) > abs(farthest->index - focus))) {
+            farthest = slot;
+        }
+    }
+    if (farthest) {
+        ChunkData *save = evictChunk(streamer, farthest, world);
+        if (save) {
+            pushRequest(streamer, save);
+        }
+    }
+}
+
+void chunkStreamerPrime(ChunkStreamer *streamer, World *world, cpFloat focusX) {
+    int focus = chunkIndexAt(streamer, focusX);
+    while (true) {
+        chunkStreamerUpdate(streamer, world, focusX);
+
+        bool ready = true;
+        for (int index = focus - CHUNK_LOAD_RADIUS; index <= focus + CHUNK_LOAD_RADIUS; index++) {
+            if (index < 0 || index >= streamer->chunkCount) {
+                continue;
+            }
+            LoadedChunk *slot = findSlot(streamer, index);
+            if (slot && slot->state != CHUNK_LOADED) {
+                ready = false;
+            }
+        }
+        if (ready) {
+            break;
+        }
+        SDL_Delay(1);
+    }
+}
+
+void chunkStreamerDestroy(ChunkStreamer *streamer, World *world) {
+    if (streamer->thread) {
+        // Persist everything in the space, farthest chunks first keep strays with their neighbours
+        for (int i = 0; i < CHUNK_MAX_LOADED; i++) {
+            LoadedChunk *slot = &streamer->slots[i];
+            if (slot->state == CHUNK_LOADED || slot->state == CHUNK_INTEGRATING) {
+                ChunkData *save = evictChunk(streamer, slot, world);
+                if (save) {
+                    pushRequest(streamer, save);
+                }
+            }
+        }
+
+        SDL_LockMutex(streamer->lock);
+        streamer->quit = true;
+        SDL_CondSignal(streamer->wake);
+        SDL_UnlockMutex(streamer->lock);
+        SDL_WaitThread(streamer->thread, NULL);
+        streamer->thread = NULL;
+    }
+
+    while (streamer->completed) {
+        ChunkData *data = streamer->completed;
+        streamer->completed = data->next;
+        freeChunkData(data);
+    }
+    if (streamer->wake) SDL_DestroyCond(streamer->wake);
+    if (streamer->lock) SDL_DestroyMutex(streamer->lock);
+    streamer->wake = NULL;
+    streamer->lock = NULL;
+
+    LOG_INFO("Chunk streaming: %lu loads, %lu unloads", streamer->loads, streamer->unloads);
+}
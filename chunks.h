@@ -0,0 +1,98 @@
+#ifndef CHUNKS_H
+#define CHUNKS_H
+
+#include <SDL2/SDL.h>
+#include <chipmunk/chipmunk.h>
+#include <stdbool.h>
+#include "world.h"
+
+// The level is a horizontal strip of fixed-width chunks, one file each
+#define CHUNK_WIDTH WINDOW_WIDTH
+#define CHUNK_MAX_SEGMENTS 16
+#define CHUNK_LOAD_RADIUS 1         // Chunks either side of the player kept loaded
+#define CHUNK_UNLOAD_RADIUS 2       // Further than this, chunks are saved and removed
+#define CHUNK_BODIES_PER_TICK 32    // Integration budget so loads don't hitch
+#define CHUNK_MAX_LOADED 8
+
+typedef struct {
+    cpVect a, b;
+    cpFloat radius;
+} ChunkSegment;
+
+typedef struct {
+    CollisionLayer layer;
+    cpVect position;
+    cpFloat angle;
+    cpVect velocity;
+    cpFloat angularVelocity;
+    cpFloat width, height;
+} ChunkBox;
+
+// Contents of one chunk file, independent of any cpSpace
+typedef struct ChunkData {
+    int index;
+    ChunkSegment segments[CHUNK_MAX_SEGMENTS];
+    int segmentCount;
+    ChunkBox *boxes;
+    int boxCount;
+    int boxCapacity;
+    bool save;                      // Loader request: write this chunk rather than read it
+    struct ChunkData *next;         // Loader queue link
+} ChunkData;
+
+typedef enum {
+    CHUNK_UNLOADED,
+    CHUNK_LOADING,                  // Queued on the loader thread
+    CHUNK_INTEGRATING,              // Read; bodies being added a few per tick
+    CHUNK_LOADED
+} ChunkState;
+
+typedef struct {
+    int index;
+    ChunkState state;
+    ChunkData *data;                // While integrating
+    int integrated;                 // Boxes added so far
+    cpShape *statics[CHUNK_MAX_SEGMENTS];
+    int staticCount;
+} LoadedChunk;
+
+// Streams chunks in and out of a world around the player. Disk I/O and
+// parsing run on a loader thread; the space is only touched from
+// chunkStreamerUpdate, on whichever thread steps the world.
+typedef struct {
+    char directory[256];
+    int chunkCount;
+    unsigned int seed;              // For generating chunks missing on disk
+    LoadedChunk slots[CHUNK_MAX_LOADED];
+
+    // Loader thread: requests in, loaded chunks out
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *wake;
+    ChunkData *requests;            // FIFO, so a save always lands before a re-read
+    ChunkData *completed;
+    bool quit;
+
+    // Statistics
+    int loadedChunks;
+    unsigned long loads;
+    unsigned long unloads;
+} ChunkStreamer;
+
+// Take over the world's ground and start the loader thread. Chunk files live
+// in `directory` and are generated from `seed` the first time they're needed.
+bool chunkStreamerInit(ChunkStreamer *streamer, World *world, const char *directory,
+                       int chunkCount, unsigned int seed);
+
+// Save every loaded chunk back to disk and stop the loader thread
+void chunkStreamerDestroy(ChunkStreamer *streamer, World *world);
+
+// Request chunks around `focusX`, integrate finished loads within the per-tick
+// budget and save + remove chunks that are out of range
+void chunkStreamerUpdate(ChunkStreamer *streamer, World *world, cpFloat focusX);
+
+// Block until every chunk within the load radius of `focusX` is fully in the
+// space, so the player doesn't start above missing ground
+void chunkStreamerPrime(ChunkStreamer *streamer, World *world, cpFloat focusX);
+
+#endif // CHUNKS_H
@@ -0,0 +1,176 @@
+#include "damage.h"
+#include "alloc.h"
+#include "logging.h"
+#include <math.h>
+#include <string.h>
+
+#define DAMAGE_HASH_SEED 2166136261u
+
+static inline Uint32 mixKey(Uint32 hash, Uint32 key) {
+    return (hash ^ key) * 16777619u;
+}
+
+static inline Uint32 floatBits(float value) {
+    Uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+bool damageInit(DamageTracker *damage, int width, int height) {
+    memset(damage, 0, sizeof(*damage));
+    damage->width = width;
+    damage->height = height;
+    damage->cols = (width + DAMAGE_TILE - 1) / DAMAGE_TILE;
+    damage->rows = (height + DAMAGE_TILE - 1) / DAMAGE_TILE;
+
+    size_t tiles = (size_t)damage->cols * damage->rows;
+    damage->hashes = allocMalloc(ALLOC_TAG_RENDER, sizeof(Uint32) * tiles);
+    damage->previous = allocMalloc(ALLOC_TAG_RENDER, sizeof(Uint32) * tiles);
+    if (!damage->hashes || !damage->previous) {
+        LOG_ERROR("Failed to allocate damage tiles for %dx%d", width, height);
+        damageDestroy(damage);
+        return false;
+    }
+    return true;
+}
+
+void damageDestroy(DamageTracker *damage) {
+    allocFree(ALLOC_TAG_RENDER, damage->hashes);
+    allocFree(ALLOC_TAG_RENDER, damage->previous);
+    memset(damage, 0, sizeof(*damage));
+}
+
+void damageInvalidate(DamageTracker *damage) {
+    damage->valid = false;
+}
+
+void damageBegin(DamageTracker *damage) {
+    int tiles = damage->cols * damage->rows;
+    for (int i = 0; i < tiles; i++) {
+        damage->hashes[i] = DAMAGE_HASH_SEED;
+    }
+}
+
+void damageAddRect(DamageTracker *damage, const SDL_Rect *rect, Uint32 key) {
+    int x0 = rect->x < 0 ? 0 : rect->x;
+    int y0 = rect->y < 0 ? 0 : rect->y;
+    int x1 = rect->x + rect->w < damage->width ? rect->x + rect->w : damage->width;
+    int y1 = rect->y + rect->h < damage->height ? rect->y + rect->h : damage->height;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    int c0 = x0 / DAMAGE_TILE, c1 = (x1 - 1) / DAMAGE_TILE;
+    int r0 = y0 / DAMAGE_TILE, r1 = (y1 - 1) / DAMAGE_TILE;
+    for (int row = r0; row <= r1; row++) {
+        Uint32 *tile = &damage->hashes[row * damage->cols];
+        for (int col = c0; col <= c1; col++) {
+            tile[col] = mixKey(tile[col], key);
+        }
+    }
+}
+
+void damageAddGeometry(DamageTracker *damage, const SDL_Vertex *vertices, int shapes, int verticesPerShape) {
+    for (int s = 0; s < shapes; s++) {
+        const SDL_Vertex *shape = &vertices[s * verticesPerShape];
+        float minX = shape[0].position.x, maxX = minX;
+        float minY = shape[0].position.y, maxY = minY;
+        Uint32 key = DAMAGE_HASH_SEED;
+        for (int v = 0; v < verticesPerShape; v++) {
+            float x = shape[v].position.x;
+            float y = shape[v].position.y;
+            minX = x < minX ? x : minX;
+            maxX = x > maxX ? x : maxX;
+            minY = y < minY ? y : minY;
+            maxY = y > maxY ? y : maxY;
+            key = mixKey(key, floatBits(x));
+            key = mixKey(key, floatBits(y));
+        }
+        const SDL_Color *color = &shape[0].color;
+        key = mixKey(key, (Uint32)color->r << 24 | (Uint32)color->g << 16 | (Uint32)color->b << 8 | color->a);
+
+        // One pixel of slack for rasterizer rounding at the edges
+        SDL_Rect bounds = {
+            (int)floorf(minX) - 1,
+            (int)floorf(minY) - 1,
+            (int)ceilf(maxX) - (int)floorf(minX) + 2,
+            (int)ceilf(maxY) - (int)floorf(minY) + 2
+        };
+        damageAddRect(damage, &bounds, key);
+    }
+}
+
+static int markFull(DamageTracker *damage) {
+    damage->rects[0] = (SDL_Rect){0, 0, damage->width, damage->height};
+    damage->rectCount = 1;
+    damage->full = true;
+    damage->damagedTiles = damage->cols * damage->rows;
+    damage->redrawFraction = 1.0;
+    return 1;
+}
+
+// Merge damaged tiles into rects: runs along each row, stacked with an
+// identical run directly above when there is one
+static bool buildRects(DamageTracker *damage) {
+    damage->rectCount = 0;
+    damage->damagedTiles = 0;
+    long area = 0;
+
+    for (int row = 0; row < damage->rows; row++) {
+        const Uint32 *now = &damage->hashes[row * damage->cols];
+        const Uint32 *before = &damage->previous[row * damage->cols];
+        int col = 0;
+        while (col < damage->cols) {
+            if (now[col] == before[col]) {
+                col++;
+                continue;
+            }
+            int start = col;
+            while (col < damage->cols && now[col] != before[col]) {
+                col++;
+            }
+            damage->damagedTiles += col - start;
+
+            int x = start * DAMAGE_TILE;
+            int y = row * DAMAGE_TILE;
+            int w = (col * DAMAGE_TILE < damage->width ? col * DAMAGE_TILE : damage->width) - x;
+            int h = ((row + 1) * DAMAGE_TILE < damage->height ? (row + 1) * DAMAGE_TILE : damage->height) - y;
+            area += (long)w * h;
+
+            SDL_Rect *above = NULL;
+            for (int i = 0; i < damage->rectCount; i++) {
+                SDL_Rect *rect = &damage->rects[i];
+                if (rect->x == x && rect->w == w && rect->y + rect->h == y) {
+                    above = rect;
+                    break;
+                }
+            }
+            if (above) {
+                above->h += h;
+            } else if (damage->rectCount < DAMAGE_MAX_RECTS) {
+                damage->rects[damage->rectCount++] = (SDL_Rect){x, y, w, h};
+            } else {
+                return false;
+            }
+        }
+    }
+
+    damage->redrawFraction = (double)area / ((double)damage->width * damage->height);
+    return damage->redrawFraction <= DAMAGE_FULL_RATIO;
+}
+
+int damageEnd(DamageTracker *damage, bool forceFull) {
+    damage->full = false;
+    int count;
+    if (forceFull || !damage->valid || !buildRects(damage)) {
+        count = markFull(damage);
+    } else {
+        count = damage->rectCount;
+    }
+
+    Uint32 *swap = damage->previous;
+    damage->previous = damage->hashes;
+    damage->hashes = swap;
+    damage->valid = true;
+    return count;
+}
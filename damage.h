@@ -0,0 +1,53 @@
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#define DAMAGE_TILE 32              // Tile edge in pixels
+#define DAMAGE_MAX_RECTS 32         // More than this and the whole frame is redrawn
+#define DAMAGE_FULL_RATIO 0.6       // Same when this share of the window is damaged
+
+// Per-frame damage from tile content hashes. Every shape drawn this frame
+// mixes a key (position, color, animation frame, ...) into each tile its
+// bounds touch, in draw order. Tiles whose hash differs from the previous
+// frame's are damaged: something moved, appeared, disappeared or changed
+// look there. This needs no entity identities, so spawns, despawns, pool
+// recycling and camera scrolling are all covered by the same comparison.
+typedef struct {
+    int width, height;              // Pixels
+    int cols, rows;
+    Uint32 *hashes;                 // This frame
+    Uint32 *previous;               // Last frame
+    bool valid;                     // `previous` describes what is on screen
+
+    SDL_Rect rects[DAMAGE_MAX_RECTS];   // Result of damageEnd
+    int rectCount;
+    bool full;                      // The result is the whole window
+
+    // Statistics of the last frame
+    int damagedTiles;
+    double redrawFraction;          // Damaged area / window area
+} DamageTracker;
+
+bool damageInit(DamageTracker *damage, int width, int height);
+void damageDestroy(DamageTracker *damage);
+
+// Forget what is on screen, e.g. after the window was exposed. The next frame is full.
+void damageInvalidate(DamageTracker *damage);
+
+// Start a frame
+void damageBegin(DamageTracker *damage);
+
+// Mix `key` into every tile the rectangle touches
+void damageAddRect(DamageTracker *damage, const SDL_Rect *rect, Uint32 key);
+
+// Add `shapes` convex shapes of `verticesPerShape` consecutive vertices each,
+// keyed by their exact positions and colors
+void damageAddGeometry(DamageTracker *damage, const SDL_Vertex *vertices, int shapes, int verticesPerShape);
+
+// Compare against the previous frame and merge damaged tiles into rects.
+// `forceFull` damages everything. Returns the rect count (0 = nothing changed).
+int damageEnd(DamageTracker *damage, bool forceFull);
+
+#endif // DAMAGE_H
@@ -0,0 +1,187 @@
+#include "debugdraw.h"
+#include "alloc.h"
+#include "world.h"
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define DEBUG_LINE_WIDTH 1.0f
+#define DEBUG_CIRCLE_SEGMENTS 16
+#define DEBUG_INITIAL_VERTICES 4096
+
+void debugDrawInit(DebugDrawBuffer *buffer) {
+    buffer->vertices = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+    buffer->overflow = false;
+    buffer->originX = 0;
+}
+
+void debugDrawDestroy(DebugDrawBuffer *buffer) {
+    allocFree(ALLOC_TAG_RENDER, buffer->vertices);
+    debugDrawInit(buffer);
+}
+
+// Make room for `extra` more vertices; doubling keeps steady-state frames allocation free
+static bool reserve(DebugDrawBuffer *buffer, int extra) {
+    if (buffer->count + extra <= buffer->capacity) {
+        return true;
+    }
+
+    int capacity = buffer->capacity ? buffer->capacity : DEBUG_INITIAL_VERTICES;
+    while (capacity < buffer->count + extra) {
+        capacity *= 2;
+    }
+    SDL_Vertex *vertices = allocRealloc(ALLOC_TAG_RENDER, buffer->vertices, sizeof(SDL_Vertex) * capacity);
+    if (!vertices) {
+        buffer->overflow = true;
+        return false;
+    }
+    buffer->vertices = vertices;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static SDL_Color toColor(cpSpaceDebugColor color) {
+    SDL_Color out = {
+        (Uint8)(color.r * 255.0f),
+        (Uint8)(color.g * 255.0f),
+        (Uint8)(color.b * 255.0f),
+        (Uint8)(color.a * 255.0f)
+    };
+    return out;
+}
+
+static void pushVertex(DebugDrawBuffer *buffer, cpVect p, SDL_Color color) {
+    SDL_Vertex *v = &buffer->vertices[buffer->count++];
+    v->position.x = (float)(p.x - buffer->originX);
+    v->position.y = (float)(WINDOW_HEIGHT - p.y);
+    v->color = color;
+    v->tex_coord.x = 0.0f;
+    v->tex_coord.y = 0.0f;
+}
+
+static void pushTriangle(DebugDrawBuffer *buffer, cpVect a, cpVect b, cpVect c, SDL_Color color) {
+    if (!reserve(buffer, 3)) {
+        return;
+    }
+    pushVertex(buffer, a, color);
+    pushVertex(buffer, b, color);
+    pushVertex(buffer, c, color);
+}
+
+// Quad of half width `radius` around the segment a-b
+static void pushQuad(DebugDrawBuffer *buffer, cpVect a, cpVect b, cpFloat radius, SDL_Color color) {
+    cpVect d = cpvsub(b, a);
+    cpFloat length = cpvlength(d);
+    cpVect n = length > 0.0 ? cpvmult(cpvperp(d), radius / length) : cpv(radius, 0.0);
+
+    pushTriangle(buffer, cpvadd(a, n), cpvadd(b, n), cpvsub(b, n), color);
+    pushTriangle(buffer, cpvadd(a, n), cpvsub(b, n), cpvsub(a, n), color);
+}
+
+static void pushLine(DebugDrawBuffer *buffer, cpVect a, cpVect b, SDL_Color color) {
+    pushQuad(buffer, a, b, DEBUG_LINE_WIDTH * 0.5, color);
+}
+
+static void drawCircle(cpVect pos, cpFloat angle, cpFloat radius,
+                       cpSpaceDebugColor outlineColor, cpSpaceDebugColor fillColor, cpDataPointer data) {
+    DebugDrawBuffer *buffer = data;
+    SDL_Color fill = toColor(fillColor);
+    SDL_Color outline = toColor(outlineColor);
+
+    cpVect previous = cpvadd(pos, cpv(radius, 0.0));
+    for (int i = 1; i <= DEBUG_CIRCLE_SEGMENTS; i++) {
+        cpFloat a = 2.0 * M_PI * i / DEBUG_CIRCLE_SEGMENTS;
+        cpVect next = cpvadd(pos, cpvmult(cpvforangle(a), radius));
+        pushTriangle(buffer, pos, previous, next, fill);
+        pushLine(buffer, previous, next, outline);
+        previous = next;
+    }
+
+    // Radius line shows rotation
+    pushLine(buffer, pos, cpvadd(pos, cpvmult(cpvforangle(angle), radius)), outline);
+}
+
+static void drawSegment(cpVect a, cpVect b, cpSpaceDebugColor color, cpDataPointer data) {
+    pushLine(data, a, b, toColor(color));
+}
+
+static void drawFatSegment(cpVect a, cpVect b, cpFloat radius,
+                           cpSpaceDebugColor outlineColor, cpSpaceDebugColor fillColor, cpDataPointer data) {
+    DebugDrawBuffer *buffer = data;
+    if (radius > DEBUG_LINE_WIDTH) {
+        pushQuad(buffer, a, b, radius, toColor(fillColor));
+    }
+    pushLine(buffer, a, b, toColor(outlineColor));
+}
+
+static void drawPolygon(int count, const cpVect *verts, cpFloat radius,
+                        cpSpaceDebugColor outlineColor, cpSpaceDebugColor fillColor, cpDataPointer data) {
+    (void)radius;
+    DebugDrawBuffer *buffer = data;
+    SDL_Color fill = toColor(fillColor);
+    SDL_Color outline = toColor(outlineColor);
+
+    // Chipmunk polygons are convex, so a fan covers them
+    for (int i = 1; i + 1 < count; i++) {
+        pushTriangle(buffer, verts[0], verts[i], verts[i + 1], fill);
+    }
+    for (int i = 0; i < count; i++) {
+        pushLine(buffer, verts[i], verts[(i + 1) % count], outline);
+    }
+}
+
+static void drawDot(cpFloat size, cpVect pos, cpSpaceDebugColor color, cpDataPointer data) {
+    cpVect half = cpv(size * 0.5, 0.0);
+    pushQuad(data, cpvsub(pos, half), cpvadd(pos, half), size * 0.5, toColor(color));
+}
+
+// Green for static, gray for sleeping, yellow for awake dynamic bodies
+static cpSpaceDebugColor colorForShape(cpShape *shape, cpDataPointer data) {
+    (void)data;
+    cpBody *body = cpShapeGetBody(shape);
+    cpSpaceDebugColor color;
+
+    if (cpBodyGetType(body) != CP_BODY_TYPE_DYNAMIC) {
+        color = (cpSpaceDebugColor){0.0f, 1.0f, 0.0f, 0.25f};
+    } else if (cpBodyIsSleeping(body)) {
+        color = (cpSpaceDebugColor){0.5f, 0.5f, 0.5f, 0.25f};
+    } else {
+        color = (cpSpaceDebugColor){1.0f, 1.0f, 0.0f, 0.25f};
+    }
+    return color;
+}
+
+void debugDrawSpace(DebugDrawBuffer *buffer, cpSpace *space, cpFloat originX) {
+    buffer->count = 0;
+    buffer->originX = originX;
+    buffer->overflow = false;
+
+    cpSpaceDebugDrawOptions options = {
+        drawCircle,
+        drawSegment,
+        drawFatSegment,
+        drawPolygon,
+        drawDot,
+        CP_SPACE_DEBUG_DRAW_SHAPES | CP_SPACE_DEBUG_DRAW_CONSTRAINTS | CP_SPACE_DEBUG_DRAW_COLLISION_POINTS,
+        {1.0f, 1.0f, 1.0f, 0.8f},    // Shape outline
+        colorForShape,
+        {0.0f, 0.75f, 1.0f, 1.0f},   // Constraints
+        {1.0f, 0.0f, 0.0f, 1.0f},    // Contact points and normals
+        buffer
+    };
+    cpSpaceDebugDraw(space, &options);
+}
+
+void debugDrawRender(SDL_Renderer *renderer, const DebugDrawBuffer *buffer) {
+    if (buffer->count == 0) {
+        return;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(renderer, NULL, buffer->vertices, buffer->count, NULL, 0);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
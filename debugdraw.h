@@ -0,0 +1,30 @@
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include <SDL2/SDL.h>
+#include <chipmunk/chipmunk.h>
+#include <stdbool.h>
+
+// Triangle list in screen coordinates for a whole frame of physics debug
+// drawing. Lines are expanded into thin quads so everything is submitted with
+// a single SDL_RenderGeometry call.
+typedef struct {
+    SDL_Vertex *vertices;
+    int count;
+    int capacity;              // Grows on demand, never shrinks
+    bool overflow;             // A frame was cut short because growing failed
+    cpFloat originX;           // World x at the left edge of the screen
+} DebugDrawBuffer;
+
+void debugDrawInit(DebugDrawBuffer *buffer);
+void debugDrawDestroy(DebugDrawBuffer *buffer);
+
+// Rebuild the buffer from every shape, constraint and contact in the space
+// via cpSpaceDebugDraw, scrolled so `originX` is the left edge of the screen.
+// Only reads the space, so it can run wherever stepping does.
+void debugDrawSpace(DebugDrawBuffer *buffer, cpSpace *space, cpFloat originX);
+
+// Submit the buffer with blending enabled
+void debugDrawRender(SDL_Renderer *renderer, const DebugDrawBuffer *buffer);
+
+#endif // DEBUGDRAW_H
@@ -0,0 +1,151 @@
+#include "effects.h"
+#include "alloc.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// State shared with the query callback for one effect
+typedef struct {
+    EffectSystem *effects;
+    World *world;
+    const AreaEffect *effect;
+} EffectQuery;
+
+bool effectSystemInit(EffectSystem *effects, int capacity) {
+    memset(effects, 0, sizeof(*effects));
+
+    effects->impulses = allocMalloc(ALLOC_TAG_PHYSICS, sizeof(cpVect) * capacity);
+    effects->lastPass = allocCalloc(ALLOC_TAG_PHYSICS, capacity, sizeof(unsigned int));
+    effects->lastEffect = allocCalloc(ALLOC_TAG_PHYSICS, capacity, sizeof(unsigned int));
+    effects->touched = allocMalloc(ALLOC_TAG_PHYSICS, sizeof(int) * capacity);
+    if (!effects->impulses || !effects->lastPass || !effects->lastEffect || !effects->touched) {
+        fprintf(stderr, "Failed to allocate area effects for %d bodies\n", capacity);
+        effectSystemDestroy(effects);
+        return false;
+    }
+    effects->capacity = capacity;
+    return true;
+}
+
+void effectSystemDestroy(EffectSystem *effects) {
+    allocFree(ALLOC_TAG_PHYSICS, effects->impulses);
+    allocFree(ALLOC_TAG_PHYSICS, effects->lastPass);
+    allocFree(ALLOC_TAG_PHYSICS, effects->lastEffect);
+    allocFree(ALLOC_TAG_PHYSICS, effects->touched);
+    memset(effects, 0, sizeof(*effects));
+}
+
+bool effectQueue(EffectSystem *effects, const AreaEffect *effect) {
+    if (effects->queued >= EFFECT_QUEUE_CAPACITY || effect->radius <= 0) {
+        return false;
+    }
+    effects->queue[effects->queued++] = *effect;
+    return true;
+}
+
+AreaEffect effectExplosion(cpVect center, cpFloat radius, cpFloat impulse) {
+    AreaEffect effect = {EFFECT_RADIAL, FALLOFF_QUADRATIC, center, radius, impulse, cpvzero};
+    return effect;
+}
+
+AreaEffect effectWind(cpVect center, cpFloat radius, cpVect direction, cpFloat force, cpFloat dt) {
+    AreaEffect effect = {EFFECT_DIRECTIONAL, FALLOFF_NONE, center, radius, force * dt, cpvnormalize(direction)};
+    return effect;
+}
+
+AreaEffect effectMagnet(cpVect center, cpFloat radius, cpFloat force, cpFloat dt) {
+    AreaEffect effect = {EFFECT_RADIAL, FALLOFF_LINEAR, center, radius, -force * dt, cpvzero};
+    return effect;
+}
+
+static cpFloat falloff(EffectFalloff falloff, cpFloat fraction) {
+    switch (falloff) {
+        case FALLOFF_LINEAR:    return 1.0 - fraction;
+        case FALLOFF_QUADRATIC: return (1.0 - fraction) * (1.0 - fraction);
+        default:                return 1.0;
+    }
+}
+
+// Runs for every shape whose bounding box touches the effect's bounding box
+static void accumulateHit(cpShape *shape, void *data) {
+    EffectQuery *query = data;
+    EffectSystem *effects = query->effects;
+    const AreaEffect *effect = query->effect;
+    effects->stats.candidates++;
+
+    // Frozen (static) and kinematic bodies don't take impulses
+    cpBody *body = cpShapeGetBody(shape);
+    if (cpBodyGetType(body) != CP_BODY_TYPE_DYNAMIC) {
+        return;
+    }
+    int slot = boxPoolSlot(&query->world->pool, body);
+    if (slot < 0 || effects->lastEffect[slot] == effects->effectId) {
+        return;
+    }
+    effects->lastEffect[slot] = effects->effectId;
+
+    // The bounding box is a square; only the circle inside it counts
+    cpVect offset = cpvsub(cpBodyGetPosition(body), effect->center);
+    cpFloat distanceSq = cpvlengthsq(offset);
+    if (distanceSq >= effect->radius * effect->radius) {
+        return;
+    }
+    cpFloat distance = sqrt(distanceSq);
+    cpFloat magnitude = effect->impulse * falloff(effect->falloff, distance / effect->radius);
+
+    cpVect direction = effect->direction;
+    if (effect->kind == EFFECT_RADIAL) {
+        // A body right at the center goes straight up
+        direction = distance > 1e-6 ? cpvmult(offset, 1.0 / distance) : cpv(0, 1);
+    }
+    cpVect impulse = cpvmult(direction, magnitude);
+
+    if (effects->lastPass[slot] != effects->pass) {
+        effects->lastPass[slot] = effects->pass;
+        effects->impulses[slot] = impulse;
+        effects->touched[effects->touchedCount++] = slot;
+    } else {
+        effects->impulses[slot] = cpvadd(effects->impulses[slot], impulse);
+        effects->stats.merged++;
+    }
+}
+
+int effectSystemApply(EffectSystem *effects, World *world) {
+    EffectStats empty = {0};
+    effects->stats = empty;
+    effects->stats.effects = effects->queued;
+    if (effects->queued == 0) {
+        return 0;
+    }
+
+    // Stamps tell this pass's slots apart without clearing the scratch arrays;
+    // start over on the (practically unreachable) wrap back to zero
+    if (++effects->pass == 0 || effects->effectId > 0xffffffffu - EFFECT_QUEUE_CAPACITY) {
+        memset(effects->lastPass, 0, sizeof(unsigned int) * effects->capacity);
+        memset(effects->lastEffect, 0, sizeof(unsigned int) * effects->capacity);
+        effects->pass = 1;
+        effects->effectId = 0;
+    }
+    effects->touchedCount = 0;
+
+    cpShapeFilter filter = layerQueryFilter(LAYER_BIT(LAYER_PLAYER) | LAYER_BIT(LAYER_PROPS) |
+                                            LAYER_BIT(LAYER_DEBRIS));
+    for (int i = 0; i < effects->queued; i++) {
+        EffectQuery query = {effects, world, &effects->queue[i]};
+        effects->effectId++;
+        cpSpaceBBQuery(world->space, cpBBNewForCircle(query.effect->center, query.effect->radius),
+                       filter, accumulateHit, &query);
+    }
+
+    // One impulse per body, however many effects reached it
+    for (int i = 0; i < effects->touchedCount; i++) {
+        int slot = effects->touched[i];
+        cpBody *body = boxPoolBody(&world->pool, slot);
+        cpBodyActivate(body);
+        cpBodyApplyImpulseAtWorldPoint(body, effects->impulses[slot], cpBodyGetPosition(body));
+    }
+
+    effects->stats.bodies = effects->touchedCount;
+    effects->queued = 0;
+    return effects->touchedCount;
+}
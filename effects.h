@@ -0,0 +1,74 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <stdbool.h>
+#include "world.h"
+
+#define EFFECT_QUEUE_CAPACITY 256   // Effects queued per tick
+
+typedef enum {
+    EFFECT_RADIAL,          // Along the line from the center: explosions, or magnets with a negative impulse
+    EFFECT_DIRECTIONAL      // Along a fixed direction: wind
+} EffectKind;
+
+// How the impulse fades from the center to the radius
+typedef enum {
+    FALLOFF_NONE,
+    FALLOFF_LINEAR,
+    FALLOFF_QUADRATIC
+} EffectFalloff;
+
+typedef struct {
+    EffectKind kind;
+    EffectFalloff falloff;
+    cpVect center;
+    cpFloat radius;
+    cpFloat impulse;        // At the center before falloff; for fields, force * dt
+    cpVect direction;       // EFFECT_DIRECTIONAL only, unit length
+} AreaEffect;
+
+typedef struct {
+    int effects;            // Effects applied in the last tick
+    int candidates;         // Shapes returned by the bounding box queries
+    int bodies;             // Distinct bodies pushed
+    int merged;             // Extra hits on bodies already pushed by another effect
+} EffectStats;
+
+// Area effects queued during a tick and applied together. Each effect runs one
+// cpSpaceBBQuery; hits are accumulated per body, so a body caught by several
+// effects gets one summed impulse (and one wake-up) in a single final pass.
+// Only dynamic bodies on the player, props and debris layers are affected.
+typedef struct {
+    AreaEffect queue[EFFECT_QUEUE_CAPACITY];
+    int queued;
+
+    // Per box pool slot scratch, sized for the world's pool
+    cpVect *impulses;       // Accumulated impulse
+    unsigned int *lastPass; // Pass that last touched the slot
+    unsigned int *lastEffect; // Effect that last touched the slot, skips extra shapes of one body
+    int *touched;           // Slots touched this pass, in first-hit order
+    int touchedCount;
+    int capacity;
+    unsigned int pass;
+    unsigned int effectId;
+
+    EffectStats stats;
+} EffectSystem;
+
+bool effectSystemInit(EffectSystem *effects, int capacity);
+void effectSystemDestroy(EffectSystem *effects);
+
+// Queue an effect for the next apply. Returns false when the queue is full.
+bool effectQueue(EffectSystem *effects, const AreaEffect *effect);
+
+// Convenience constructors. Explosions and magnets fade with distance, wind is
+// uniform inside its radius. Fields take a force and the tick's dt.
+AreaEffect effectExplosion(cpVect center, cpFloat radius, cpFloat impulse);
+AreaEffect effectWind(cpVect center, cpFloat radius, cpVect direction, cpFloat force, cpFloat dt);
+AreaEffect effectMagnet(cpVect center, cpFloat radius, cpFloat force, cpFloat dt);
+
+// Query, accumulate and apply every queued effect, then clear the queue.
+// Call between steps. Returns the number of bodies pushed.
+int effectSystemApply(EffectSystem *effects, World *world);
+
+#endif // EFFECTS_H
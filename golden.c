@@ -0,0 +1,293 @@
+#include "golden.h"
+#include "simulation.h"
+#include "scenario.h"
+#include "render.h"
+#include "jobs.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define GOLDEN_DT (1.0 / 60.0)
+#define GOLDEN_SCENE_BOXES 1024     // Pool per scene; every scene fits well inside
+#define GOLDEN_NAME_LENGTH 32
+
+// One scripted scene: a scenario simulated for `ticks` ticks, rendered after each
+typedef struct {
+    const char *name;
+    ScenarioType scenario;
+    int count;               // Bodies, 0 = scenario default
+    int ticks;
+    bool dirty;              // Through damage tracking instead of full redraws
+    int overlays;            // RenderOverlay bits
+} GoldenScene;
+
+// Covers box batching and culling (the pile is taller than the window), rope
+// segments, the dirty-rect path and the debug overlay
+static const GoldenScene scenes[] = {
+    {"pyramid",     SCENARIO_PYRAMID, 0,   90, false, 0},
+    {"pile",        SCENARIO_PILE,    600, 90, false, 0},
+    {"pile_dirty",  SCENARIO_PILE,    600, 90, true,  0},
+    {"bridge",      SCENARIO_BRIDGE,  40,  90, false, 0},
+    {"mixed_debug", SCENARIO_MIXED,   0,   90, false, RENDER_OVERLAY_DEBUG},
+};
+#define GOLDEN_SCENE_COUNT ((int)(sizeof(scenes) / sizeof(scenes[0])))
+
+typedef struct {
+    char scene[GOLDEN_NAME_LENGTH];
+    int frame;
+    uint64_t hash;
+} GoldenFrame;
+
+typedef struct {
+    GoldenFrame *frames;
+    int count;
+    int capacity;
+} GoldenList;
+
+static bool addGoldenFrame(GoldenList *list, const char *scene, int frame, uint64_t hash) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 512;
+        GoldenFrame *frames = realloc(list->frames, sizeof(GoldenFrame) * capacity);
+        if (!frames) {
+            return false;
+        }
+        list->frames = frames;
+        list->capacity = capacity;
+    }
+    GoldenFrame *entry = &list->frames[list->count++];
+    snprintf(entry->scene, sizeof(entry->scene), "%s", scene);
+    entry->frame = frame;
+    entry->hash = hash;
+    return true;
+}
+
+// Lines of "scene frame hash"; '#' lines are comments. False when the file can't be opened.
+static bool loadGolden(GoldenList *list, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char line[128];
+    char scene[GOLDEN_NAME_LENGTH];
+    int frame;
+    uint64_t hash;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] != '#' && sscanf(line, "%31s %d %" SCNx64, scene, &frame, &hash) == 3 &&
+            !addGoldenFrame(list, scene, frame, hash)) {
+            break;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static bool writeGolden(const GoldenList *list, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        LOG_ERROR("Failed to write golden hashes to %s", path);
+        return false;
+    }
+    fprintf(file, "# Render golden hashes: scene frame fnv1a64. Regenerate with --golden %s --write-golden\n", path);
+    for (int i = 0; i < list->count; i++) {
+        fprintf(file, "%s %d %016" PRIx64 "\n", list->frames[i].scene, list->frames[i].frame, list->frames[i].hash);
+    }
+    fclose(file);
+    return true;
+}
+
+uint64_t goldenHashSurface(const SDL_Surface *surface) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const Uint8 *row = surface->pixels;
+    size_t rowBytes = (size_t)surface->w * 4;
+    for (int y = 0; y < surface->h; y++, row += surface->pitch) {
+        for (size_t x = 0; x < rowBytes; x++) {
+            hash ^= row[x];
+            hash *= 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+// Timings and check results for one scene
+typedef struct {
+    int frames;
+    int bodies;
+    double physicsMs;
+    double renderMs;
+    double renderMsMax;
+    double hashMs;
+    int mismatches;
+} GoldenResult;
+
+static double msSince(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+static bool runScene(const GoldenScene *scene, SDL_Renderer *renderer, SDL_Surface *surface,
+                     JobSystem *jobs, BoxBatch *batch, const GoldenList *expected, int *cursor,
+                     GoldenList *recorded, GoldenResult *result) {
+    memset(result, 0, sizeof(*result));
+    Simulation sim;
+    if (!simulationInit(&sim, GOLDEN_SCENE_BOXES, 1000.0 / 60.0, false)) {
+        return false;
+    }
+    DirtyRedraw dirty;
+    if (scene->dirty && !dirtyRedrawInit(&dirty, surface->w, surface->h, sim.world.maxJoints * 4)) {
+        simulationDestroy(&sim);
+        return false;
+    }
+    simulationSetDebugDraw(&sim, (scene->overlays & RENDER_OVERLAY_DEBUG) != 0);
+    result->bodies = spawnScenario(&sim.world, scene->scenario, scene->count, 1);
+
+    // Every scene starts from the same blank target, so the dirty path's first
+    // frame doesn't inherit the previous scene's pixels
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderFlush(renderer);
+
+    Sprite noSprite = {0};
+    bool ok = true;
+    for (int frame = 1; frame <= scene->ticks; frame++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        simulationTick(&sim, GOLDEN_DT);
+        simulationPublish(&sim);
+        result->physicsMs += msSince(start);
+
+        SimEvent event;
+        while (simulationPopEvent(&sim, &event)) {
+        }
+        bool fresh;
+        const RenderSnapshot *snapshot = snapshotAcquire(&sim.snapshots, &fresh);
+
+        start = SDL_GetPerformanceCounter();
+        if (scene->dirty) {
+            renderSnapshotDirty(renderer, &noSprite, batch, jobs, snapshot, NULL, &dirty, scene->overlays);
+        } else {
+            renderSnapshot(renderer, &noSprite, batch, jobs, snapshot, NULL, NULL, scene->overlays);
+        }
+        SDL_RenderFlush(renderer);
+        double renderMs = msSince(start);
+        result->renderMs += renderMs;
+        if (renderMs > result->renderMsMax) {
+            result->renderMsMax = renderMs;
+        }
+
+        start = SDL_GetPerformanceCounter();
+        if (SDL_MUSTLOCK(surface)) SDL_LockSurface(surface);
+        uint64_t hash = goldenHashSurface(surface);
+        if (SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+        result->hashMs += msSince(start);
+        result->frames++;
+
+        if (recorded && !addGoldenFrame(recorded, scene->name, frame, hash)) {
+            ok = false;
+            break;
+        }
+        if (expected) {
+            const GoldenFrame *golden = *cursor < expected->count ? &expected->frames[(*cursor)++] : NULL;
+            if (!golden || strcmp(golden->scene, scene->name) != 0 || golden->frame != frame) {
+                LOG_ERROR("Golden file has no hash for %s frame %d; regenerate it with --write-golden",
+                          scene->name, frame);
+                result->mismatches += scene->ticks - frame + 1;
+                break;
+            }
+            if (golden->hash != hash) {
+                // Later frames of a scene usually differ too; report the first
+                if (result->mismatches == 0) {
+                    LOG_ERROR("Golden mismatch: %s frame %d is %016" PRIx64 ", expected %016" PRIx64,
+                              scene->name, frame, hash, golden->hash);
+                }
+                result->mismatches++;
+            }
+        }
+    }
+
+    if (scene->dirty) {
+        dirtyRedrawDestroy(&dirty);
+    }
+    simulationDestroy(&sim);
+    return ok;
+}
+
+bool runGoldenRender(const GoldenConfig *config, FILE *out) {
+    GoldenList expected = {0};
+    GoldenList recorded = {0};
+    bool record = config->write;
+    // A missing reference is a failure, never a fresh recording: otherwise a
+    // run without the file would pass whatever it rendered
+    if (!record && !loadGolden(&expected, config->path)) {
+        LOG_ERROR("No golden file at %s; record one with --golden %s --write-golden and commit it",
+                  config->path, config->path);
+        return false;
+    }
+
+    // The software renderer draws straight into this surface, no window or GPU involved
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    JobSystem jobs;
+    BoxBatch batch;
+    if (!renderer) {
+        LOG_ERROR("Failed to create the offscreen renderer: %s", SDL_GetError());
+        if (surface) SDL_FreeSurface(surface);
+        free(expected.frames);
+        return false;
+    }
+    if (!jobSystemInit(&jobs, config->workers)) {
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+        free(expected.frames);
+        return false;
+    }
+    if (!boxBatchInit(&batch, GOLDEN_SCENE_BOXES, GOLDEN_SCENE_BOXES * WORLD_JOINTS_PER_BOX)) {
+        jobSystemDestroy(&jobs);
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+        free(expected.frames);
+        return false;
+    }
+
+    fprintf(out, "scene,bodies,frames,physics_ms_avg,render_ms_avg,render_ms_max,hash_ms_avg,mismatches\n");
+    bool ok = true;
+    int cursor = 0;
+    int frames = 0;
+    int mismatches = 0;
+    for (int i = 0; i < GOLDEN_SCENE_COUNT && ok; i++) {
+        GoldenResult result;
+        ok = runScene(&scenes[i], renderer, surface, &jobs, &batch, record ? NULL : &expected, &cursor,
+                      record ? &recorded : NULL, &result);
+        if (!ok) {
+            LOG_ERROR("Golden scene %s failed to run", scenes[i].name);
+            break;
+        }
+        int count = result.frames > 0 ? result.frames : 1;
+        fprintf(out, "%s,%d,%d,%.4f,%.4f,%.4f,%.4f,%d\n",
+                scenes[i].name, result.bodies, result.frames, result.physicsMs / count,
+                result.renderMs / count, result.renderMsMax, result.hashMs / count, result.mismatches);
+        frames += result.frames;
+        mismatches += result.mismatches;
+    }
+    if (ok && !record && cursor < expected.count) {
+        LOG_ERROR("Golden file has %d hashes for frames no scene rendered; regenerate it with --write-golden",
+                  expected.count - cursor);
+        ok = false;
+    }
+
+    if (ok && record) {
+        ok = writeGolden(&recorded, config->path);
+        if (ok) {
+            fprintf(out, "# Recorded %d frame hashes to %s\n", recorded.count, config->path);
+        }
+    } else if (ok) {
+        fprintf(out, "# %d frames in %d scenes checked against %s: %d mismatched\n",
+                frames, GOLDEN_SCENE_COUNT, config->path, mismatches);
+    }
+
+    boxBatchDestroy(&batch);
+    jobSystemDestroy(&jobs);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    free(expected.frames);
+    free(recorded.frames);
+    return ok && mismatches == 0;
+}
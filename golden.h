@@ -0,0 +1,26 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    const char *path;        // Golden hash file
+    bool write;              // Record the hashes to `path` instead of comparing
+    int workers;             // Job system workers for batch building, 0 = one per CPU
+} GoldenConfig;
+
+// Play the scripted scenes without a window: each tick is simulated, rendered
+// by the software renderer into a memory surface and hashed. Hashes are
+// compared with the golden file, or recorded to it with config->write; a
+// missing file is a failure otherwise. Physics, rendering and hashing are timed
+// separately and written to `out` per scene. Returns false on any mismatch or failure.
+bool runGoldenRender(const GoldenConfig *config, FILE *out);
+
+// 64-bit FNV-1a over the visible pixels of a 32-bit surface, row by row, so
+// pitch padding never affects the result
+uint64_t goldenHashSurface(const SDL_Surface *surface);
+
+#endif // GOLDEN_H
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Render the scripted golden scenes offscreen and compare every frame's pixel
+# hash with the checked-in reference. A missing reference fails the test;
+# record it once with --write-golden and commit it.
+#
+#   ./golden_render.sh [path/to/platformer] [path/to/render_golden.txt]
+
+GAME=${1:-./platformer}
+GOLDEN=${2:-bench/render_golden.txt}
+
+case "$GAME" in
+    /*) ;;
+    *) GAME="$(pwd)/$GAME" ;;
+esac
+case "$GOLDEN" in
+    /*) ;;
+    *) GOLDEN="$(pwd)/$GOLDEN" ;;
+esac
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -f "$GOLDEN" ]; then
+    echo "no reference at $GOLDEN"
+    echo "record one with: $GAME --golden $GOLDEN --write-golden"
+    exit 1
+fi
+
+(cd "$WORK" && "$GAME" --golden "$GOLDEN")
+STATUS=$?
+if [ "$STATUS" -ne 0 ]; then
+    echo "rendered frames differ from $GOLDEN (exit status $STATUS)"
+fi
+exit $STATUS
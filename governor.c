@@ -0,0 +1,124 @@
+#include "governor.h"
+#include "logging.h"
+#include <math.h>
+
+// Hysteresis: downgrade quickly when over budget, upgrade only after a long quiet period
+#define GOVERNOR_SMOOTHING 0.2
+#define GOVERNOR_DOWNGRADE_RATIO 0.90   // load above 90% of budget counts as over
+#define GOVERNOR_UPGRADE_RATIO 0.60     // load below 60% of budget counts as headroom
+#define GOVERNOR_DOWNGRADE_FRAMES 10
+#define GOVERNOR_UPGRADE_FRAMES 90
+#define GOVERNOR_COOLDOWN_FRAMES 30
+
+typedef struct {
+    int iterations;
+    int substeps;
+    cpFloat sleepThreshold;    // Seconds of idleness before a body sleeps
+    cpFloat idleSpeed;         // Speed below which a body counts as idle (0 = Chipmunk default)
+} QualityLevel;
+
+static const QualityLevel qualityLevels[GOVERNOR_LEVEL_COUNT] = {
+    {10, 2, INFINITY, 0.0},
+    {10, 1, INFINITY, 0.0},
+    { 8, 1, 1.0,      0.0},
+    { 6, 1, 0.5,      0.0},
+    { 4, 1, 0.25,     10.0},
+    { 2, 1, 0.1,      20.0},
+};
+
+void governorInit(PhysicsGovernor *governor, double budgetMs, bool enabled) {
+    PhysicsGovernor initial = {
+        .enabled = enabled,
+        .budgetMs = budgetMs,
+        .level = GOVERNOR_DEFAULT_LEVEL,
+        .lastReason = "initial"
+    };
+    *governor = initial;
+}
+
+static void changeLevel(PhysicsGovernor *governor, int level, const char *reason) {
+    if (level < 0) level = 0;
+    if (level >= GOVERNOR_LEVEL_COUNT) level = GOVERNOR_LEVEL_COUNT - 1;
+    if (level == governor->level) return;
+
+    const QualityLevel *q = &qualityLevels[level];
+    LOG_INFO("Governor: level %d -> %d (%s), load %.2f ms of %.2f ms budget, "
+             "iterations %d, substeps %d, sleep %.2f",
+             governor->level, level, reason, governor->loadMs, governor->budgetMs,
+             q->iterations, q->substeps, q->sleepThreshold);
+
+    governor->level = level;
+    governor->lastReason = reason;
+    governor->changes++;
+    governor->overBudgetFrames = 0;
+    governor->underBudgetFrames = 0;
+    governor->cooldownFrames = GOVERNOR_COOLDOWN_FRAMES;
+}
+
+bool governorUpdate(PhysicsGovernor *governor, double stepMs, double renderMs) {
+    double sample = stepMs + renderMs;
+    governor->loadMs = (governor->loadMs == 0.0) ? sample
+                     : governor->loadMs + (sample - governor->loadMs) * GOVERNOR_SMOOTHING;
+
+    if (!governor->enabled) {
+        return false;
+    }
+
+    int previous = governor->level;
+
+    // A single step that eats the whole budget is a spawn burst: react at once,
+    // but only once per cooldown, so a run of spikes can't fall through every level
+    if (stepMs > governor->budgetMs && governor->cooldownFrames == 0) {
+        changeLevel(governor, governor->level + 1, "step over budget");
+        return governor->level != previous;
+    }
+
+    if (governor->cooldownFrames > 0) {
+        governor->cooldownFrames--;
+        return false;
+    }
+
+    if (governor->loadMs > governor->budgetMs * GOVERNOR_DOWNGRADE_RATIO) {
+        governor->underBudgetFrames = 0;
+        if (++governor->overBudgetFrames >= GOVERNOR_DOWNGRADE_FRAMES) {
+            changeLevel(governor, governor->level + 1, "sustained load");
+        }
+    } else if (governor->loadMs < governor->budgetMs * GOVERNOR_UPGRADE_RATIO) {
+        governor->overBudgetFrames = 0;
+        if (++governor->underBudgetFrames >= GOVERNOR_UPGRADE_FRAMES) {
+            changeLevel(governor, governor->level - 1, "headroom");
+        }
+    } else {
+        governor->overBudgetFrames = 0;
+        governor->underBudgetFrames = 0;
+    }
+
+    return governor->level != previous;
+}
+
+void governorApply(const PhysicsGovernor *governor, cpSpace *space) {
+    const QualityLevel *q = &qualityLevels[governor->level];
+    cpSpaceSetIterations(space, q->iterations);
+    cpSpaceSetSleepTimeThreshold(space, q->sleepThreshold);
+    cpSpaceSetIdleSpeedThreshold(space, q->idleSpeed);
+}
+
+void governorStep(const PhysicsGovernor *governor, cpSpace *space, cpFloat dt) {
+    int substeps = qualityLevels[governor->level].substeps;
+    cpFloat subDt = dt / substeps;
+    for (int i = 0; i < substeps; i++) {
+        cpSpaceStep(space, subDt);
+    }
+}
+
+int governorIterations(const PhysicsGovernor *governor) {
+    return qualityLevels[governor->level].iterations;
+}
+
+int governorSubsteps(const PhysicsGovernor *governor) {
+    return qualityLevels[governor->level].substeps;
+}
+
+cpFloat governorSleepThreshold(const PhysicsGovernor *governor) {
+    return qualityLevels[governor->level].sleepThreshold;
+}
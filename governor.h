@@ -0,0 +1,42 @@
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <chipmunk/chipmunk.h>
+#include <stdbool.h>
+
+// Physics quality levels, 0 = best quality, GOVERNOR_LEVEL_COUNT-1 = cheapest
+#define GOVERNOR_LEVEL_COUNT 6
+#define GOVERNOR_DEFAULT_LEVEL 1    // Chipmunk defaults: 10 iterations, 1 substep, no sleeping
+
+// Adaptive physics quality governor. Watches step + render time against a
+// frame budget and trades solver quality for time under load.
+typedef struct {
+    bool enabled;
+    double budgetMs;          // Target frame budget
+    int level;                // Current quality level
+    double loadMs;            // Smoothed step + render time
+    int overBudgetFrames;     // Consecutive frames above the downgrade threshold
+    int underBudgetFrames;    // Consecutive frames below the upgrade threshold
+    int cooldownFrames;       // Frames left before another change is allowed
+    int changes;              // Number of level changes so far
+    const char *lastReason;   // Why the last change happened
+} PhysicsGovernor;
+
+// Initialize at the default level
+void governorInit(PhysicsGovernor *governor, double budgetMs, bool enabled);
+
+// Feed one frame of measurements. Returns true when the level changed.
+bool governorUpdate(PhysicsGovernor *governor, double stepMs, double renderMs);
+
+// Apply the current level's iterations and sleep settings to a space
+void governorApply(const PhysicsGovernor *governor, cpSpace *space);
+
+// Step the space with the current level's substep count
+void governorStep(const PhysicsGovernor *governor, cpSpace *space, cpFloat dt);
+
+// Settings of the current level
+int governorIterations(const PhysicsGovernor *governor);
+int governorSubsteps(const PhysicsGovernor *governor);
+cpFloat governorSleepThreshold(const PhysicsGovernor *governor);
+
+#endif // GOVERNOR_H
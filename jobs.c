@@ -0,0 +1,172 @@
+#include "jobs.h"
+#include "logging.h"
+#include "alloc.h"
+#include <string.h>
+
+static bool queuePush(JobQueue *queue, const Job *job) {
+    bool pushed = false;
+    SDL_AtomicLock(&queue->lock);
+    if (queue->bottom - queue->top < JOB_QUEUE_CAPACITY) {
+        queue->jobs[queue->bottom & (JOB_QUEUE_CAPACITY - 1)] = *job;
+        queue->bottom++;
+        pushed = true;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return pushed;
+}
+
+// Owner end: newest job first, keeps recently pushed data warm
+static bool queuePop(JobQueue *queue, Job *job) {
+    bool popped = false;
+    SDL_AtomicLock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        queue->bottom--;
+        *job = queue->jobs[queue->bottom & (JOB_QUEUE_CAPACITY - 1)];
+        popped = true;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return popped;
+}
+
+// Thief end: oldest job first
+static bool queueSteal(JobQueue *queue, Job *job) {
+    bool stolen = false;
+    SDL_AtomicLock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        *job = queue->jobs[queue->top & (JOB_QUEUE_CAPACITY - 1)];
+        queue->top++;
+        stolen = true;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return stolen;
+}
+
+static void runJob(JobSystem *jobs, const Job *job) {
+    job->func(job->data, job->begin, job->end);
+    SDL_AtomicAdd(&job->counter->pending, -1);
+    SDL_AtomicAdd(&jobs->executed, 1);
+}
+
+// Run one job from our own queue, or steal one. Returns false if all queues are empty.
+static bool runOne(JobSystem *jobs, int self) {
+    Job job;
+    if (queuePop(&jobs->queues[self], &job)) {
+        runJob(jobs, &job);
+        return true;
+    }
+    for (int i = 1; i < jobs->workerCount; i++) {
+        int victim = (self + i) % jobs->workerCount;
+        if (queueSteal(&jobs->queues[victim], &job)) {
+            SDL_AtomicAdd(&jobs->stolen, 1);
+            runJob(jobs, &job);
+            return true;
+        }
+    }
+    return false;
+}
+
+static int workerThread(void *data) {
+    JobWorker *worker = data;
+    JobSystem *jobs = worker->jobs;
+    allocSetTag(ALLOC_TAG_JOBS);
+
+    while (true) {
+        SDL_SemWait(jobs->wake);
+        if (SDL_AtomicGet(&jobs->quit)) {
+            break;
+        }
+        // The job this post was for may already have been taken; that's fine
+        while (runOne(jobs, worker->index)) {
+        }
+    }
+    return 0;
+}
+
+bool jobSystemInit(JobSystem *jobs, int workerCount) {
+    memset(jobs, 0, sizeof(*jobs));
+
+    if (workerCount <= 0) {
+        workerCount = SDL_GetCPUCount();
+    }
+    if (workerCount > JOB_MAX_WORKERS) {
+        workerCount = JOB_MAX_WORKERS;
+    }
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+
+    jobs->wake = SDL_CreateSemaphore(0);
+    if (!jobs->wake) {
+        LOG_ERROR("Failed to create job semaphore: %s", SDL_GetError());
+        return false;
+    }
+
+    jobs->workerCount = 1;
+    for (int i = 1; i < workerCount; i++) {
+        jobs->workers[i].jobs = jobs;
+        jobs->workers[i].index = i;
+        jobs->threads[i] = SDL_CreateThread(workerThread, "job worker", &jobs->workers[i]);
+        if (!jobs->threads[i]) {
+            LOG_WARNING("Failed to create job worker %d: %s", i, SDL_GetError());
+            break;
+        }
+        jobs->workerCount++;
+    }
+
+    LOG_INFO("Job system started with %d workers", jobs->workerCount);
+    return true;
+}
+
+void jobSystemDestroy(JobSystem *jobs) {
+    if (!jobs->wake) {
+        return;
+    }
+
+    SDL_AtomicSet(&jobs->quit, 1);
+    for (int i = 1; i < jobs->workerCount; i++) {
+        SDL_SemPost(jobs->wake);
+    }
+    for (int i = 1; i < jobs->workerCount; i++) {
+        SDL_WaitThread(jobs->threads[i], NULL);
+        jobs->threads[i] = NULL;
+    }
+
+    SDL_DestroySemaphore(jobs->wake);
+    jobs->wake = NULL;
+}
+
+static void submitTo(JobSystem *jobs, int worker, const Job *job) {
+    SDL_AtomicAdd(&job->counter->pending, 1);
+    if (jobs->workerCount > 1 && queuePush(&jobs->queues[worker], job)) {
+        SDL_SemPost(jobs->wake);
+    } else {
+        runJob(jobs, job);
+    }
+}
+
+void jobSubmit(JobSystem *jobs, JobFunc func, void *data, int begin, int end, JobCounter *counter) {
+    Job job = {func, data, begin, end, counter};
+    submitTo(jobs, 0, &job);
+}
+
+int jobParallelFor(JobSystem *jobs, int count, int grain, JobFunc func, void *data, JobCounter *counter) {
+    if (grain < 1) {
+        grain = 1;
+    }
+
+    int chunks = 0;
+    for (int begin = 0; begin < count; begin += grain) {
+        int end = begin + grain < count ? begin + grain : count;
+        Job job = {func, data, begin, end, counter};
+        submitTo(jobs, chunks % jobs->workerCount, &job);
+        chunks++;
+    }
+    return chunks;
+}
+
+void jobWait(JobSystem *jobs, JobCounter *counter) {
+    while (SDL_AtomicGet(&counter->pending) > 0) {
+        // Help out instead of blocking; spin only when everything is in flight
+        runOne(jobs, 0);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#define JOB_MAX_WORKERS 16
+#define JOB_QUEUE_CAPACITY 256     // Per worker, power of two
+
+// Process items [begin, end) of a range
+typedef void (*JobFunc)(void *data, int begin, int end);
+
+// Number of outstanding jobs in a phase. A phase that depends on another
+// waits for its counter to reach zero before being submitted.
+typedef struct {
+    SDL_atomic_t pending;
+} JobCounter;
+
+typedef struct {
+    JobFunc func;
+    void *data;
+    int begin, end;
+    JobCounter *counter;
+} Job;
+
+// Double-ended job queue: the owner pushes and pops at the bottom,
+// idle workers steal from the top
+typedef struct {
+    Job jobs[JOB_QUEUE_CAPACITY];
+    int top;
+    int bottom;
+    SDL_SpinLock lock;
+} JobQueue;
+
+struct JobSystem;
+
+// Thread start argument for one worker
+typedef struct {
+    struct JobSystem *jobs;
+    int index;
+} JobWorker;
+
+// Work-stealing scheduler. Worker 0 is the thread that created the system
+// and is the only one allowed to submit and wait; it runs jobs while waiting.
+typedef struct JobSystem {
+    int workerCount;                // Including the submitting thread
+    JobQueue queues[JOB_MAX_WORKERS];
+    SDL_Thread *threads[JOB_MAX_WORKERS];
+    JobWorker workers[JOB_MAX_WORKERS];
+    SDL_sem *wake;                  // Posted once per queued job
+    SDL_atomic_t quit;
+
+    // Statistics
+    SDL_atomic_t executed;
+    SDL_atomic_t stolen;
+} JobSystem;
+
+// Start `workerCount - 1` threads (0 = one per CPU, capped at JOB_MAX_WORKERS)
+bool jobSystemInit(JobSystem *jobs, int workerCount);
+void jobSystemDestroy(JobSystem *jobs);
+
+// Queue one job; runs it inline if the queue is full or there are no workers
+void jobSubmit(JobSystem *jobs, JobFunc func, void *data, int begin, int end, JobCounter *counter);
+
+// Split [0, count) into chunks of `grain` items spread round-robin over all
+// workers. Chunks write disjoint output, so results do not depend on which
+// worker ran them. Returns the number of chunks.
+int jobParallelFor(JobSystem *jobs, int count, int grain, JobFunc func, void *data, JobCounter *counter);
+
+// Run queued jobs until the counter reaches zero
+void jobWait(JobSystem *jobs, JobCounter *counter);
+
+#endif // JOBS_H
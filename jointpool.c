@@ -0,0 +1,66 @@
+#include "jointpool.h"
+#include "alloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool jointPoolInit(JointPool *pool, int capacity) {
+    memset(pool, 0, sizeof(*pool));
+
+    pool->joints = allocCalloc(ALLOC_TAG_PHYSICS, capacity, sizeof(JointStorage));
+    pool->freeSlots = allocMalloc(ALLOC_TAG_PHYSICS, sizeof(int) * capacity);
+    if (!pool->joints || !pool->freeSlots) {
+        fprintf(stderr, "Failed to allocate joint pool for %d joints\n", capacity);
+        jointPoolDestroy(pool);
+        return false;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        pool->freeSlots[i] = capacity - 1 - i;
+    }
+    pool->freeCount = capacity;
+    pool->capacity = capacity;
+    return true;
+}
+
+void jointPoolDestroy(JointPool *pool) {
+    allocFree(ALLOC_TAG_PHYSICS, pool->joints);
+    allocFree(ALLOC_TAG_PHYSICS, pool->freeSlots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+cpConstraint *jointPoolAcquire(JointPool *pool, JointType type, cpBody *a, cpBody *b,
+                               cpVect anchorA, cpVect anchorB, cpFloat min, cpFloat max) {
+    if (pool->freeCount == 0) {
+        pool->exhausted++;
+        return NULL;
+    }
+
+    JointStorage *storage = &pool->joints[pool->freeSlots[--pool->freeCount]];
+    switch (type) {
+        case JOINT_PIN:
+            cpPinJointInit(&storage->pin, a, b, anchorA, anchorB);
+            break;
+        case JOINT_SLIDE:
+            cpSlideJointInit(&storage->slide, a, b, anchorA, anchorB, min, max);
+            break;
+        case JOINT_PIVOT:
+            cpPivotJointInit(&storage->pivot, a, b, anchorA, anchorB);
+            break;
+    }
+
+    pool->live++;
+    if (pool->live > pool->highWater) {
+        pool->highWater = pool->live;
+    }
+    return &storage->constraint;
+}
+
+void jointPoolRelease(JointPool *pool, cpConstraint *joint) {
+    cpConstraintDestroy(joint);
+
+    // The constraint is the first member of every union variant
+    int slot = (int)((JointStorage *)joint - pool->joints);
+    pool->freeSlots[pool->freeCount++] = slot;
+    pool->live--;
+}
@@ -0,0 +1,52 @@
+#ifndef JOINTPOOL_H
+#define JOINTPOOL_H
+
+#include <chipmunk/chipmunk.h>
+#include <chipmunk/chipmunk_structs.h>
+#include <stdbool.h>
+
+// Joint types a pool slot can hold
+typedef enum {
+    JOINT_PIN,               // Fixed distance between two anchors (rope segment)
+    JOINT_SLIDE,             // Distance between a minimum and a maximum (slack rope)
+    JOINT_PIVOT              // Shared point both bodies rotate around (hinge)
+} JointType;
+
+// Every slot is big enough for any supported joint
+typedef union {
+    cpConstraint constraint;
+    cpPinJoint pin;
+    cpSlideJoint slide;
+    cpPivotJoint pivot;
+} JointStorage;
+
+// Preallocated slab storage for constraints, the joint counterpart of BoxPool.
+// Joints are initialized in place with cpPinJointInit and friends, so building
+// and tearing down ropes and bridges never touches the heap once the pool exists.
+typedef struct {
+    JointStorage *joints;     // Slab of `capacity` joints
+    int *freeSlots;           // Stack of unused slot indices
+    int freeCount;
+    int capacity;
+
+    // Allocation counters
+    int live;
+    int highWater;
+    unsigned long exhausted;  // Joints refused because the pool was full
+} JointPool;
+
+// Allocate the slab. This is the only heap allocation the pool makes.
+bool jointPoolInit(JointPool *pool, int capacity);
+
+// Free the slab. Every slot must have been released (or its space freed) first.
+void jointPoolDestroy(JointPool *pool);
+
+// Initialize a joint in a free slot. Anchors are in body-local coordinates; min
+// and max are only used by JOINT_SLIDE. Returns NULL when the pool is full.
+cpConstraint *jointPoolAcquire(JointPool *pool, JointType type, cpBody *a, cpBody *b,
+                               cpVect anchorA, cpVect anchorB, cpFloat min, cpFloat max);
+
+// Destroy a joint and return its slot to the free list. It must already be removed from its space.
+void jointPoolRelease(JointPool *pool, cpConstraint *joint);
+
+#endif // JOINTPOOL_H
@@ -0,0 +1,124 @@
+#include "layers.h"
+#include "world.h"
+#include "physstats.h"
+#include <SDL2/SDL.h>
+#include <string.h>
+
+static const char *layerNames[LAYER_COUNT] = {
+    "player", "props", "static", "triggers", "debris"
+};
+
+const char *layerName(CollisionLayer layer) {
+    if (layer < 0 || layer >= LAYER_COUNT) {
+        return "unknown";
+    }
+    return layerNames[layer];
+}
+
+void collisionMatrixSet(CollisionMatrix *matrix, CollisionLayer a, CollisionLayer b, bool collides) {
+    matrix->collides[a][b] = collides;
+    matrix->collides[b][a] = collides;
+}
+
+void collisionMatrixAll(CollisionMatrix *matrix) {
+    for (int a = 0; a < LAYER_COUNT; a++) {
+        for (int b = 0; b < LAYER_COUNT; b++) {
+            matrix->collides[a][b] = true;
+        }
+    }
+}
+
+void collisionMatrixDefault(CollisionMatrix *matrix) {
+    collisionMatrixAll(matrix);
+
+    collisionMatrixSet(matrix, LAYER_DEBRIS, LAYER_DEBRIS, false);
+    collisionMatrixSet(matrix, LAYER_STATIC, LAYER_STATIC, false);
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        if (layer != LAYER_PLAYER) {
+            collisionMatrixSet(matrix, LAYER_TRIGGERS, (CollisionLayer)layer, false);
+        }
+    }
+}
+
+cpShapeFilter layerShapeFilter(const CollisionMatrix *matrix, CollisionLayer layer) {
+    cpBitmask mask = 0;
+    for (int other = 0; other < LAYER_COUNT; other++) {
+        if (matrix->collides[layer][other]) {
+            mask |= LAYER_BIT(other);
+        }
+    }
+    return cpShapeFilterNew(CP_NO_GROUP, LAYER_BIT(layer), mask);
+}
+
+cpShapeFilter layerQueryFilter(cpBitmask layers) {
+    // Every shape's mask accepts some category, so only the query's mask decides
+    return cpShapeFilterNew(CP_NO_GROUP, CP_ALL_CATEGORIES, layers);
+}
+
+#define BENCH_PROPS 100
+#define BENCH_DEBRIS 900
+#define BENCH_SETTLE_STEPS 120
+#define BENCH_MEASURE_STEPS 60
+
+static unsigned int nextRandom(unsigned int *state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7fff;
+}
+
+// Averages over the measured steps for one collision matrix
+static void measureLayers(const char *label, const CollisionMatrix *matrix, unsigned int seed, FILE *out) {
+    World world;
+    if (!createWorld(&world, BENCH_PROPS + BENCH_DEBRIS)) {
+        return;
+    }
+    setCollisionMatrix(&world, matrix);
+
+    // Props and debris dropped into the same column so they pile up together
+    unsigned int state = seed;
+    for (int i = 0; i < BENCH_PROPS + BENCH_DEBRIS; i++) {
+        CollisionLayer layer = i < BENCH_PROPS ? LAYER_PROPS : LAYER_DEBRIS;
+        cpFloat size = layer == LAYER_PROPS ? 30.0 : 15.0;
+        cpVect pos = cpv(250 + nextRandom(&state) % 300, GROUND_HEIGHT + 20 + nextRandom(&state) % 1500);
+        spawnBoxOnLayer(&world, pos, size, size, layer);
+    }
+
+    const cpFloat dt = 1.0 / 60.0;
+    for (int i = 0; i < BENCH_SETTLE_STEPS; i++) {
+        cpSpaceStep(world.space, dt);
+    }
+
+    double stepMs = 0.0;
+    double pairs = 0.0, candidates = 0.0, arbiters = 0.0, contacts = 0.0;
+    for (int i = 0; i < BENCH_MEASURE_STEPS; i++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        cpSpaceStep(world.space, dt);
+        double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+        PhysicsStats stats;
+        physicsStatsCollect(&stats, world.space, ms, true, 0);
+        stepMs += ms;
+        pairs += stats.broadphasePairs;
+        candidates += stats.candidatePairs;
+        arbiters += stats.arbiters;
+        contacts += stats.contacts;
+    }
+
+    fprintf(out, "%s,%d,%d,%.3f,%.0f,%.0f,%.0f,%.0f,%.1f\n", label, BENCH_PROPS, BENCH_DEBRIS,
+            stepMs / BENCH_MEASURE_STEPS, pairs / BENCH_MEASURE_STEPS,
+            candidates / BENCH_MEASURE_STEPS, arbiters / BENCH_MEASURE_STEPS,
+            contacts / BENCH_MEASURE_STEPS,
+            pairs > 0.0 ? 100.0 * (pairs - candidates) / pairs : 0.0);
+    fflush(out);
+
+    destroyWorld(&world);
+}
+
+void runLayerBenchmark(unsigned int seed, FILE *out) {
+    CollisionMatrix all, layered;
+    collisionMatrixAll(&all);
+    collisionMatrixDefault(&layered);
+
+    fprintf(out, "matrix,props,debris,step_ms,broadphase_pairs,candidate_pairs,arbiters,contacts,pruned_pct\n");
+    measureLayers("all", &all, seed, out);
+    measureLayers("layered", &layered, seed, out);
+}
@@ -0,0 +1,48 @@
+#ifndef LAYERS_H
+#define LAYERS_H
+
+#include <chipmunk/chipmunk.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// Named collision layers; each maps to one Chipmunk category bit
+typedef enum {
+    LAYER_PLAYER,
+    LAYER_PROPS,       // Spawned and scenario boxes
+    LAYER_STATIC,      // Ground and level geometry
+    LAYER_TRIGGERS,    // Sensors that only react to the player
+    LAYER_DEBRIS,      // Box rain and other throwaway bodies
+    LAYER_COUNT
+} CollisionLayer;
+
+#define LAYER_BIT(layer) ((cpBitmask)1 << (layer))
+
+// Which layers collide with which. Always symmetric.
+typedef struct {
+    bool collides[LAYER_COUNT][LAYER_COUNT];
+} CollisionMatrix;
+
+const char *layerName(CollisionLayer layer);
+
+// Everything collides except debris/debris, static/static, and triggers with
+// anything but the player
+void collisionMatrixDefault(CollisionMatrix *matrix);
+
+// Every layer collides with every layer (no pruning)
+void collisionMatrixAll(CollisionMatrix *matrix);
+
+// Set both directions of a layer pair
+void collisionMatrixSet(CollisionMatrix *matrix, CollisionLayer a, CollisionLayer b, bool collides);
+
+// Shape filter for a shape on `layer`: its category bit, masked by the matrix row.
+// Chipmunk rejects pairs whose filters don't match before the narrowphase.
+cpShapeFilter layerShapeFilter(const CollisionMatrix *matrix, CollisionLayer layer);
+
+// Filter for space queries that only hit shapes on the given layers
+cpShapeFilter layerQueryFilter(cpBitmask layers);
+
+// Compare broadphase and narrowphase pair counts with and without the
+// default matrix on a debris-heavy pile, write CSV to `out`
+void runLayerBenchmark(unsigned int seed, FILE *out);
+
+#endif // LAYERS_H
@@ -0,0 +1,217 @@
+#include "linkage.h"
+#include <math.h>
+
+// Default spacing between joints and link sizes
+#define ROPE_LINK_LENGTH 16.0
+#define ROPE_LINK_SIZE 6.0
+#define CHAIN_LINK_LENGTH 18.0
+#define CHAIN_LINK_THICKNESS 6.0
+#define BRIDGE_PLANK_LENGTH 30.0
+#define BRIDGE_PLANK_THICKNESS 8.0
+#define BRIDGE_SAG_ANGLE 0.15       // Each half of a bridge dips or rises this much (radians)
+#define SWING_LINK_LENGTH 14.0
+#define SWING_ROPE_SPACING 100.0    // Between the two ropes of a swing
+#define SWING_PLATFORM_WIDTH 120.0
+#define SWING_PLATFORM_HEIGHT 12.0
+
+static const char *linkageNames[LINKAGE_COUNT] = {
+    "rope", "chain", "bridge", "swing"
+};
+
+const char *linkageName(LinkageType type) {
+    if (type < 0 || type >= LINKAGE_COUNT) {
+        return "unknown";
+    }
+    return linkageNames[type];
+}
+
+// Undo the newest box when the joint that should hold it can't be made
+static void despawnNewest(World *world) {
+    despawnBox(world, world->boxCount - 1);
+}
+
+static cpBody *spawnLink(World *world, cpVect position, cpFloat angle, cpFloat width, cpFloat height) {
+    Box *box = spawnBox(world, position, width, height);
+    if (!box) {
+        return NULL;
+    }
+    cpBodySetAngle(box->body, angle);
+    return box->body;
+}
+
+// Links spaced `length` apart along `direction`, each held center to center to
+// the previous one; the first is held to `from` at `fromAnchor` (body-local).
+// Pin joints make a taut rope, slide joints one that can go slack.
+static int spawnRopeStrand(World *world, cpBody *from, cpVect fromAnchor, cpVect direction,
+                           int links, cpFloat length, JointType type, cpBody **last) {
+    cpFloat size = fmin(ROPE_LINK_SIZE, length * 0.6);
+    cpVect start = cpBodyLocalToWorld(from, fromAnchor);
+    cpBody *previous = from;
+    cpVect previousAnchor = fromAnchor;
+
+    int spawned = 0;
+    for (int i = 0; i < links; i++) {
+        cpBody *link = spawnLink(world, cpvadd(start, cpvmult(direction, length * (i + 1))), 0.0, size, size);
+        if (!link) {
+            break;
+        }
+        if (!addJoint(world, type, previous, link, previousAnchor, cpvzero, 0.0, length)) {
+            despawnNewest(world);
+            break;
+        }
+        previous = link;
+        previousAnchor = cpvzero;
+        spawned++;
+    }
+    *last = previous;
+    return spawned;
+}
+
+// Bars `length` long hinged end to end from `anchor` on the static body. The
+// first `bend` bars head along `first`, the rest along `second`. Returns the
+// bars spawned; `last` and `end` get the final bar and its free end.
+static int spawnHingedStrand(World *world, cpVect anchor, cpVect first, cpVect second, int bend,
+                             int links, cpFloat length, cpFloat thickness, cpBody **last, cpVect *end) {
+    cpBody *previous = cpSpaceGetStaticBody(world->space);
+    cpVect previousAnchor = anchor;
+    cpVect joint = anchor;
+    cpVect tail = cpv(-length / 2, 0);
+    cpVect head = cpv(length / 2, 0);
+
+    int spawned = 0;
+    for (int i = 0; i < links; i++) {
+        cpVect direction = i < bend ? first : second;
+        cpVect center = cpvadd(joint, cpvmult(direction, length / 2));
+        cpBody *bar = spawnLink(world, center, atan2(direction.y, direction.x), length, thickness);
+        if (!bar) {
+            break;
+        }
+        if (!addJoint(world, JOINT_PIVOT, previous, bar, previousAnchor, tail, 0.0, 0.0)) {
+            despawnNewest(world);
+            break;
+        }
+        previous = bar;
+        previousAnchor = head;
+        joint = cpvadd(joint, cpvmult(direction, length));
+        spawned++;
+    }
+    *last = previous;
+    *end = joint;
+    return spawned;
+}
+
+static int spawnBridge(World *world, cpVect anchor, int planks, cpFloat length) {
+    cpVect down = cpv(cos(BRIDGE_SAG_ANGLE), -sin(BRIDGE_SAG_ANGLE));
+    cpVect up = cpv(down.x, -down.y);
+    cpFloat thickness = fmin(BRIDGE_PLANK_THICKNESS, length * 0.5);
+    cpBody *last;
+    cpVect end;
+
+    // Laid out already sagging, so every hinge starts exactly satisfied
+    int spawned = spawnHingedStrand(world, anchor, down, up, planks / 2, planks, length, thickness, &last, &end);
+    if (spawned > 0) {
+        addJoint(world, JOINT_PIVOT, last, cpSpaceGetStaticBody(world->space),
+                 cpv(length / 2, 0), end, 0.0, 0.0);
+    }
+    return spawned;
+}
+
+static int spawnSwing(World *world, cpVect anchor, int links, cpFloat length) {
+    cpBody *ground = cpSpaceGetStaticBody(world->space);
+    cpVect down = cpv(0, -1);
+    cpBody *leftEnd, *rightEnd;
+    int left = spawnRopeStrand(world, ground, cpv(anchor.x - SWING_ROPE_SPACING / 2, anchor.y),
+                               down, links, length, JOINT_SLIDE, &leftEnd);
+    int right = spawnRopeStrand(world, ground, cpv(anchor.x + SWING_ROPE_SPACING / 2, anchor.y),
+                                down, links, length, JOINT_SLIDE, &rightEnd);
+    if (left < links || right < links) {
+        return left + right;
+    }
+
+    cpVect top = cpv(anchor.x, anchor.y - length * (links + 1));
+    cpBody *platform = spawnLink(world, cpv(top.x, top.y - SWING_PLATFORM_HEIGHT / 2), 0.0,
+                                 SWING_PLATFORM_WIDTH, SWING_PLATFORM_HEIGHT);
+    if (!platform) {
+        return left + right;
+    }
+    cpVect leftCorner = cpv(-SWING_ROPE_SPACING / 2, SWING_PLATFORM_HEIGHT / 2);
+    cpVect rightCorner = cpv(SWING_ROPE_SPACING / 2, SWING_PLATFORM_HEIGHT / 2);
+    if (!addJoint(world, JOINT_SLIDE, leftEnd, platform, cpvzero, leftCorner, 0.0, length) ||
+        !addJoint(world, JOINT_SLIDE, rightEnd, platform, cpvzero, rightCorner, 0.0, length)) {
+        despawnNewest(world);
+        return left + right;
+    }
+    return left + right + 1;
+}
+
+int spawnLinkage(World *world, LinkageType type, cpVect anchor, int links, cpFloat linkLength) {
+    if (links < 1) {
+        links = LINKAGE_DEFAULT_LINKS;
+    }
+
+    cpBody *last;
+    cpVect end;
+    switch (type) {
+        case LINKAGE_ROPE:
+            return spawnRopeStrand(world, cpSpaceGetStaticBody(world->space), anchor, cpv(1, 0), links,
+                                   linkLength > 0 ? linkLength : ROPE_LINK_LENGTH, JOINT_PIN, &last);
+        case LINKAGE_CHAIN: {
+            cpFloat length = linkLength > 0 ? linkLength : CHAIN_LINK_LENGTH;
+            return spawnHingedStrand(world, anchor, cpv(1, 0), cpv(1, 0), links, links, length,
+                                     fmin(CHAIN_LINK_THICKNESS, length * 0.4), &last, &end);
+        }
+        case LINKAGE_BRIDGE:
+            return spawnBridge(world, anchor, links, linkLength > 0 ? linkLength : BRIDGE_PLANK_LENGTH);
+        case LINKAGE_SWING:
+            return spawnSwing(world, anchor, links, linkLength > 0 ? linkLength : SWING_LINK_LENGTH);
+        default:
+            return 0;
+    }
+}
+
+bool jointAnchors(const cpConstraint *joint, cpVect *a, cpVect *b) {
+    cpBody *bodyA = cpConstraintGetBodyA(joint);
+    cpBody *bodyB = cpConstraintGetBodyB(joint);
+    if (cpConstraintIsPinJoint(joint)) {
+        *a = cpBodyLocalToWorld(bodyA, cpPinJointGetAnchorA(joint));
+        *b = cpBodyLocalToWorld(bodyB, cpPinJointGetAnchorB(joint));
+    } else if (cpConstraintIsSlideJoint(joint)) {
+        *a = cpBodyLocalToWorld(bodyA, cpSlideJointGetAnchorA(joint));
+        *b = cpBodyLocalToWorld(bodyB, cpSlideJointGetAnchorB(joint));
+    } else if (cpConstraintIsPivotJoint(joint)) {
+        *a = cpBodyLocalToWorld(bodyA, cpPivotJointGetAnchorA(joint));
+        *b = cpBodyLocalToWorld(bodyB, cpPivotJointGetAnchorB(joint));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double linkageMaxError(const World *world) {
+    double worst = 0.0;
+    for (int i = 0; i < world->jointCount; i++) {
+        const cpConstraint *joint = world->joints[i];
+        cpVect a, b;
+        if (!jointAnchors(joint, &a, &b)) {
+            continue;
+        }
+
+        double distance = cpvdist(a, b);
+        double error = 0.0;
+        if (cpConstraintIsPinJoint(joint)) {
+            error = fabs(distance - cpPinJointGetDist(joint));
+        } else if (cpConstraintIsSlideJoint(joint)) {
+            double min = cpSlideJointGetMin(joint), max = cpSlideJointGetMax(joint);
+            error = distance > max ? distance - max : (distance < min ? min - distance : 0.0);
+        } else {
+            error = distance;
+        }
+        if (isnan(error)) {
+            return INFINITY;  // The solver blew up
+        }
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    return worst;
+}
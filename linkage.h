@@ -0,0 +1,37 @@
+#ifndef LINKAGE_H
+#define LINKAGE_H
+
+#include <stdbool.h>
+#include "world.h"
+
+#define LINKAGE_DEFAULT_LINKS 12
+
+// Structures built from many jointed bodies. Every link is a pooled box, so
+// links render, despawn and count like any other box; their joints come from
+// the world's joint pool.
+typedef enum {
+    LINKAGE_ROPE,          // Small links held at a fixed distance by pin joints
+    LINKAGE_CHAIN,         // Bar links hinged end to end by pivot joints
+    LINKAGE_BRIDGE,        // Planks hinged end to end, pivoted to the world at both ends
+    LINKAGE_SWING,         // Platform hanging from two slack ropes of slide joints
+    LINKAGE_COUNT
+} LinkageType;
+
+// Linkage name for the command line and reports
+const char *linkageName(LinkageType type);
+
+// Build a linkage anchored to the static body at `anchor`, with `links` links
+// per rope or plank count. Ropes and chains start horizontal and swing down,
+// bridges run to the right, swings hang below. `linkLength` <= 0 uses the
+// type's default spacing. Returns the number of bodies spawned; a linkage cut
+// short by a full pool is still fully jointed.
+int spawnLinkage(World *world, LinkageType type, cpVect anchor, int links, cpFloat linkLength);
+
+// World-space anchor points of a pin, slide or pivot joint. False for other joints.
+bool jointAnchors(const cpConstraint *joint, cpVect *a, cpVect *b);
+
+// Largest constraint violation over every joint in the world, in pixels:
+// stretch of pin joints, overshoot of slide joint limits, separation of pivots
+double linkageMaxError(const World *world);
+
+#endif // LINKAGE_H
@@ -0,0 +1,136 @@
+#include "lod.h"
+#include <math.h>
+
+void lodDefaultConfig(LodConfig *config) {
+    config->sleepRadius = WINDOW_WIDTH * 0.75;
+    config->freezeRadius = WINDOW_WIDTH * 1.25;
+    config->hysteresis = WINDOW_WIDTH * 0.125;
+    config->restSpeed = 5.0;
+    config->restAngularSpeed = 0.5;
+    config->maxTransitions = 256;
+}
+
+void lodInit(LodSystem *lod, const LodConfig *config) {
+    lod->config = *config;
+    LodStats empty = {0};
+    lod->stats = empty;
+}
+
+static bool atRest(const LodConfig *config, cpBody *body) {
+    if (cpBodyIsSleeping(body)) {
+        return true;
+    }
+    cpVect v = cpBodyGetVelocity(body);
+    return cpvlengthsq(v) < config->restSpeed * config->restSpeed &&
+           fabs(cpBodyGetAngularVelocity(body)) < config->restAngularSpeed;
+}
+
+// Static bodies are skipped by integration, the solver and the dynamic broadphase
+static void freezeBox(Box *box) {
+    box->lodMass = cpBodyGetMass(box->body);
+    box->lodMoment = cpBodyGetMoment(box->body);
+    cpBodySetType(box->body, CP_BODY_TYPE_STATIC);
+    box->lod = LOD_FROZEN;
+}
+
+// Jointed bodies only ever sleep: a joint between two static bodies has no mass
+// to solve with, and Chipmunk already sleeps a linkage as one component
+static bool canFreeze(const LodConfig *config, Box *box) {
+    return atRest(config, box->body) && !bodyHasJoints(box->body);
+}
+
+static void thawBox(Box *box) {
+    // Wake anything resting on it first; it is about to be able to move
+    cpBodyActivateStatic(box->body, NULL);
+    cpBodySetType(box->body, CP_BODY_TYPE_DYNAMIC);
+
+    // Back to dynamic recomputes mass from shapes, which carry none
+    cpBodySetMass(box->body, box->lodMass);
+    cpBodySetMoment(box->body, box->lodMoment);
+    cpBodySetVelocity(box->body, cpvzero);
+    cpBodySetAngularVelocity(box->body, 0.0);
+    box->lod = LOD_FULL;
+}
+
+void lodUpdate(LodSystem *lod, World *world, cpVect focus) {
+    const LodConfig *config = &lod->config;
+    bool canSleep = cpSpaceGetSleepTimeThreshold(world->space) != INFINITY;
+    cpFloat sleepSq = config->sleepRadius * config->sleepRadius;
+    cpFloat freezeSq = config->freezeRadius * config->freezeRadius;
+    cpFloat wakeRadius = config->sleepRadius - config->hysteresis;
+    cpFloat thawRadius = config->freezeRadius - config->hysteresis;
+    cpFloat wakeSq = wakeRadius > 0 ? wakeRadius * wakeRadius : 0;
+    cpFloat thawSq = thawRadius > 0 ? thawRadius * thawRadius : 0;
+
+    LodStats stats = {0};
+    for (int i = 0; i < world->boxCount; i++) {
+        Box *box = &world->boxes[i];
+        if (box->body == world->playerBody) {
+            stats.full++;
+            continue;
+        }
+
+        cpFloat distSq = cpvdistsq(cpBodyGetPosition(box->body), focus);
+        bool budget = stats.transitions < config->maxTransitions;
+
+        switch (box->lod) {
+            case LOD_FULL:
+                if (budget && distSq > freezeSq && canFreeze(config, box)) {
+                    freezeBox(box);
+                    stats.transitions++;
+                } else if (budget && canSleep && distSq > sleepSq && atRest(config, box->body) &&
+                           !cpBodyIsSleeping(box->body)) {
+                    cpBodySleep(box->body);
+                    box->lod = LOD_SLEEPING;
+                    stats.transitions++;
+                }
+                break;
+
+            case LOD_SLEEPING:
+                if (!cpBodyIsSleeping(box->body)) {
+                    // Something hit it; it is simulating again anyway
+                    box->lod = LOD_FULL;
+                } else if (distSq < wakeSq) {
+                    cpBodyActivate(box->body);
+                    box->lod = LOD_FULL;
+                    stats.transitions++;
+                } else if (budget && distSq > freezeSq && !bodyHasJoints(box->body)) {
+                    freezeBox(box);
+                    stats.transitions++;
+                }
+                break;
+
+            case LOD_FROZEN:
+                // Thawing is never deferred: the player must not run into a frozen box
+                if (distSq < thawSq) {
+                    thawBox(box);
+                    stats.transitions++;
+                }
+                break;
+        }
+
+        switch (box->lod) {
+            case LOD_FULL: stats.full++; break;
+            case LOD_SLEEPING: stats.sleeping++; break;
+            case LOD_FROZEN: stats.frozen++; break;
+        }
+    }
+    lod->stats = stats;
+}
+
+void lodRestoreAll(LodSystem *lod, World *world) {
+    for (int i = 0; i < world->boxCount; i++) {
+        Box *box = &world->boxes[i];
+        if (box->lod == LOD_FROZEN) {
+            thawBox(box);
+        } else if (box->lod == LOD_SLEEPING) {
+            if (cpBodyIsSleeping(box->body)) {
+                cpBodyActivate(box->body);
+            }
+            box->lod = LOD_FULL;
+        }
+    }
+    LodStats empty = {0};
+    empty.full = world->boxCount;
+    lod->stats = empty;
+}
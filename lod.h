@@ -0,0 +1,46 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <chipmunk/chipmunk.h>
+#include <stdbool.h>
+#include "world.h"
+
+// Radii are measured from the player. Inside `sleepRadius` everything is
+// stepped at full rate; beyond it resting boxes are put to sleep (when the
+// space allows sleeping); beyond `freezeRadius` resting boxes become static.
+// A box only returns to a finer tier once it is `hysteresis` closer again.
+typedef struct {
+    cpFloat sleepRadius;
+    cpFloat freezeRadius;
+    cpFloat hysteresis;
+    cpFloat restSpeed;            // Linear speed below which a box counts as resting
+    cpFloat restAngularSpeed;
+    int maxTransitions;           // Per update, bounds reindexing cost
+} LodConfig;
+
+typedef struct {
+    int full;
+    int sleeping;
+    int frozen;
+    int transitions;              // In the last update
+} LodStats;
+
+typedef struct {
+    LodConfig config;
+    LodStats stats;
+} LodSystem;
+
+// Radii scaled from the window size
+void lodDefaultConfig(LodConfig *config);
+
+void lodInit(LodSystem *lod, const LodConfig *config);
+
+// Move boxes between tiers around `focus`. Only boxes at rest are slowed down
+// and they come back at rest, so transitions never add energy. Must run
+// between steps.
+void lodUpdate(LodSystem *lod, World *world, cpVect focus);
+
+// Return every box to full simulation (e.g. before disabling LOD)
+void lodRestoreAll(LodSystem *lod, World *world);
+
+#endif // LOD_H
@@ -1,7 +1,22 @@
 #include "logging.h"
+#include "recorder.h"
+#include "alloc.h"
+#include <SDL2/SDL.h>
 
 FILE* g_logFile = NULL;
 
+// Counters for the metrics exporter; any thread may log
+static SDL_atomic_t g_lineCounts[LOG_ERROR + 1];
+static SDL_atomic_t g_droppedLines;
+
+unsigned long log_line_count(LogLevel level) {
+    return (level >= LOG_DEBUG && level <= LOG_ERROR) ? (unsigned long)SDL_AtomicGet(&g_lineCounts[level]) : 0;
+}
+
+unsigned long log_dropped_count(void) {
+    return (unsigned long)SDL_AtomicGet(&g_droppedLines);
+}
+
 void log_init(const char* filename) {
     g_logFile = fopen(filename, "w");
     if (g_logFile == NULL) {
@@ -44,7 +59,32 @@ void log_close(void) {
 }
 
 void log_write(LogLevel level, const char* format, ...) {
-    if (g_logFile == NULL) return;
+    const char* levelStr;
+    switch (level) {
+        case LOG_DEBUG:   levelStr = "DEBUG"; break;
+        case LOG_INFO:    levelStr = "INFO "; break;
+        case LOG_WARNING: levelStr = "WARN "; break;
+        case LOG_ERROR:   levelStr = "ERROR"; break;
+        default:          levelStr = "UNKWN"; break;
+    }
+    
+    va_list args;
+    
+    // Keep recent lines in the flight recorder, even without a log file
+    char recent[RECORDER_LOG_LENGTH];
+    va_start(args, format);
+    vsnprintf(recent, sizeof(recent), format, args);
+    va_end(args);
+    recorder_log(levelStr, recent);
+    if (level >= LOG_DEBUG && level <= LOG_ERROR) {
+        SDL_AtomicAdd(&g_lineCounts[level], 1);
+    }
+    
+    if (g_logFile == NULL) {
+        SDL_AtomicAdd(&g_droppedLines, 1);
+        return;
+    }
+    AllocTag tag = allocSetTag(ALLOC_TAG_LOGGING);
     
     // Get timestamp
     time_t rawtime;
@@ -56,25 +96,17 @@ void log_write(LogLevel level, const char* format, ...) {
     strftime(timestamp, sizeof(timestamp), "%H:%M:%S", timeinfo);
     
     // Write level and timestamp
-    const char* levelStr;
-    switch (level) {
-        case LOG_DEBUG:   levelStr = "DEBUG"; break;
-        case LOG_INFO:    levelStr = "INFO "; break;
-        case LOG_WARNING: levelStr = "WARN "; break;
-        case LOG_ERROR:   levelStr = "ERROR"; break;
-        default:          levelStr = "UNKWN"; break;
-    }
-    
     fprintf(g_logFile, "[%s] %s: ", timestamp, levelStr);
     
     // Write the actual message
-    va_list args;
     va_start(args, format);
     vfprintf(g_logFile, format, args);
     va_end(args);
     
     fprintf(g_logFile, "\n");
-    fflush(g_logFile); // Ensure it's written immediately
+    if (fflush(g_logFile) != 0) { // Ensure it's written immediately
+        SDL_AtomicAdd(&g_droppedLines, 1);
+    }
     
     // Also print errors to stderr
     if (level == LOG_ERROR) {
@@ -84,4 +116,5 @@ void log_write(LogLevel level, const char* format, ...) {
         va_end(args);
         fprintf(stderr, "\n");
     }
+    allocSetTag(tag);
 }
\ No newline at end of file
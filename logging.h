@@ -26,6 +26,12 @@ void log_close(void);
 // Write log message
 void log_write(LogLevel level, const char* format, ...);
 
+// Lines logged at `level` since startup, from any thread
+unsigned long log_line_count(LogLevel level);
+
+// Lines that never reached the log file (not open, or the write failed)
+unsigned long log_dropped_count(void);
+
 // Convenience macros
 #define LOG_DEBUG(...) log_write(LOG_DEBUG, __VA_ARGS__)
 #define LOG_INFO(...) log_write(LOG_INFO, __VA_ARGS__)
@@ -1,17 +1,39 @@
 #define _USE_MATH_DEFINES
+#ifndef _WIN32
+#define _DEFAULT_SOURCE  // sigaction, sigaltstack
+#endif
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <chipmunk/chipmunk.h>
+#include "world.h"
+#include "options.h"
+#include "logging.h"
+#include "profiler.h"
+#include "governor.h"
+#include "sprite.h"
+#include "simulation.h"
+#include "render.h"
+#include "recorder.h"
+#include "batch.h"
+#include "golden.h"
+#include "capture.h"
+#include "metrics.h"
+#include "particles.h"
+#include "audio.h"
+#include "alloc.h"
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <signal.h>
 #include <time.h>
 #ifdef __linux__
 #include <execinfo.h>
+#endif
+#ifndef _WIN32
 #include <unistd.h>
-#elif defined(_WIN32)
+#else
 #include <windows.h>
 #include <dbghelp.h>
 #include <imagehlp.h>
@@ -21,35 +43,6 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-#define WINDOW_WIDTH 800
-#define WINDOW_HEIGHT 600
-#define BOX_SIZE 50
-#define GROUND_HEIGHT 50
-#define MAX_BOXES 100
-
-// Player movement constants
-#define PLAYER_MOVE_FORCE 1500.0f
-#define PLAYER_JUMP_IMPULSE 400.0f
-#define MAX_HORIZONTAL_SPEED 250.0f
-
-// Box structure to track multiple boxes
-typedef struct {
-    cpBody *body;
-    cpShape *shape;
-} Box;
-
-// Shape type enumeration for safe debug drawing
-typedef enum {
-    SHAPE_TYPE_SEGMENT,
-    SHAPE_TYPE_POLYGON
-} ShapeType;
-
-// Extended shape structure for debug drawing
-typedef struct {
-    cpShape *shape;
-    ShapeType type;
-} DebugShape;
-
 // Forward declarations for cross-platform error handling
 void show_error_message(const char* title, const char* message);
 void safe_log_write(FILE* file, const char* format, ...);
@@ -336,6 +329,7 @@ void print_windows_stack_trace(FILE *output_file) {
 }
 #endif
 
+#ifdef _WIN32
 // Crash handler function
 void crash_handler(int sig) {
     FILE *crash_file = NULL;
@@ -364,13 +358,7 @@ void crash_handler(int sig) {
              "Application crashed with signal %d (%s).\n\nCrash details saved to crash.log\n\nTime: %s", 
              sig, signal_name, time_str);
     
-#ifdef _WIN32
     show_error_message("Application Crash Detected", alert_msg);
-#else
-    // For Linux/macOS, print to stderr (console available)
-    fprintf(stderr, "\n=== CRASH ALERT ===\n%s\n=== END ALERT ===\n", alert_msg);
-    fflush(stderr);
-#endif
     
     // Write to stderr (for console if available)
     fprintf(stderr, "\n=== CRASH DETECTED ===\n");
@@ -385,31 +373,6 @@ void crash_handler(int sig) {
         safe_log_write(crash_file, "Signal: %d (%s)\n", sig, signal_name);
     }
     
-#ifdef __linux__
-    // Get stack trace (Linux)
-    void *array[10];
-    size_t size;
-    char **strings;
-    size_t i;
-    
-    size = backtrace(array, 10);
-    strings = backtrace_symbols(array, size);
-    
-    fprintf(stderr, "Stack trace (%zd frames):\n", size);
-    fflush(stderr);
-    if (crash_file) {
-        safe_log_write(crash_file, "Stack trace (%zd frames):\n", size);
-    }
-    
-    for (i = 0; i < size; i++) {
-        fprintf(stderr, "  %s\n", strings[i]);
-        if (crash_file) {
-            safe_log_write(crash_file, "  %s\n", strings[i]);
-        }
-    }
-    
-    free(strings);
-#elif defined(_WIN32)
     // Get stack trace (Windows)
     fprintf(stderr, "Stack trace (Windows):\n");
     fflush(stderr);
@@ -418,18 +381,12 @@ void crash_handler(int sig) {
     }
     
     print_windows_stack_trace(crash_file);
-#else
-    // No stack trace available on this platform
-    fprintf(stderr, "Stack trace not available on this platform\n");
-    fflush(stderr);
-    if (crash_file) {
-        safe_log_write(crash_file, "Stack trace not available on this platform\n");
-    }
-#endif
     
     fprintf(stderr, "=== END CRASH INFO ===\n");
     fflush(stderr);
     if (crash_file) {
+        fflush(crash_file);
+        recorder_dump(_fileno(crash_file));
         safe_log_write(crash_file, "=== END CRASH INFO ===\n\n");
         fflush(crash_file);  // Extra safety flush
         fclose(crash_file);
@@ -440,6 +397,83 @@ void crash_handler(int sig) {
     raise(sig);
 }
 
+#else
+static void write_string(int fd, const char *text) {
+    if (fd < 0) return;
+    ssize_t ignored = write(fd, text, strlen(text));
+    (void)ignored;
+}
+
+static void write_unsigned(int fd, unsigned long value) {
+    char digits[24];
+    int count = sizeof(digits);
+    do {
+        digits[--count] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (fd >= 0) {
+        ssize_t ignored = write(fd, digits + count, sizeof(digits) - count);
+        (void)ignored;
+    }
+}
+
+// Crash handler function. Runs on the alternate signal stack and only uses
+// async-signal-safe calls: everything goes out through write(2) to stderr and
+// the crash log descriptor opened at startup.
+void crash_handler(int sig) {
+    const int fds[2] = {STDERR_FILENO, recorder_crash_fd()};
+    const char* signal_name = "Unknown";
+    switch (sig) {
+        case SIGSEGV: signal_name = "Segmentation Fault"; break;
+        case SIGABRT: signal_name = "Abort"; break;
+        case SIGFPE: signal_name = "Floating Point Exception"; break;
+        case SIGILL: signal_name = "Illegal Instruction"; break;
+        case SIGBUS: signal_name = "Bus Error"; break;
+        default: break;
+    }
+    
+    for (int i = 0; i < 2; i++) {
+        write_string(fds[i], "\n=== CRASH DETECTED ===\nTime: ");
+        write_unsigned(fds[i], (unsigned long)time(NULL));
+        write_string(fds[i], " (unix)\nSignal: ");
+        write_unsigned(fds[i], (unsigned long)sig);
+        write_string(fds[i], " (");
+        write_string(fds[i], signal_name);
+        write_string(fds[i], ")\n");
+    }
+    
+#ifdef __linux__
+    // Raw backtrace; backtrace() was warmed up at startup so it does not allocate here
+    void *frames[64];
+    int size = backtrace(frames, 64);
+    for (int i = 0; i < 2; i++) {
+        write_string(fds[i], "Stack trace (");
+        write_unsigned(fds[i], (unsigned long)size);
+        write_string(fds[i], " frames):\n");
+        if (fds[i] >= 0) {
+            backtrace_symbols_fd(frames, size, fds[i]);
+        }
+    }
+#else
+    // No stack trace available on this platform
+    for (int i = 0; i < 2; i++) {
+        write_string(fds[i], "Stack trace not available on this platform\n");
+    }
+#endif
+    
+    // What the game was doing leading up to the crash
+    recorder_dump(fds[1]);
+    write_string(fds[0], "Flight recorder written to crash.log\n");
+    
+    for (int i = 0; i < 2; i++) {
+        write_string(fds[i], "=== END CRASH INFO ===\n\n");
+    }
+    
+    // SA_RESETHAND restored the default action; re-raise to get a core dump
+    raise(sig);
+}
+#endif
+
 // Test crash function for debugging crash handlers
 void test_crash_handlers() {
     FILE *test_file = fopen("crash.log", "a");
@@ -465,18 +499,44 @@ void test_crash_handlers() {
 
 // Setup crash handlers
 void setup_crash_handlers() {
+#ifdef _WIN32
     signal(SIGSEGV, crash_handler);  // Segmentation fault
     signal(SIGABRT, crash_handler);  // Abort
     signal(SIGFPE, crash_handler);   // Floating point exception
     signal(SIGILL, crash_handler);   // Illegal instruction
     
-#ifdef _WIN32
     // Also set up Windows structured exception handling
     SetUnhandledExceptionFilter(windows_exception_handler);
     
     // Additional Windows signal handlers (some crashes may still trigger signals)
     signal(SIGINT, crash_handler);   // Interrupt
     signal(SIGTERM, crash_handler);  // Termination
+#else
+    // Alternate stack so stack overflows can still be reported. It is
+    // per thread; this covers the main thread.
+    static char crash_stack[64 * 1024];
+    stack_t stack;
+    memset(&stack, 0, sizeof(stack));
+    stack.ss_sp = crash_stack;
+    stack.ss_size = sizeof(crash_stack);
+    sigaltstack(&stack, NULL);
+    
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = crash_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+    sigaction(SIGSEGV, &action, NULL);  // Segmentation fault
+    sigaction(SIGABRT, &action, NULL);  // Abort
+    sigaction(SIGFPE, &action, NULL);   // Floating point exception
+    sigaction(SIGILL, &action, NULL);   // Illegal instruction
+    sigaction(SIGBUS, &action, NULL);   // Bus error
+    
+#ifdef __linux__
+    // The first backtrace() loads libgcc, which allocates; do it now rather than in the handler
+    void *warmup[1];
+    backtrace(warmup, 1);
+#endif
 #endif
     
     // Write a test log entry to verify crash logging is working
@@ -505,331 +565,100 @@ void setup_crash_handlers() {
     }
 }
 
-// Sprite frame structure
-typedef struct {
-    int x, y;        // Position in spritesheet
-    int width, height; // Frame dimensions
-} SpriteFrame;
-
-// Animation structure
-typedef struct {
-    SpriteFrame *frames;  // Array of frames
-    int frameCount;      // Number of frames
-    float frameTime;     // Time per frame in seconds
-    bool loop;          // Whether animation loops
-} Animation;
-
-// Sprite structure
-typedef struct {
-    SDL_Texture *texture;     // The spritesheet texture
-    Animation *animations;    // Array of animations
-    int animationCount;      // Number of animations
-    int currentAnimation;    // Current playing animation
-    int currentFrame;        // Current frame in animation
-    float animationTimer;    // Timer for frame changes
-    bool isPlaying;         // Whether animation is playing
-    bool facingLeft;        // Whether sprite should be flipped horizontally
-} Sprite;
-
-// Animation states
-typedef enum {
-    ANIM_IDLE = 0,
-    ANIM_WALK,
-    ANIM_JUMP,
-    ANIM_COUNT
-} AnimationState;
-
-// Convert Chipmunk coordinates to SDL coordinates
-void cpToSDL(cpVect pos, int *x, int *y) {
-    *x = (int)pos.x;
-    *y = WINDOW_HEIGHT - (int)pos.y;
-}
-
-// Convert SDL coordinates to Chipmunk coordinates
-cpVect sdlToCP(int x, int y) {
-    return cpv(x, WINDOW_HEIGHT - y);
-}
-
-// Load character spritesheet from file
-SDL_Texture* loadCharacterSpritesheet(SDL_Renderer *renderer) {
-    SDL_Texture *texture = IMG_LoadTexture(renderer, "./assets/characters.png");
-    if (!texture) {
-        fprintf(stderr, "Failed to load character spritesheet: %s\n", IMG_GetError());
-        return NULL;
-    }
-    return texture;
-}
-
-// Initialize sprite with character spritesheet
-Sprite createCharacterSprite(SDL_Renderer *renderer) {
-    Sprite sprite = {0};
-    
-    // Load character spritesheet
-    sprite.texture = loadCharacterSpritesheet(renderer);
-    if (!sprite.texture) {
-        return sprite;
-    }
-    
-    // Allocate animations
-    sprite.animationCount = ANIM_COUNT;
-    sprite.animations = malloc(sizeof(Animation) * ANIM_COUNT);
-    if (!sprite.animations) {
-        fprintf(stderr, "Failed to allocate memory for animations\n");
-        SDL_DestroyTexture(sprite.texture);
-        sprite.texture = NULL;
-        return sprite;
-    }
-    
-    // Setup idle animation - frame (1,0) = x:0, y:32, 32x32 (swapped x,y)
-    sprite.animations[ANIM_IDLE].frameCount = 1;
-    sprite.animations[ANIM_IDLE].frames = malloc(sizeof(SpriteFrame));
-    sprite.animations[ANIM_IDLE].frames[0] = (SpriteFrame){0, 32, 32, 32};
-    sprite.animations[ANIM_IDLE].frameTime = 1.0f;
-    sprite.animations[ANIM_IDLE].loop = true;
-    
-    // Setup walk animation - frames (1,0), (1,1), (1,2), (1,3) with swapped coordinates
-    sprite.animations[ANIM_WALK].frameCount = 4;
-    sprite.animations[ANIM_WALK].frames = malloc(sizeof(SpriteFrame) * 4);
-    sprite.animations[ANIM_WALK].frames[0] = (SpriteFrame){0, 32, 32, 32};   // (1,0) -> (0,1)
-    sprite.animations[ANIM_WALK].frames[1] = (SpriteFrame){32, 32, 32, 32};  // (1,1) -> (1,1)
-    sprite.animations[ANIM_WALK].frames[2] = (SpriteFrame){64, 32, 32, 32};  // (1,2) -> (2,1)
-    sprite.animations[ANIM_WALK].frames[3] = (SpriteFrame){96, 32, 32, 32};  // (1,3) -> (3,1)
-    sprite.animations[ANIM_WALK].frameTime = 0.15f; // Slightly faster animation
-    sprite.animations[ANIM_WALK].loop = true;
-    
-    // Setup jump animation - use frame (1,0) for now
-    sprite.animations[ANIM_JUMP].frameCount = 1;
-    sprite.animations[ANIM_JUMP].frames = malloc(sizeof(SpriteFrame));
-    sprite.animations[ANIM_JUMP].frames[0] = (SpriteFrame){0, 32, 32, 32};
-    sprite.animations[ANIM_JUMP].frameTime = 1.0f;
-    sprite.animations[ANIM_JUMP].loop = false;
-    
-    // Start with idle animation, facing right
-    sprite.currentAnimation = ANIM_IDLE;
-    sprite.currentFrame = 0;
-    sprite.animationTimer = 0.0f;
-    sprite.isPlaying = true;
-    sprite.facingLeft = false;
-    
-    return sprite;
-}
-
-// Update sprite animation
-void updateSprite(Sprite *sprite, float deltaTime) {
-    if (!sprite->isPlaying || sprite->animationCount == 0) return;
-    
-    Animation *anim = &sprite->animations[sprite->currentAnimation];
-    
-    sprite->animationTimer += deltaTime;
-    
-    if (sprite->animationTimer >= anim->frameTime) {
-        sprite->animationTimer = 0.0f;
-        sprite->currentFrame++;
-        
-        if (sprite->currentFrame >= anim->frameCount) {
-            if (anim->loop) {
-                sprite->currentFrame = 0;
-            } else {
-                sprite->currentFrame = anim->frameCount - 1;
-                sprite->isPlaying = false;
-            }
-        }
-    }
-}
-
-// Set sprite animation
-void setSpriteAnimation(Sprite *sprite, int animation) {
-    if (animation >= 0 && animation < sprite->animationCount && 
-        animation != sprite->currentAnimation) {
-        sprite->currentAnimation = animation;
-        sprite->currentFrame = 0;
-        sprite->animationTimer = 0.0f;
-        sprite->isPlaying = true;
-    }
-}
-
-// Render sprite at given position with optional horizontal flipping
-void renderSprite(SDL_Renderer *renderer, Sprite *sprite, int x, int y) {
-    if (!sprite->texture || sprite->animationCount == 0) {
-        return;
-    }
-    
-    Animation *anim = &sprite->animations[sprite->currentAnimation];
-    if (sprite->currentFrame >= anim->frameCount) {
-        return;
-    }
-    
-    SpriteFrame *frame = &anim->frames[sprite->currentFrame];
-    
-    SDL_Rect srcRect = {
-        frame->x, frame->y,
-        frame->width, frame->height
-    };
-    
-    // Scale sprite to double the physics body size (32x32 -> 100x100)
-    int spriteSize = BOX_SIZE * 2;  // Double the physics body size
-    SDL_Rect dstRect = {
-        x - spriteSize/2,                    // Center horizontally
-        y - spriteSize + BOX_SIZE/2,         // Align physics body with bottom of sprite
-        spriteSize, spriteSize               // Double scale (100x100)
-    };
-    
-    // Use SDL_RenderCopyEx for flipping support
-    SDL_RendererFlip flip = sprite->facingLeft ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE;
-    SDL_RenderCopyEx(renderer, sprite->texture, &srcRect, &dstRect, 0.0, NULL, flip);
-}
-
-// Cleanup sprite resources
-void destroySprite(Sprite *sprite) {
-    if (sprite->texture) {
-        SDL_DestroyTexture(sprite->texture);
-    }
-    
-    for (int i = 0; i < sprite->animationCount; i++) {
-        if (sprite->animations[i].frames) {
-            free(sprite->animations[i].frames);
-        }
-    }
-    
-    if (sprite->animations) {
-        free(sprite->animations);
+// Turn a simulation event into a particle burst sized by its strength
+static void emitEventParticles(ParticleSystem *particles, const SimEvent *event) {
+    float strength = event->strength > 3.0f ? 3.0f : event->strength;
+    float x = (float)event->position.x;
+    float y = (float)event->position.y;
+    switch (event->type) {
+        case SIM_EVENT_IMPACT:
+            particleSystemEmit(particles, PARTICLE_BURST_IMPACT, x, y, strength, (int)(12 * strength));
+            break;
+        case SIM_EVENT_JUMP:
+            particleSystemEmit(particles, PARTICLE_BURST_JUMP, x, y, 1.0f, 16);
+            break;
+        case SIM_EVENT_LANDING:
+            particleSystemEmit(particles, PARTICLE_BURST_LANDING, x, y, strength, 8 + (int)(16 * strength));
+            break;
     }
 }
 
-// Function to create a new box at given position
-Box createBox(cpSpace *space, cpVect position) {
-    cpFloat mass = 1.0f;
-    cpFloat moment = cpMomentForBox(mass, BOX_SIZE, BOX_SIZE);
-    cpBody *body = cpSpaceAddBody(space, cpBodyNew(mass, moment));
-    cpBodySetPosition(body, position);
-    
-    cpShape *shape = cpSpaceAddShape(space, 
-        cpBoxShapeNew(body, BOX_SIZE, BOX_SIZE, 0.0f));
-    cpShapeSetFriction(shape, 0.4f);
-    
-    Box box = {body, shape};
-    return box;
-}
-
-// Check if player is on any surface (ground or other boxes) using collision detection
-bool isOnGround(cpSpace *space, cpBody *body, cpShape *playerShape) {
-    cpVect pos = cpBodyGetPosition(body);
-    cpVect vel = cpBodyGetVelocity(body);
-    
-    // Don't allow jumping if moving upward quickly
-    if (vel.y > 10.0f) {
-        return false;
-    }
-    
-    // Cast a short ray downward from the bottom of the player box
-    cpVect start = cpv(pos.x, pos.y - BOX_SIZE/2);
-    cpVect end = cpv(pos.x, pos.y - BOX_SIZE/2 - 10.0f); // Check 10 pixels below
-    
-    // Create a shape filter that excludes the player's own shape
-    cpShapeFilter filter = {
-        .group = CP_NO_GROUP,
-        .categories = CP_ALL_CATEGORIES,
-        .mask = CP_ALL_CATEGORIES
-    };
-    
-    // Perform ray cast to detect any surface below (excluding player's own shape)
-    cpSegmentQueryInfo info;
-    cpShape *hitShape = cpSpaceSegmentQueryFirst(space, start, end, 0.0f, filter, &info);
-    
-    // Make sure we didn't hit the player's own shape
-    if (hitShape == playerShape) {
-        hitShape = NULL;
+// Play the sound for a simulation event, panned by where it happened on screen
+static void playEventSound(AudioSystem *audio, const SimEvent *event, float cameraX) {
+    float pan = ((float)event->position.x - cameraX) / WINDOW_WIDTH * 2.0f - 1.0f;
+    float strength = event->strength > 3.0f ? 3.0f : event->strength;
+    switch (event->type) {
+        case SIM_EVENT_IMPACT:
+            // Harder hits are louder and slightly lower
+            audioPlay(audio, AUDIO_SOUND_IMPACT, 0.25f + 0.25f * strength, pan, 1.15f - 0.1f * strength);
+            break;
+        case SIM_EVENT_JUMP:
+            audioPlay(audio, AUDIO_SOUND_JUMP, 0.6f, pan, 1.0f);
+            break;
+        case SIM_EVENT_LANDING:
+            audioPlay(audio, AUDIO_SOUND_LANDING, 0.3f + 0.3f * strength, pan, 1.0f);
+            break;
     }
-    
-    // Also check if we're very close to the static ground level
-    bool nearGround = (pos.y <= GROUND_HEIGHT + BOX_SIZE/2 + 5.0f);
-    
-    return (hitShape != NULL) || nearGround;
 }
 
-// Apply player movement forces
-void updatePlayerMovement(cpSpace *space, cpBody *playerBody, cpShape *playerShape, bool left, bool right, bool jump) {
-    cpVect vel = cpBodyGetVelocity(playerBody);
-    cpVect pos = cpBodyGetPosition(playerBody);
-    
-    // Limit rotation to prevent coordinate system flipping
-    cpFloat angVel = cpBodyGetAngularVelocity(playerBody);
-    if (fabs(angVel) > 2.0f) {
-        cpBodySetAngularVelocity(playerBody, angVel * 0.5f); // Dampen rotation
+int main(int argc, char* argv[]) {
+    GameOptions options;
+    if (!parseOptions(argc, argv, &options)) {
+        return 1;
     }
     
-    // Keep player mostly upright
-    cpFloat angle = cpBodyGetAngle(playerBody);
-    if (fabs(angle) > M_PI/6) { // If rotated more than 30 degrees
-        cpBodySetAngle(playerBody, angle * 0.9f); // Gradually return to upright
-    }
+    // Setup crash handlers and the flight recorder they dump
+    recorder_init("crash.log");
+    setup_crash_handlers();
+    log_init("platformer.log");
     
-    // Horizontal movement - use WORLD coordinates, not local
-    if (left && vel.x > -MAX_HORIZONTAL_SPEED) {
-        cpBodyApplyForceAtWorldPoint(playerBody, cpv(-PLAYER_MOVE_FORCE, 0), pos);
+    // Headless solver sweep: no window needed
+    if (options.sweep) {
+        runScenarioSweep(options.scenario, options.seed, stdout);
+        log_close();
+        return 0;
     }
-    if (right && vel.x < MAX_HORIZONTAL_SPEED) {
-        cpBodyApplyForceAtWorldPoint(playerBody, cpv(PLAYER_MOVE_FORCE, 0), pos);
+    if (options.benchLayers) {
+        runLayerBenchmark(options.seed, stdout);
+        log_close();
+        return 0;
     }
-    
-    // Apply horizontal damping for better control
-    if (!left && !right) {
-        cpFloat damping = 0.8f;
-        cpBodySetVelocity(playerBody, cpv(vel.x * damping, vel.y));
+    if (options.batchWorlds > 0) {
+        BatchConfig batch = {
+            options.batchWorlds, options.batchSteps, options.batchMode, options.jobWorkers,
+            options.scenario, options.scenarioCount, options.seed, options.inputPath
+        };
+        bool ok = runBatch(&batch, stdout);
+        log_close();
+        return ok ? 0 : 1;
     }
-    
-    // Jumping - use WORLD coordinates
-    if (jump && isOnGround(space, playerBody, playerShape)) {
-        cpBodyApplyImpulseAtWorldPoint(playerBody, cpv(0, PLAYER_JUMP_IMPULSE), pos);
+    if (options.goldenPath) {
+        GoldenConfig golden = {options.goldenPath, options.writeGolden, options.jobWorkers};
+        bool ok = runGoldenRender(&golden, stdout);
+        log_close();
+        return ok ? 0 : 1;
     }
-}
-
-// Safe function to draw debug physics outlines using bounding boxes
-void drawDebugShape(SDL_Renderer *renderer, cpShape *shape, ShapeType type) {
-    cpBody *body = cpShapeGetBody(shape);
-    cpBB bb = cpShapeGetBB(shape);
-    
-    // Convert bounding box to SDL coordinates
-    int x1, y1, x2, y2;
-    cpToSDL(cpv(bb.l, bb.b), &x1, &y1);
-    cpToSDL(cpv(bb.r, bb.t), &x2, &y2);
-    
-    // Set color based on body type
-    if (cpBodyGetType(body) == CP_BODY_TYPE_DYNAMIC) {
-        SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // Yellow for dynamic
-    } else {
-        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green for static
+    if (options.benchJobs) {
+        runJobsBenchmark(options.scenarioCount > 0 ? options.scenarioCount : 100000, stdout);
+        log_close();
+        return 0;
     }
     
-    // Draw bounding box
-    SDL_Rect rect = {x1, y2, x2 - x1, y1 - y2};
-    SDL_RenderDrawRect(renderer, &rect);
-    
-    // For polygon shapes, try to draw the actual vertices safely
-    if (type == SHAPE_TYPE_POLYGON) {
-        int count = cpPolyShapeGetCount(shape);
-        if (count > 0 && count <= 10) { // Safety check
-            SDL_Point points[count + 1];
-            
-            for (int i = 0; i < count; i++) {
-                cpVect v = cpBodyLocalToWorld(body, cpPolyShapeGetVert(shape, i));
-                cpToSDL(v, &points[i].x, &points[i].y);
-            }
-            // Close the polygon
-            points[count] = points[0];
-            
-            SDL_RenderDrawLines(renderer, points, count + 1);
+    // A rollback session ticks once per frame at the fixed net rate, and
+    // nothing outside the peers' inputs may change solver settings
+    if (options.netPort) {
+        options.pacing = PACING_TARGET_FPS;
+        options.targetFps = 1.0 / NET_TICK_DT;
+        options.governor = false;
+        options.simThread = false;
+        if (options.levelPath || options.lod || options.scenario != SCENARIO_NONE) {
+            fprintf(stderr, "Ignoring --level, --lod and --scenario in a rollback session\n");
+            options.levelPath = NULL;
+            options.lod = false;
+            options.scenario = SCENARIO_NONE;
         }
     }
-}
 
-int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
-    
-    // Setup crash handlers
-    setup_crash_handlers();
-    
     // Log application start
     FILE *log_file = fopen("crash.log", "a");
     if (log_file) {
@@ -873,58 +702,91 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Create renderer
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    // Create renderer, with vsync when the pacing mode asks for it
+    FramePacer pacer;
+    pacerInit(&pacer, options.pacing, options.targetFps);
+    // In dirty-rect mode the window surface is the persistent framebuffer
+    // and a software renderer draws straight into it
+    SDL_Renderer *renderer = NULL;
+    if (options.dirtyRects) {
+        SDL_Surface *windowSurface = SDL_GetWindowSurface(window);
+        renderer = windowSurface ? SDL_CreateSoftwareRenderer(windowSurface) : NULL;
+    } else {
+        renderer = SDL_CreateRenderer(window, -1, pacerRendererFlags(&pacer));
+    }
     if (!renderer) {
         fprintf(stderr, "Renderer creation failed: %s\n", SDL_GetError());
         SDL_DestroyWindow(window);
         SDL_Quit();
         return 1;
     }
+    pacerCheckRenderer(&pacer, renderer);
 
-    // Create Chipmunk space
-    cpSpace *space = cpSpaceNew();
-    if (!space) {
-        fprintf(stderr, "Failed to create Chipmunk space\n");
+    // Create the simulation: Chipmunk space, ground, box storage, player and governor
+    Simulation sim;
+    if (!simulationInit(&sim, MAX_BOXES, options.frameBudgetMs, options.governor)) {
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
         return 1;
     }
-    cpSpaceSetGravity(space, cpv(0, -980));
-
-    // Create static ground body
-    cpBody *groundBody = cpSpaceGetStaticBody(space);
-    cpShape *ground = cpSegmentShapeNew(groundBody, 
-        cpv(0, GROUND_HEIGHT), 
-        cpv(WINDOW_WIDTH, GROUND_HEIGHT), 
-        0.0f);
-    cpShapeSetFriction(ground, 0.3f);
-    cpSpaceAddShape(space, ground);
-
-    // Initialize box array
-    Box boxes[MAX_BOXES];
-    int boxCount = 0;
+    sim.linkCount = options.links;
+    
+    // Two-player rollback session over UDP
+    if (options.netPort) {
+        NetConfig netConfig = {
+            options.netPlayer, options.netPort, options.netPeer,
+            options.netLatencyMs, options.netLossPercent, options.netBot, options.seed
+        };
+        if (!simulationEnableNet(&sim, &netConfig)) {
+            simulationDestroy(&sim);
+            SDL_DestroyRenderer(renderer);
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            return 1;
+        }
+    }
+    
+    // Stream the level around the player instead of the single-screen ground
+    if (options.levelPath &&
+        !simulationEnableStreaming(&sim, options.levelPath, options.levelChunks, options.seed)) {
+        fprintf(stderr, "Failed to start level streaming, using the fixed level\n");
+    }
+    
+    // Simulation level of detail for far-away bodies
+    if (options.lod) {
+        LodConfig lodConfig;
+        lodDefaultConfig(&lodConfig);
+        if (options.lodRadius > 0.0) {
+            lodConfig.freezeRadius = options.lodRadius;
+            lodConfig.sleepRadius = options.lodRadius * 0.6;
+            lodConfig.hysteresis = options.lodRadius * 0.1;
+        }
+        simulationSetLod(&sim, &lodConfig);
+    }
     
     // Debug visualization toggle
     bool showDebug = false;
+    bool showHeatmap = false;
     
     // Player input state
     bool leftPressed = false;
     bool rightPressed = false;
     bool jumpPressed = false;
     
-    // Create initial box (player)
-    boxes[boxCount] = createBox(space, cpv(WINDOW_WIDTH / 2, WINDOW_HEIGHT - 50));
-    cpBody *playerBody = boxes[0].body;
-    cpShape *playerShape = boxes[0].shape;
-    boxCount++;
+    // Load the requested stress scenario around the player
+    if (options.scenario != SCENARIO_NONE) {
+        int spawned = spawnScenario(&sim.world, options.scenario, options.scenarioCount, options.seed);
+        printf("Loaded scenario %s with %d boxes\n", scenarioName(options.scenario), spawned);
+    }
     
-    // Create player sprite
+    // Create player sprite; the simulation advances its animation
     Sprite playerSprite = createCharacterSprite(renderer);
     if (!playerSprite.texture) {
         fprintf(stderr, "Failed to load player sprite\n");
         // Continue without sprite
+    } else {
+        sim.playerSprite = &playerSprite;
     }
 
     // Setup input
@@ -933,17 +795,119 @@ int main(int argc, char* argv[]) {
     SDL_StartTextInput();
     SDL_PumpEvents();
     
+    // Worker threads and vertex buffer for batched box drawing
+    JobSystem jobs;
+    BoxBatch boxBatch;
+    if (!jobSystemInit(&jobs, options.jobWorkers) || !boxBatchInit(&boxBatch, MAX_BOXES, sim.world.maxJoints)) {
+        jobSystemDestroy(&jobs);
+        simulationDestroy(&sim);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 1;
+    }
+    
+    // Visual-only particles, fed by simulation events and never stepped with physics
+    ParticleSystem particles;
+    bool showParticles = options.particles && particleSystemInit(&particles, PARTICLE_CAPACITY);
+    
+    // Sound effects; mixing happens on SDL's audio thread
+    AudioSystem audio;
+    bool playAudio = options.audio && audioInit(&audio);
+    
+    // Instrumentation
+    profiler_init();
+    
+    // Optional metrics endpoint for soak runs; scrapes read a snapshot published per frame
+    MetricsServer metrics;
+    bool serveMetrics = (options.metricsPort || options.metricsSocket) &&
+                        metricsInit(&metrics, options.metricsPort, options.metricsSocket);
+    if ((options.metricsPort || options.metricsSocket) && !serveMetrics) {
+        fprintf(stderr, "Failed to start the metrics endpoint\n");
+    }
+    
+    // Optional per-step physics statistics stream
+    FILE *statsFile = NULL;
+    if (options.statsPath) {
+        statsFile = strcmp(options.statsPath, "-") == 0 ? stdout : fopen(options.statsPath, "w");
+        if (!statsFile) {
+            fprintf(stderr, "Failed to open stats file: %s\n", options.statsPath);
+        }
+        simulationSetStatsStream(&sim, statsFile, options.statsFormat);
+    }
+    
+    // Optional held-input recording for replay in batch mode
+    FILE *inputFile = NULL;
+    if (options.recordInputPath) {
+        inputFile = fopen(options.recordInputPath, "w");
+        if (!inputFile) {
+            fprintf(stderr, "Failed to open input recording: %s\n", options.recordInputPath);
+        }
+        simulationSetInputRecording(&sim, inputFile);
+    }
+    
+    // Built-in recording; the encoder runs on its own thread and drops frames it can't keep up with
+    Capture capture;
+    bool capturing = options.capturePath &&
+                     captureInit(&capture, renderer, options.captureFormat, options.capturePath, options.targetFps);
+    if (options.capturePath && !capturing) {
+        fprintf(stderr, "Failed to start capture to %s\n", options.capturePath);
+    }
+    
+    // Redraw only what changed; everything else stays in the window surface
+    DirtyRedraw dirty;
+    bool dirtyRects = options.dirtyRects;
+    if (dirtyRects) {
+        // Large enough for every box, every rope segment or every particle
+        int vertexCapacity = (MAX_BOXES > sim.world.maxJoints ? MAX_BOXES : sim.world.maxJoints) * 4;
+        if (PARTICLE_CAPACITY * 3 > vertexCapacity) {
+            vertexCapacity = PARTICLE_CAPACITY * 3;
+        }
+        if (!dirtyRedrawInit(&dirty, WINDOW_WIDTH, WINDOW_HEIGHT, vertexCapacity)) {
+            fprintf(stderr, "Falling back to full redraws\n");
+            dirtyRects = false;
+        }
+    }
+    
+    // Scene resolution that gives way when the renderer can't keep up
+    DynamicResolution resolution = {0};
+    if (options.dynamicResolution && dirtyRects) {
+        fprintf(stderr, "--dynamic-res is ignored with --dirty-rects\n");
+    } else if (options.dynamicResolution) {
+        resolutionInit(&resolution, renderer, options.frameBudgetMs,
+                       options.resolutionMinScale, options.resolutionFilter);
+    }
+    
+    // Publish the initial state so the first frame has something to draw
+    simulationPublish(&sim);
+    if (options.simThread) {
+        if (!simulationStartThread(&sim, options.tickRate)) {
+            fprintf(stderr, "Falling back to stepping physics on the main thread\n");
+        }
+    }
+    bool threaded = sim.thread != NULL;
+    
+    // Everything above is startup; strict mode checks frames once they settle
+    allocSetStrict(options.allocStrict);
+    
     // Main loop
     bool running = true;
+    float cameraX = 0.0f;      // From the last drawn snapshot, for mouse spawning
     SDL_Event event;
-    Uint32 lastTime = SDL_GetTicks();
+    Uint64 lastTime = SDL_GetPerformanceCounter();
+    Uint64 frameStart = profiler_begin();
     int frameCount = 0;
     
     while (running) {
         frameCount++;
+        if (options.frames > 0 && frameCount > options.frames) {
+            break;
+        }
+        profiler_end(PROFILE_FRAME, frameStart);
+        frameStart = profiler_begin();
         
-        Uint32 currentTime = SDL_GetTicks();
-        cpFloat dt = (currentTime - lastTime) / 1000.0f;
+        Uint64 currentTime = SDL_GetPerformanceCounter();
+        cpFloat dt = (cpFloat)(currentTime - lastTime) / SDL_GetPerformanceFrequency();
         
         // Handle first frame case where dt would be 0
         if (dt <= 0.0f) {
@@ -962,29 +926,84 @@ int main(int argc, char* argv[]) {
             jumpPressed = (keystate[SDL_SCANCODE_W] || keystate[SDL_SCANCODE_UP] || keystate[SDL_SCANCODE_SPACE]) ? true : false;
         }
         
-        // Handle events
+        // Handle events; anything that touches the world goes through the input queue
+        allocSetTag(ALLOC_TAG_PLATFORM);
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
+            } else if (event.type == SDL_WINDOWEVENT) {
+                // The screen may have lost what we didn't redraw
+                if (dirtyRects && (event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                                   event.window.event == SDL_WINDOWEVENT_RESTORED)) {
+                    damageInvalidate(&dirty.damage);
+                }
             } else if (event.type == SDL_MOUSEBUTTONDOWN) {
-                if (event.button.button == SDL_BUTTON_LEFT && boxCount < MAX_BOXES) {
+                if (event.button.button == SDL_BUTTON_LEFT) {
                     if (event.button.x >= 0 && event.button.x < WINDOW_WIDTH && 
                         event.button.y >= 0 && event.button.y < WINDOW_HEIGHT) {
                         cpVect mousePos = sdlToCP(event.button.x, event.button.y);
-                        boxes[boxCount] = createBox(space, mousePos);
-                        boxCount++;
+                        mousePos.x += cameraX;
+                        simulationPushCommand(&sim, SIM_COMMAND_SPAWN_BOX, mousePos);
                     }
+                } else if (event.button.button == SDL_BUTTON_RIGHT) {
+                    cpVect mousePos = sdlToCP(event.button.x, event.button.y);
+                    mousePos.x += cameraX;
+                    simulationPushCommand(&sim, SIM_COMMAND_EXPLOSION, mousePos);
                 }
             } else if (event.type == SDL_KEYDOWN) {
                 switch (event.key.keysym.sym) {
                     case SDLK_F1:
                         showDebug = !showDebug;
+                        simulationSetDebugDraw(&sim, showDebug);
                         printf("Debug visualization: %s\n", showDebug ? "ON" : "OFF");
                         break;
+                    case SDLK_F3:
+                        showHeatmap = !showHeatmap;
+                        printf("Contact heatmap: %s\n", showHeatmap ? "ON" : "OFF");
+                        break;
                     case SDLK_F9:
                         // Test crash handlers (F9 key)
                         test_crash_handlers();
                         break;
+                    case SDLK_r:
+                        if (!event.key.repeat) {
+                            simulationPushCommand(&sim, SIM_COMMAND_TOGGLE_RAIN, cpvzero);
+                            printf("Box rain toggled\n");
+                        }
+                        break;
+                    case SDLK_g:
+                        if (!event.key.repeat) {
+                            simulationPushCommand(&sim, SIM_COMMAND_TOGGLE_WIND, cpvzero);
+                            printf("Wind toggled\n");
+                        }
+                        break;
+                    case SDLK_m:
+                        if (!event.key.repeat) {
+                            int mouseX, mouseY;
+                            SDL_GetMouseState(&mouseX, &mouseY);
+                            cpVect position = sdlToCP(mouseX, mouseY);
+                            position.x += cameraX;
+                            simulationPushCommand(&sim, SIM_COMMAND_TOGGLE_MAGNET, position);
+                            printf("Magnet toggled\n");
+                        }
+                        break;
+                    case SDLK_1:
+                    case SDLK_2:
+                    case SDLK_3:
+                    case SDLK_4:
+                        if (!event.key.repeat) {
+                            // Anchored at the mouse: rope, chain, bridge, swing
+                            static const SimCommandType linkages[] = {
+                                SIM_COMMAND_SPAWN_ROPE, SIM_COMMAND_SPAWN_CHAIN,
+                                SIM_COMMAND_SPAWN_BRIDGE, SIM_COMMAND_SPAWN_SWING
+                            };
+                            int mouseX, mouseY;
+                            SDL_GetMouseState(&mouseX, &mouseY);
+                            cpVect anchor = sdlToCP(mouseX, mouseY);
+                            anchor.x += cameraX;
+                            simulationPushCommand(&sim, linkages[event.key.keysym.sym - SDLK_1], anchor);
+                        }
+                        break;
                     case SDLK_a:
                     case SDLK_LEFT:
                         leftPressed = true;
@@ -1018,129 +1037,235 @@ int main(int argc, char* argv[]) {
             }
         }
         
-        // Update player movement
-        updatePlayerMovement(space, playerBody, playerShape, leftPressed, rightPressed, jumpPressed);
+        int heldInput = (leftPressed ? INPUT_LEFT : 0) |
+                        (rightPressed ? INPUT_RIGHT : 0) |
+                        (jumpPressed ? INPUT_JUMP : 0);
+        simulationSetHeldInput(&sim, heldInput);
         
-        // Update player sprite animation based on movement state
-        if (playerSprite.texture) {
-            cpVect vel = cpBodyGetVelocity(playerBody);
-            bool onGround = isOnGround(space, playerBody, playerShape);
-            
-            // Update sprite direction based on velocity
-            if (vel.x < -5.0f) {
-                playerSprite.facingLeft = true;
-            } else if (vel.x > 5.0f) {
-                playerSprite.facingLeft = false;
+        // Without the simulation thread, tick inline once per frame
+        if (!threaded) {
+            allocSetTag(ALLOC_TAG_PHYSICS);
+            simulationTick(&sim, dt);
+            simulationPublish(&sim);
+        }
+        
+        // Draw the latest snapshot; never touches the physics space
+        bool fresh = false;
+        const RenderSnapshot *snap = snapshotAcquire(&sim.snapshots, &fresh);
+        cameraX = snap->cameraX;
+        if (fresh) {
+            profiler_record(PROFILE_STEP, snap->stepMs);
+        }
+        
+        allocSetTag(ALLOC_TAG_RENDER);
+        
+        // Drain events even with particles off, so the queue never backs up
+        Uint64 particleStart = profiler_begin();
+        SimEvent simEvent;
+        while (simulationPopEvent(&sim, &simEvent)) {
+            if (showParticles) {
+                emitEventParticles(&particles, &simEvent);
             }
-            
-            // Update animation based on state
-            if (!onGround) {
-                setSpriteAnimation(&playerSprite, ANIM_JUMP);
-            } else if (fabs(vel.x) > 10.0f) {
-                setSpriteAnimation(&playerSprite, ANIM_WALK);
-            } else {
-                setSpriteAnimation(&playerSprite, ANIM_IDLE);
+            if (playAudio) {
+                playEventSound(&audio, &simEvent, snap->cameraX);
             }
-            
-            // Update sprite animation timer
-            updateSprite(&playerSprite, dt);
         }
-        
-        // Update physics
-        if (dt > 0.033f) {
-            dt = 0.033f; // Clamp to reasonable value
+        if (showParticles) {
+            particleSystemUpdate(&particles, (float)dt);
+            particleSystemBuild(&particles, snap->cameraX);
         }
+        double particleMs = (double)(profiler_begin() - particleStart) * 1000.0 / SDL_GetPerformanceFrequency();
         
-        cpSpaceStep(space, dt);
-
-        // Clear screen
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-
-        // Draw ground
-        SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-        SDL_Rect groundRect = {
-            0, 
-            WINDOW_HEIGHT - GROUND_HEIGHT, 
-            WINDOW_WIDTH, 
-            GROUND_HEIGHT
-        };
-        SDL_RenderFillRect(renderer, &groundRect);
+        Uint64 renderStart = profiler_begin();
+        int overlays = (showDebug ? RENDER_OVERLAY_DEBUG : 0) | (showHeatmap ? RENDER_OVERLAY_HEATMAP : 0);
+        int dirtyRectCount = 0;
+        if (dirtyRects) {
+            dirtyRectCount = renderSnapshotDirty(renderer, &playerSprite, &boxBatch, &jobs, snap,
+                                                 showParticles ? &particles : NULL, &dirty, overlays);
+        } else {
+            renderSnapshot(renderer, &playerSprite, &boxBatch, &jobs, snap,
+                           showParticles ? &particles : NULL,
+                           resolution.enabled ? &resolution : NULL, overlays);
+        }
+        if (capturing) {
+            captureFrame(&capture, renderer, (unsigned long)frameCount);
+        }
 
-        // Draw all boxes
-        for (int i = 0; i < boxCount; i++) {
-            cpVect pos = cpBodyGetPosition(boxes[i].body);
-            cpFloat angle = cpBodyGetAngle(boxes[i].body);
-            
-            int x, y;
-            cpToSDL(pos, &x, &y);
-            
-            if (i == 0) {
-                // Draw player as animated sprite
-                if (playerSprite.texture) {
-                    renderSprite(renderer, &playerSprite, x, y);
-                } else {
-                    // Fallback to rectangle if sprite failed to load
-                    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-                    SDL_Rect boxRect = {
-                        x - BOX_SIZE/2,
-                        y - BOX_SIZE/2,
-                        BOX_SIZE,
-                        BOX_SIZE
-                    };
-                    SDL_RenderFillRect(renderer, &boxRect);
-                }
-            } else {
-                // Draw other boxes as rectangles
-                SDL_SetRenderDrawColor(renderer, 255, 100, 100, 255);
-                
-                // Simple rotation rendering (for visual feedback)
-                if (fabs(angle) > 0.01) {
-                    SDL_SetRenderDrawColor(renderer, 200, 50, 50, 255);
-                }
-                
-                SDL_Rect boxRect = {
-                    x - BOX_SIZE/2,
-                    y - BOX_SIZE/2,
-                    BOX_SIZE,
-                    BOX_SIZE
-                };
-                
-                SDL_RenderFillRect(renderer, &boxRect);
+        // Present. With vsync the present blocks until the next refresh,
+        // so that part is pacing wait rather than render cost.
+        double renderMs = 0.0;
+        double presentWaitMs = 0.0;
+        if (pacer.mode == PACING_VSYNC) {
+            renderMs = profiler_end(PROFILE_RENDER, renderStart);
+            Uint64 presentStart = profiler_begin();
+            SDL_RenderPresent(renderer);
+            presentWaitMs = (double)(profiler_begin() - presentStart) * 1000.0 / SDL_GetPerformanceFrequency();
+        } else if (options.dirtyRects) {
+            // Push only the redrawn rects from the window surface to the screen
+            SDL_RenderFlush(renderer);
+            if (!dirtyRects) {
+                SDL_UpdateWindowSurface(window);
+            } else if (dirtyRectCount > 0) {
+                SDL_UpdateWindowSurfaceRects(window, dirty.damage.rects, dirtyRectCount);
             }
+            renderMs = profiler_end(PROFILE_RENDER, renderStart);
+        } else {
+            SDL_RenderPresent(renderer);
+            renderMs = profiler_end(PROFILE_RENDER, renderStart);
         }
         
-        // Draw debug visualization if enabled
-        if (showDebug) {
-            // Draw ground debug outline
-            drawDebugShape(renderer, ground, SHAPE_TYPE_SEGMENT);
-            
-            // Draw all box debug outlines
-            for (int i = 0; i < boxCount; i++) {
-                drawDebugShape(renderer, boxes[i].shape, SHAPE_TYPE_POLYGON);
-            }
+        // Let the governor trade solver quality for time under load. The
+        // simulation thread governs itself on step cost alone.
+        allocSetTag(ALLOC_TAG_OTHER);
+        if (!threaded && governorUpdate(&sim.governor, snap->stepMs, renderMs)) {
+            governorApply(&sim.governor, sim.world.space);
+        }
+        resolutionUpdate(&resolution, renderMs);
+        profiler_set_gauge(GAUGE_RENDER_SCALE, resolution.enabled ? resolution.scale : 1.0);
+        profiler_set_gauge(GAUGE_DIRTY_RECTS, dirtyRectCount);
+        profiler_set_gauge(GAUGE_REDRAW_FRACTION, dirtyRects ? dirty.damage.redrawFraction : 1.0);
+        profiler_set_gauge(GAUGE_BODIES, snap->boxCount + (snap->hasPlayer ? 1 : 0));
+        profiler_set_gauge(GAUGE_QUALITY_LEVEL, snap->qualityLevel);
+        profiler_set_gauge(GAUGE_ITERATIONS, snap->iterations);
+        profiler_set_gauge(GAUGE_SUBSTEPS, snap->substeps);
+        profiler_set_gauge(GAUGE_SLEEP_THRESHOLD, snap->sleepThreshold);
+        profiler_set_gauge(GAUGE_PACING_ERROR, pacer.avgAbsErrorMs);
+        profiler_set_gauge(GAUGE_POOL_LIVE, snap->poolLive);
+        profiler_set_gauge(GAUGE_POOL_HIGH_WATER, snap->poolHighWater);
+        profiler_set_gauge(GAUGE_POOL_RECYCLED, (double)snap->poolReleased);
+        profiler_set_gauge(GAUGE_POOL_EXHAUSTED, (double)snap->poolExhausted);
+        profiler_set_gauge(GAUGE_ACTIVE_BODIES, snap->physics.activeBodies);
+        profiler_set_gauge(GAUGE_SLEEPING_BODIES, snap->physics.sleepingBodies);
+        profiler_set_gauge(GAUGE_BROADPHASE_PAIRS, snap->physics.broadphasePairs);
+        profiler_set_gauge(GAUGE_ARBITERS, snap->physics.arbiters);
+        profiler_set_gauge(GAUGE_CONTACTS, snap->physics.contacts);
+        profiler_set_gauge(GAUGE_CONSTRAINTS, snap->physics.constraints);
+        profiler_set_gauge(GAUGE_LOD_SLEEPING, snap->lod.sleeping);
+        profiler_set_gauge(GAUGE_LOD_FROZEN, snap->lod.frozen);
+        profiler_set_gauge(GAUGE_PARTICLES, showParticles ? particles.count : 0);
+        profiler_set_gauge(GAUGE_PARTICLE_MS, particleMs);
+        profiler_set_gauge(GAUGE_EFFECTS, snap->effects.effects);
+        profiler_set_gauge(GAUGE_EFFECT_BODIES, snap->effects.bodies);
+        profiler_set_gauge(GAUGE_EFFECT_MS, snap->effectMs);
+        
+        // Heap traffic of this frame, from every thread
+        AllocFrameStats allocStats;
+        allocFrameEnd(&allocStats);
+        profiler_set_gauge(GAUGE_ALLOCS_PER_FRAME, allocStats.allocations);
+        profiler_set_gauge(GAUGE_ALLOC_BYTES_PER_FRAME, allocStats.bytes);
+        profiler_set_gauge(GAUGE_HEAP_LIVE, allocStats.liveBytes);
+        profiler_set_gauge(GAUGE_HEAP_HIGH_WATER, allocStats.highWater);
+        if (capturing) {
+            CaptureStats captureInfo = captureStats(&capture);
+            profiler_set_gauge(GAUGE_CAPTURE_MS, captureInfo.lastMs);
+            profiler_set_gauge(GAUGE_CAPTURE_DROPPED, (double)captureInfo.dropped);
         }
+        if (playAudio) {
+            AudioStats audioInfo = audioStats(&audio);
+            profiler_set_gauge(GAUGE_AUDIO_CALLBACK_US, audioInfo.lastCallbackUs);
+            profiler_set_gauge(GAUGE_AUDIO_VOICES, audioInfo.activeVoices);
+            profiler_set_gauge(GAUGE_AUDIO_LIMITED, (double)audioInfo.rateLimited);
+        }
+        if (snap->hasNet) {
+            profiler_set_gauge(GAUGE_ROLLBACK_TICKS, snap->net.lastRollbackTicks);
+            profiler_set_gauge(GAUGE_ROLLBACK_MS, snap->net.lastRollbackMs);
+        }
+        
+        if (serveMetrics) {
+            metricsPublish(&metrics, profiler_stat(PROFILE_FRAME)->lastMs, snap->stepMs, fresh);
+        }
+        
+        // Refresh the title bar HUD once per profiler report
+        allocSetTag(ALLOC_TAG_PLATFORM);
+        if (profiler_frame_end()) {
+            char title[320];
+            char hud[256];
+            profiler_format_hud(hud, sizeof(hud));
+            snprintf(title, sizeof(title), "Chipmunk2D Box Collision Demo | %s", hud);
+            SDL_SetWindowTitle(window, title);
+        }
+        allocSetTag(ALLOC_TAG_OTHER);
+
+        // Pace the frame (vsync already blocked in present if enabled)
+        double waitMs = presentWaitMs + pacerWait(&pacer);
+        profiler_record(PROFILE_WAIT, waitMs);
+        
+        // Keep the last few hundred frames for the crash handler
+        FrameRecord record = {
+            (Uint32)frameCount,
+            SDL_GetTicks(),
+            snap->tick,
+            (float)((double)(SDL_GetPerformanceCounter() - frameStart) * 1000.0 / SDL_GetPerformanceFrequency()),
+            (float)snap->stepMs,
+            (float)renderMs,
+            (float)waitMs,
+            snap->boxCount + (snap->hasPlayer ? 1 : 0),
+            snap->qualityLevel,
+            heldInput
+        };
+        recorder_frame(&record);
+    }
+
+    // Stop the simulation thread before reading the world from here
+    simulationStopThread(&sim);
 
-        // Present
-        SDL_RenderPresent(renderer);
+    LOG_INFO("Pacing (%s): avg |error| %.3f ms, max |error| %.3f ms, %d missed deadlines",
+             pacingModeName(pacer.mode), pacer.avgAbsErrorMs, pacer.maxAbsErrorMs, pacer.missedDeadlines);
 
-        // Cap framerate
-        SDL_Delay(16); // ~60 FPS
+    LOG_INFO("Box pool: capacity %d, high water %d, %lu spawned, %lu recycled, %lu refused (pool full)",
+             sim.world.pool.capacity, sim.world.pool.highWater, sim.world.pool.acquired,
+             sim.world.pool.released, sim.world.pool.exhausted);
+    allocReport();
+    if (sim.net) {
+        // Machine-readable summary for scripts driving both peers
+        const NetStats *net = &sim.net->stats;
+        printf("net player %d: %lu ticks, %lu rollbacks, max rollback %d ticks %.3f ms, %lu stalls, desyncs %lu\n",
+               options.netPlayer, net->ticks, net->rollbacks, net->maxRollbackTicks,
+               net->maxRollbackMs, net->stalls, net->desyncs);
+    }
+
+    if (playAudio) {
+        AudioStats audioInfo = audioStats(&audio);
+        printf("audio: %lu callbacks, avg %.1f us, max %.1f us, buffer %.0f us, %lu sounds, "
+               "%lu stolen, %lu rate limited, %lu queue full\n",
+               audioInfo.callbacks, audioInfo.avgCallbackUs, audioInfo.maxCallbackUs, audioInfo.bufferUs,
+               audioInfo.started, audioInfo.stolen, audioInfo.rateLimited, audioInfo.queueFull);
     }
 
     // Cleanup
-    destroySprite(&playerSprite);
-    for (int i = 0; i < boxCount; i++) {
-        cpShapeFree(boxes[i].shape);
-        cpBodyFree(boxes[i].body);
+    if (playAudio) {
+        audioDestroy(&audio);
+    }
+    if (capturing) {
+        captureDestroy(&capture);
     }
-    cpShapeFree(ground);
-    cpSpaceFree(space);
+    if (serveMetrics) {
+        metricsDestroy(&metrics);
+    }
+    if (showParticles) {
+        particleSystemDestroy(&particles);
+    }
+    resolutionDestroy(&resolution);
+    if (dirtyRects) {
+        dirtyRedrawDestroy(&dirty);
+    }
+    boxBatchDestroy(&boxBatch);
+    jobSystemDestroy(&jobs);
+    simulationDestroy(&sim);
+    if (statsFile && statsFile != stdout) {
+        fclose(statsFile);
+    }
+    if (inputFile) {
+        fclose(inputFile);
+    }
+    destroySprite(&playerSprite);
     
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     IMG_Quit();
     SDL_Quit();
+    log_close();
+    recorder_close();
     
     // Log normal application exit
     log_file = fopen("crash.log", "a");
@@ -1157,4 +1282,4 @@ int main(int argc, char* argv[]) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,354 @@
+#ifndef _WIN32
+#define _DEFAULT_SOURCE  // MSG_NOSIGNAL, select
+#endif
+#include "metrics.h"
+#include "alloc.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#define METRICS_FRESH 4             // Set in `latest` when it has not been acquired yet
+#define METRICS_INDEX_MASK 3
+#define METRICS_POLL_MS 200         // How often the server thread checks for shutdown
+
+#ifdef MSG_NOSIGNAL
+#define METRICS_SEND_FLAGS MSG_NOSIGNAL  // A scraper hanging up must not raise SIGPIPE
+#else
+#define METRICS_SEND_FLAGS 0
+#endif
+
+// Upper bounds in ms; the last bucket is +Inf
+static const double bucketBounds[METRICS_BUCKETS - 1] = {1, 2, 4, 8, 16.7, 33.3, 50, 100, 250};
+
+static const char *levelNames[LOG_ERROR + 1] = {"debug", "info", "warning", "error"};
+
+static void closeSocket(int sock) {
+#ifdef _WIN32
+    closesocket((SOCKET)sock);
+#else
+    close(sock);
+#endif
+}
+
+// ---- Formatting ----
+
+static void append(char *buffer, int size, int *length, const char *format, ...) {
+    if (*length >= size - 1) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + *length, size - *length, format, args);
+    va_end(args);
+    if (written > 0) {
+        *length += written < size - *length ? written : size - 1 - *length;
+    }
+}
+
+static void appendHistogram(char *buffer, int size, int *length, const char *name,
+                            const char *help, const MetricsHistogram *histogram) {
+    append(buffer, size, length, "# HELP platformer_%s %s\n# TYPE platformer_%s histogram\n", name, help, name);
+    for (int i = 0; i < METRICS_BUCKETS - 1; i++) {
+        append(buffer, size, length, "platformer_%s_bucket{le=\"%g\"} %lu\n", name, bucketBounds[i], histogram->counts[i]);
+    }
+    append(buffer, size, length, "platformer_%s_bucket{le=\"+Inf\"} %lu\n", name, histogram->counts[METRICS_BUCKETS - 1]);
+    append(buffer, size, length, "platformer_%s_sum %.6f\nplatformer_%s_count %lu\n", name, histogram->sum, name, histogram->count);
+}
+
+int metricsFormat(const MetricsSnapshot *snapshot, char *buffer, int size) {
+    int length = 0;
+    buffer[0] = '\0';
+
+    append(buffer, size, &length, "# HELP platformer_frames_total Frames run since startup.\n"
+                                  "# TYPE platformer_frames_total counter\nplatformer_frames_total %lu\n",
+           snapshot->frames);
+    append(buffer, size, &length, "# TYPE platformer_uptime_seconds gauge\nplatformer_uptime_seconds %.3f\n",
+           snapshot->uptimeSeconds);
+
+    append(buffer, size, &length, "# HELP platformer_section_ms Frame section time: last sample, "
+                                  "moving average and worst since the last report.\n"
+                                  "# TYPE platformer_section_ms gauge\n");
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        const ProfileStat *stat = &snapshot->sections[i];
+        const char *name = profiler_section_name((ProfileSection)i);
+        append(buffer, size, &length, "platformer_section_ms{section=\"%s\",stat=\"last\"} %.6f\n", name, stat->lastMs);
+        append(buffer, size, &length, "platformer_section_ms{section=\"%s\",stat=\"avg\"} %.6f\n", name, stat->avgMs);
+        append(buffer, size, &length, "platformer_section_ms{section=\"%s\",stat=\"max\"} %.6f\n", name, stat->maxMs);
+    }
+
+    for (int i = 0; i < GAUGE_COUNT; i++) {
+        const char *name = profiler_gauge_name((ProfileGauge)i);
+        append(buffer, size, &length, "# TYPE platformer_%s gauge\nplatformer_%s %.6g\n", name, name, snapshot->gauges[i]);
+    }
+
+    appendHistogram(buffer, size, &length, "frame_time_ms", "Whole frame time.", &snapshot->frameTime);
+    appendHistogram(buffer, size, &length, "step_time_ms", "Physics step time per simulation tick.", &snapshot->stepTime);
+
+    append(buffer, size, &length, "# HELP platformer_log_lines_total Lines logged by level.\n"
+                                  "# TYPE platformer_log_lines_total counter\n");
+    for (int i = 0; i <= LOG_ERROR; i++) {
+        append(buffer, size, &length, "platformer_log_lines_total{level=\"%s\"} %lu\n", levelNames[i], snapshot->logLines[i]);
+    }
+    append(buffer, size, &length, "# HELP platformer_log_dropped_total Lines that never reached the log file.\n"
+                                  "# TYPE platformer_log_dropped_total counter\nplatformer_log_dropped_total %lu\n",
+           snapshot->logDropped);
+    return length;
+}
+
+// ---- Main loop side ----
+
+static void observe(MetricsHistogram *histogram, double ms) {
+    for (int i = 0; i < METRICS_BUCKETS; i++) {
+        if (i == METRICS_BUCKETS - 1 || ms <= bucketBounds[i]) {
+            histogram->counts[i]++;
+        }
+    }
+    histogram->count++;
+    histogram->sum += ms;
+}
+
+void metricsPublish(MetricsServer *metrics, double frameMs, double stepMs, bool stepped) {
+    metrics->frames++;
+    observe(&metrics->frameTime, frameMs);
+    if (stepped) {
+        observe(&metrics->stepTime, stepMs);
+    }
+
+    MetricsSnapshot *snapshot = &metrics->buffers[metrics->writeIndex];
+    snapshot->frames = metrics->frames;
+    snapshot->uptimeSeconds = (double)(SDL_GetPerformanceCounter() - metrics->startCounter) / SDL_GetPerformanceFrequency();
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        snapshot->sections[i] = *profiler_stat((ProfileSection)i);
+    }
+    for (int i = 0; i < GAUGE_COUNT; i++) {
+        snapshot->gauges[i] = profiler_gauge((ProfileGauge)i);
+    }
+    snapshot->frameTime = metrics->frameTime;
+    snapshot->stepTime = metrics->stepTime;
+    for (int i = 0; i <= LOG_ERROR; i++) {
+        snapshot->logLines[i] = log_line_count((LogLevel)i);
+    }
+    snapshot->logDropped = log_dropped_count();
+
+    // Swap the written buffer into `latest` and take whatever was there to write next
+    int previous = SDL_AtomicSet(&metrics->latest, metrics->writeIndex | METRICS_FRESH);
+    metrics->writeIndex = previous & METRICS_INDEX_MASK;
+}
+
+// ---- Server thread ----
+
+static const MetricsSnapshot *acquireSnapshot(MetricsServer *metrics) {
+    if (SDL_AtomicGet(&metrics->latest) & METRICS_FRESH) {
+        int latest = SDL_AtomicSet(&metrics->latest, metrics->readIndex);
+        metrics->readIndex = latest & METRICS_INDEX_MASK;
+    }
+    return &metrics->buffers[metrics->readIndex];
+}
+
+static void sendAll(int sock, const char *data, int length) {
+    while (length > 0) {
+        int sent = (int)send(sock, data, length, METRICS_SEND_FLAGS);
+        if (sent <= 0) {
+            return;
+        }
+        data += sent;
+        length -= sent;
+    }
+}
+
+// Any request gets the metrics page; Prometheus only ever asks for one thing
+static void serveClient(MetricsServer *metrics, int client) {
+#ifdef _WIN32
+    DWORD timeout = METRICS_POLL_MS;
+#else
+    struct timeval timeout = {0, METRICS_POLL_MS * 1000};
+#endif
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+
+    char request[1024];
+    int received = 0;
+    while (received < (int)sizeof(request) - 1) {
+        int n = (int)recv(client, request + received, sizeof(request) - 1 - received, 0);
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+        request[received] = '\0';
+        if (strstr(request, "\r\n\r\n")) {
+            break;
+        }
+    }
+
+    int length = metricsFormat(acquireSnapshot(metrics), metrics->page, METRICS_PAGE_SIZE);
+    char header[160];
+    int headerLength = snprintf(header, sizeof(header),
+                                "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                "Content-Length: %d\r\nConnection: close\r\n\r\n", length);
+    sendAll(client, header, headerLength);
+    sendAll(client, metrics->page, length);
+    SDL_AtomicAdd(&metrics->scrapes, 1);
+}
+
+static int metricsThread(void *data) {
+    MetricsServer *metrics = data;
+    allocSetTag(ALLOC_TAG_PLATFORM);
+
+    while (SDL_AtomicGet(&metrics->running)) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(metrics->listener, &readable);
+        struct timeval timeout = {0, METRICS_POLL_MS * 1000};
+        if (select(metrics->listener + 1, &readable, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+        int client = (int)accept(metrics->listener, NULL, NULL);
+        if (client < 0) {
+            continue;
+        }
+        serveClient(metrics, client);
+        closeSocket(client);
+    }
+    return 0;
+}
+
+// ---- Setup ----
+
+static int listenTcp(int port) {
+    int sock = (int)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return -1;
+    }
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+
+    // Localhost only: the endpoint has no authentication
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((unsigned short)port);
+    if (bind(sock, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(sock, 4) != 0) {
+        closeSocket(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static int listenUnix(const char *path) {
+#ifdef _WIN32
+    (void)path;
+    LOG_ERROR("Unix domain sockets are not supported on Windows; use a port");
+    return -1;
+#else
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        LOG_ERROR("Metrics socket path too long: %s", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    unlink(path);  // Left behind by a previous run
+    if (bind(sock, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(sock, 4) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+#endif
+}
+
+bool metricsInit(MetricsServer *metrics, int port, const char *socketPath) {
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->listener = -1;
+    metrics->startCounter = SDL_GetPerformanceCounter();
+    metrics->writeIndex = 0;
+    SDL_AtomicSet(&metrics->latest, 1);
+    metrics->readIndex = 2;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        LOG_ERROR("WSAStartup failed");
+        return false;
+    }
+#endif
+
+    metrics->page = allocMalloc(ALLOC_TAG_PLATFORM, METRICS_PAGE_SIZE);
+    if (!metrics->page) {
+        metricsDestroy(metrics);
+        return false;
+    }
+
+    if (socketPath) {
+        metrics->listener = listenUnix(socketPath);
+        snprintf(metrics->socketPath, sizeof(metrics->socketPath), "%s", socketPath);
+    } else {
+        metrics->listener = listenTcp(port);
+    }
+    if (metrics->listener < 0) {
+        if (socketPath) {
+            LOG_ERROR("Failed to listen for metrics on %s", socketPath);
+        } else {
+            LOG_ERROR("Failed to listen for metrics on 127.0.0.1:%d", port);
+        }
+        metrics->socketPath[0] = '\0';
+        metricsDestroy(metrics);
+        return false;
+    }
+
+    SDL_AtomicSet(&metrics->running, 1);
+    metrics->thread = SDL_CreateThread(metricsThread, "metrics", metrics);
+    if (!metrics->thread) {
+        LOG_ERROR("Failed to create metrics thread: %s", SDL_GetError());
+        metricsDestroy(metrics);
+        return false;
+    }
+
+    if (socketPath) {
+        LOG_INFO("Serving metrics on unix:%s", socketPath);
+    } else {
+        LOG_INFO("Serving metrics on http://127.0.0.1:%d/metrics", port);
+    }
+    return true;
+}
+
+void metricsDestroy(MetricsServer *metrics) {
+    if (metrics->thread) {
+        SDL_AtomicSet(&metrics->running, 0);
+        SDL_WaitThread(metrics->thread, NULL);
+        metrics->thread = NULL;
+        LOG_INFO("Metrics: %d scrapes served", SDL_AtomicGet(&metrics->scrapes));
+    }
+    if (metrics->listener >= 0) {
+        closeSocket(metrics->listener);
+        metrics->listener = -1;
+#ifndef _WIN32
+        if (metrics->socketPath[0]) {
+            unlink(metrics->socketPath);
+        }
+#endif
+    }
+    allocFree(ALLOC_TAG_PLATFORM, metrics->page);
+    metrics->page = NULL;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
@@ -0,0 +1,67 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include "profiler.h"
+#include "logging.h"
+
+#define METRICS_BUCKETS 10          // Histogram buckets, the last one is +Inf
+#define METRICS_PAGE_SIZE 16384     // Rendered exposition text
+
+// Cumulative histogram of millisecond samples, in Prometheus form
+typedef struct {
+    unsigned long counts[METRICS_BUCKETS];  // Samples <= each bound, cumulative
+    unsigned long count;
+    double sum;
+} MetricsHistogram;
+
+// Everything one scrape reports, copied from the main loop once per frame
+typedef struct {
+    unsigned long frames;
+    double uptimeSeconds;
+    ProfileStat sections[PROFILE_SECTION_COUNT];
+    double gauges[GAUGE_COUNT];
+    MetricsHistogram frameTime;
+    MetricsHistogram stepTime;
+    unsigned long logLines[LOG_ERROR + 1];
+    unsigned long logDropped;
+} MetricsSnapshot;
+
+// Serves the latest snapshot in Prometheus text format over HTTP, on
+// localhost TCP or a Unix domain socket. The main loop publishes through a
+// lock-free triple buffer, so a slow or stuck scraper never blocks a frame.
+typedef struct {
+    int listener;
+    char socketPath[108];           // Unix socket to remove on shutdown, empty for TCP
+    Uint64 startCounter;
+
+    // Histograms accumulate on the main loop and are copied into each snapshot
+    MetricsHistogram frameTime;
+    MetricsHistogram stepTime;
+    unsigned long frames;
+
+    MetricsSnapshot buffers[3];
+    SDL_atomic_t latest;            // Index of the latest published buffer, plus METRICS_FRESH
+    int writeIndex;                 // Owned by the main loop
+    int readIndex;                  // Owned by the server thread
+
+    SDL_Thread *thread;
+    SDL_atomic_t running;
+    char *page;                     // METRICS_PAGE_SIZE, rendered by the server thread
+    SDL_atomic_t scrapes;
+} MetricsServer;
+
+// Listen on 127.0.0.1:`port`, or on the Unix socket `socketPath` when it is
+// not NULL, and start the server thread
+bool metricsInit(MetricsServer *metrics, int port, const char *socketPath);
+void metricsDestroy(MetricsServer *metrics);
+
+// Main loop: add this frame's samples and publish the profiler's current
+// sections and gauges. Never blocks.
+void metricsPublish(MetricsServer *metrics, double frameMs, double stepMs, bool stepped);
+
+// Prometheus text for `snapshot`. Returns the length written.
+int metricsFormat(const MetricsSnapshot *snapshot, char *buffer, int size);
+
+#endif // METRICS_H
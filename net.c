@@ -0,0 +1,610 @@
+#ifndef _WIN32
+#define _DEFAULT_SOURCE  // getaddrinfo
+#endif
+#include "net.h"
+#include "simulation.h"
+#include "alloc.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define NET_MAGIC 0x42524c50u       // "PLRB"
+#define NET_VERSION 1
+#define NET_HEADER_SIZE 24
+
+// ---- Sockets ----
+
+static void closeSocket(int sock) {
+#ifdef _WIN32
+    closesocket((SOCKET)sock);
+#else
+    close(sock);
+#endif
+}
+
+static bool openSocket(NetSession *net, const char *host, int peerPort) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        LOG_ERROR("WSAStartup failed");
+        return false;
+    }
+#endif
+    int sock = (int)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        LOG_ERROR("Failed to create UDP socket");
+        return false;
+    }
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons((unsigned short)net->config.localPort);
+    if (bind(sock, (struct sockaddr *)&local, sizeof(local)) != 0) {
+        LOG_ERROR("Failed to bind UDP port %d", net->config.localPort);
+        closeSocket(sock);
+        return false;
+    }
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket((SOCKET)sock, FIONBIO, &nonBlocking);
+#else
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    struct addrinfo hints, *result = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    char port[16];
+    snprintf(port, sizeof(port), "%d", peerPort);
+    if (getaddrinfo(host, port, &hints, &result) != 0 || !result ||
+        result->ai_addrlen > sizeof(net->peerAddress)) {
+        LOG_ERROR("Failed to resolve peer %s:%d", host, peerPort);
+        if (result) freeaddrinfo(result);
+        closeSocket(sock);
+        return false;
+    }
+    memcpy(net->peerAddress, result->ai_addr, result->ai_addrlen);
+    net->peerAddressLength = (int)result->ai_addrlen;
+    freeaddrinfo(result);
+
+    net->socket = sock;
+    return true;
+}
+
+bool netParsePeer(const char *text, char *host, int hostSize, int *port) {
+    const char *colon = strrchr(text, ':');
+    if (!colon || colon == text || colon - text >= hostSize) {
+        return false;
+    }
+    memcpy(host, text, colon - text);
+    host[colon - text] = '\0';
+    *port = atoi(colon + 1);
+    return *port > 0 && *port < 65536;
+}
+
+// ---- Packets ----
+// Header: magic, version, player, input count, first input tick, ack, checksum tick, checksum.
+// Followed by one byte of held InputBits per tick.
+
+static void putU32(unsigned char *p, Uint32 v) {
+    p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16); p[3] = (unsigned char)(v >> 24);
+}
+
+static Uint32 getU32(const unsigned char *p) {
+    return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+static void sendNow(NetSession *net, const unsigned char *data, int size) {
+    sendto(net->socket, (const char *)data, size, 0,
+           (const struct sockaddr *)net->peerAddress, net->peerAddressLength);
+    net->stats.packetsSent++;
+}
+
+static unsigned int nextRandom(unsigned int *state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7fff;
+}
+
+// Loss and latency shim in front of sendto
+static void queuePacket(NetSession *net, const unsigned char *data, int size) {
+    if (net->config.lossPercent > 0.0 &&
+        nextRandom(&net->lossState) % 10000 < (unsigned int)(net->config.lossPercent * 100.0)) {
+        net->stats.packetsDropped++;
+        return;
+    }
+    if (net->config.latencyMs <= 0 || net->delayedCount == NET_DELAY_QUEUE) {
+        sendNow(net, data, size);
+        return;
+    }
+    NetDelayedPacket *packet = &net->delayed[net->delayedCount++];
+    packet->dueMs = SDL_GetTicks() + (Uint32)net->config.latencyMs;
+    packet->size = size;
+    memcpy(packet->data, data, size);
+}
+
+static void flushDelayed(NetSession *net) {
+    Uint32 now = SDL_GetTicks();
+    int kept = 0;
+    for (int i = 0; i < net->delayedCount; i++) {
+        NetDelayedPacket *packet = &net->delayed[i];
+        if (SDL_TICKS_PASSED(now, packet->dueMs)) {
+            sendNow(net, packet->data, packet->size);
+        } else {
+            net->delayed[kept++] = *packet;
+        }
+    }
+    net->delayedCount = kept;
+}
+
+static NetInput *inputAt(NetSession *net, int player, unsigned long tick) {
+    return &net->inputs[player][tick & (NET_HISTORY - 1)];
+}
+
+static int localInputFor(NetSession *net, unsigned long tick) {
+    NetInput *input = inputAt(net, net->config.localPlayer, tick);
+    return (input->valid && input->tick == tick) ? input->held : 0;
+}
+
+// Latest state both peers have simulated from confirmed inputs
+static const NetSavedState *latestFinalState(NetSession *net) {
+    for (unsigned long i = 0; i < NET_HISTORY && i <= net->tick; i++) {
+        const NetSavedState *state = &net->states[(net->tick - i) & (NET_HISTORY - 1)];
+        if (state->valid && state->final && state->tick == net->tick - i) {
+            return state;
+        }
+    }
+    return NULL;
+}
+
+// Resend every input the peer hasn't acknowledged; redundancy covers loss
+static void sendInputs(NetSession *net) {
+    unsigned long newest = net->tick + NET_INPUT_DELAY - 1;  // Latest input sampled so far
+    unsigned long first = net->peerAck;
+    if (first + NET_HISTORY / 2 <= newest) {
+        first = newest - NET_HISTORY / 2 + 1;
+    }
+    int count = first <= newest ? (int)(newest - first + 1) : 0;  // Still sent for the ack
+    if (count > NET_PACKET_MAX - NET_HEADER_SIZE) {
+        count = NET_PACKET_MAX - NET_HEADER_SIZE;
+    }
+
+    unsigned char packet[NET_PACKET_MAX];
+    const NetSavedState *final = latestFinalState(net);
+    putU32(packet, NET_MAGIC);
+    packet[4] = NET_VERSION;
+    packet[5] = (unsigned char)net->config.localPlayer;
+    packet[6] = (unsigned char)count;
+    packet[7] = 0;
+    putU32(packet + 8, (Uint32)first);
+    putU32(packet + 12, (Uint32)net->remoteConfirmed);
+    putU32(packet + 16, final ? (Uint32)final->tick : 0);
+    putU32(packet + 20, final ? final->checksum : 0);
+    for (int i = 0; i < count; i++) {
+        packet[NET_HEADER_SIZE + i] = (unsigned char)localInputFor(net, first + i);
+    }
+    queuePacket(net, packet, NET_HEADER_SIZE + count);
+}
+
+// Returns the earliest tick whose prediction turned out wrong, or ULONG_MAX if none was
+static unsigned long receiveInputs(NetSession *net) {
+    unsigned long rollbackFrom = ULONG_MAX;
+    int remote = 1 - net->config.localPlayer;
+    unsigned char packet[NET_PACKET_MAX];
+
+    while (true) {
+        int size = (int)recv(net->socket, (char *)packet, sizeof(packet), 0);
+        if (size < NET_HEADER_SIZE || getU32(packet) != NET_MAGIC || packet[4] != NET_VERSION) {
+            if (size < 0) break;
+            continue;
+        }
+        if (packet[5] != remote) {
+            LOG_WARNING("Peer claims to be player %d too", packet[5]);
+            continue;
+        }
+        net->stats.packetsReceived++;
+        if (!net->connected) {
+            LOG_INFO("Peer connected");
+            net->connected = true;
+        }
+
+        int count = packet[6];
+        if (size < NET_HEADER_SIZE + count) {
+            continue;
+        }
+        unsigned long first = getU32(packet + 8);
+        unsigned long ack = getU32(packet + 12);
+        if (ack > net->peerAck) {
+            net->peerAck = ack;
+        }
+
+        // Accept inputs in order only, so everything before remoteConfirmed is known
+        for (int i = 0; i < count; i++) {
+            unsigned long tick = first + i;
+            if (tick != net->remoteConfirmed) {
+                continue;
+            }
+            int held = packet[NET_HEADER_SIZE + i];
+            NetInput *input = inputAt(net, remote, tick);
+            input->tick = tick;
+            input->held = held;
+            input->valid = true;
+            net->remoteConfirmed++;
+
+            if (tick < net->tick && net->usedRemote[tick & (NET_HISTORY - 1)] != held &&
+                tick < rollbackFrom) {
+                rollbackFrom = tick;
+            }
+
+            // A correct prediction makes the following state final without re-simulating it
+            NetSavedState *next = &net->states[(tick + 1) & (NET_HISTORY - 1)];
+            if (rollbackFrom == ULONG_MAX && next->valid && next->tick == tick + 1) {
+                next->final = true;
+            }
+        }
+
+        // Compare our state against the peer's for the same confirmed tick
+        unsigned long checkTick = getU32(packet + 16);
+        Uint32 checksum = getU32(packet + 20);
+        const NetSavedState *state = &net->states[checkTick & (NET_HISTORY - 1)];
+        if (checkTick > net->lastCheckedTick && state->valid && state->final && state->tick == checkTick) {
+            net->lastCheckedTick = checkTick;
+            if (state->checksum != checksum) {
+                if (net->stats.desyncs == 0) {
+                    LOG_ERROR("Desync at tick %lu", checkTick);
+                }
+                net->stats.desyncs++;
+            }
+        }
+    }
+    return rollbackFrom;
+}
+
+// ---- Save, restore and simulation ----
+
+static Uint32 hashBytes(Uint32 hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Re-adding the shapes gives both peers identical contact caches and broadphase
+// trees whatever their history. It drops every arbiter, so it only happens at
+// canonical ticks, every NET_CANONICAL_TICKS; in between contacts warm-start as
+// usual, and the same inputs from the same canonical state step identically.
+static bool isCanonicalTick(unsigned long tick) {
+    return tick % NET_CANONICAL_TICKS == 0;
+}
+
+static void saveState(NetSession *net, unsigned long tick) {
+    World *world = net->world;
+    NetSavedState *state = &net->states[tick & (NET_HISTORY - 1)];
+    for (int i = 0; i < world->boxCount; i++) {
+        cpBodySetForce(world->boxes[i].body, cpvzero);
+        cpBodySetTorque(world->boxes[i].body, 0.0);
+    }
+    if (isCanonicalTick(tick)) {
+        worldReaddBoxShapes(world, net->shapeIdBase);
+    }
+
+    state->tick = tick;
+    state->valid = true;
+    state->final = tick <= net->remoteConfirmed;
+    state->count = world->boxCount < NET_MAX_BODIES ? world->boxCount : NET_MAX_BODIES;
+    state->checksum = 2166136261u;
+    for (int i = 0; i < state->count; i++) {
+        cpBody *body = world->boxes[i].body;
+        NetBodyState *b = &state->bodies[i];
+        b->p = cpBodyGetPosition(body);
+        b->v = cpBodyGetVelocity(body);
+        b->a = cpBodyGetAngle(body);
+        b->w = cpBodyGetAngularVelocity(body);
+        state->checksum = hashBytes(state->checksum, b, sizeof(*b));
+    }
+}
+
+// Only canonical ticks can be restored: elsewhere the space's cached contacts
+// aren't part of the saved state. Re-simulating `tick` saves it again, which
+// re-adds the shapes just as both peers did the first time.
+static bool restoreState(NetSession *net, unsigned long tick) {
+    World *world = net->world;
+    const NetSavedState *state = &net->states[tick & (NET_HISTORY - 1)];
+    if (!isCanonicalTick(tick) || !state->valid || state->tick != tick || state->count != world->boxCount) {
+        return false;
+    }
+    for (int i = 0; i < state->count; i++) {
+        cpBody *body = world->boxes[i].body;
+        const NetBodyState *b = &state->bodies[i];
+        cpBodySetPosition(body, b->p);
+        cpBodySetVelocity(body, b->v);
+        cpBodySetAngle(body, b->a);
+        cpBodySetAngularVelocity(body, b->w);
+    }
+    return true;
+}
+
+// Save the state at the start of `tick`, then apply both players' inputs and step
+static void simulateTick(NetSession *net, unsigned long tick) {
+    int remote = 1 - net->config.localPlayer;
+    saveState(net, tick);
+
+    int held[NET_PLAYERS];
+    held[net->config.localPlayer] = localInputFor(net, tick);
+    if (tick < net->remoteConfirmed) {
+        held[remote] = inputAt(net, remote, tick)->held;
+    } else if (net->remoteConfirmed > 0) {
+        held[remote] = inputAt(net, remote, net->remoteConfirmed - 1)->held;  // Predict: repeat last
+    } else {
+        held[remote] = 0;
+    }
+    net->usedRemote[tick & (NET_HISTORY - 1)] = held[remote];
+
+    // Same order on both peers
+    for (int p = 0; p < NET_PLAYERS; p++) {
+        updatePlayerMovement(net->world->space, net->players[p],
+                             held[p] & INPUT_LEFT, held[p] & INPUT_RIGHT, held[p] & INPUT_JUMP);
+    }
+    cpSpaceStep(net->world->space, NET_TICK_DT);
+}
+
+void netSessionUpdate(NetSession *net, int localHeld) {
+    flushDelayed(net);
+    unsigned long rollbackFrom = receiveInputs(net);
+
+    // Re-simulate with the corrected inputs from the last canonical tick at or
+    // before the first mispredicted one; ticks in between replay unchanged
+    if (rollbackFrom < net->tick) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        rollbackFrom -= rollbackFrom % NET_CANONICAL_TICKS;
+        int ticks = (int)(net->tick - rollbackFrom);
+        if (restoreState(net, rollbackFrom)) {
+            for (unsigned long t = rollbackFrom; t < net->tick; t++) {
+                simulateTick(net, t);
+            }
+            double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+            net->stats.rollbacks++;
+            net->stats.resimulatedTicks += ticks;
+            net->stats.lastRollbackTicks = ticks;
+            net->stats.lastRollbackMs = ms;
+            net->stats.totalRollbackMs += ms;
+            if (ticks > net->stats.maxRollbackTicks) net->stats.maxRollbackTicks = ticks;
+            if (ms > net->stats.maxRollbackMs) net->stats.maxRollbackMs = ms;
+        } else {
+            LOG_ERROR("No saved state for tick %lu, cannot roll back", rollbackFrom);
+        }
+    } else {
+        net->stats.lastRollbackTicks = 0;
+        net->stats.lastRollbackMs = 0.0;
+    }
+
+    // Advance one tick unless we would get too far ahead of the peer
+    if (net->connected && net->tick < net->remoteConfirmed + NET_MAX_ROLLBACK) {
+        unsigned long inputTick = net->tick + NET_INPUT_DELAY;
+        if (net->config.bot) {
+            localHeld = inputScriptHeld(&net->botScript, inputTick, &net->botCursor);
+        }
+        NetInput *input = inputAt(net, net->config.localPlayer, inputTick);
+        input->tick = inputTick;
+        input->held = localHeld;
+        input->valid = true;
+
+        simulateTick(net, net->tick);
+        net->tick++;
+        net->stats.ticks++;
+    } else {
+        net->stats.stalls++;
+    }
+
+    sendInputs(net);
+}
+
+// ---- Setup ----
+
+static void addWall(NetSession *net, int index, cpFloat x) {
+    cpBody *staticBody = cpSpaceGetStaticBody(net->world->space);
+    cpShape *wall = cpSegmentShapeNew(staticBody, cpv(x, 0), cpv(x, WINDOW_HEIGHT * 2), 0.0);
+    cpShapeSetFriction(wall, 0.3f);
+    cpShapeSetFilter(wall, net->world->filters[LAYER_STATIC]);
+    net->walls[index] = cpSpaceAddShape(net->world->space, wall);
+}
+
+bool netSessionInit(NetSession *net, World *world, const NetConfig *config) {
+    memset(net, 0, sizeof(*net));
+    net->config = *config;
+    net->world = world;
+    net->socket = -1;
+    net->lossState = config->seed * 2654435761u + (unsigned int)config->localPlayer;
+
+    char host[128];
+    int peerPort;
+    if (!netParsePeer(config->peer, host, sizeof(host), &peerPort)) {
+        LOG_ERROR("Bad peer address %s, expected host:port", config->peer);
+        return false;
+    }
+    net->states = allocCalloc(ALLOC_TAG_OTHER, NET_HISTORY, sizeof(NetSavedState));
+    if (!net->states || !openSocket(net, host, peerPort)) {
+        netSessionDestroy(net);
+        return false;
+    }
+    if (config->bot && !inputScriptGenerate(&net->botScript, config->seed + 17 * (config->localPlayer + 1), 1 << 20)) {
+        netSessionDestroy(net);
+        return false;
+    }
+
+    // Player 0 is the box spawnPlayer made, player 1 is spawned next, on both peers
+    if (!world->playerBody || world->boxCount != 1) {
+        LOG_ERROR("Rollback session needs a world with only the player in it");
+        netSessionDestroy(net);
+        return false;
+    }
+    net->players[0] = world->playerBody;
+    cpBodySetPosition(net->players[0], cpv(WINDOW_WIDTH / 3, WINDOW_HEIGHT - 50));
+    Box *second = spawnBoxOnLayer(world, cpv(WINDOW_WIDTH * 2 / 3, WINDOW_HEIGHT - 50),
+                                  BOX_SIZE, BOX_SIZE, LAYER_PLAYER);
+    if (!second) {
+        netSessionDestroy(net);
+        return false;
+    }
+    net->players[1] = second->body;
+    world->playerBody = net->players[config->localPlayer];
+    world->playerShape = world->boxes[config->localPlayer].shape;
+
+    // Keep both players on screen
+    addWall(net, 0, 0);
+    addWall(net, 1, WINDOW_WIDTH);
+    net->shapeIdBase = worldNextShapeId(world);
+
+    // Idle timers aren't part of the saved state, so nothing may fall asleep
+    cpSpaceSetSleepTimeThreshold(world->space, INFINITY);
+
+    LOG_INFO("Rollback session: player %d on port %d, peer %s, latency %d ms, loss %.1f%%",
+             config->localPlayer, config->localPort, config->peer, config->latencyMs, config->lossPercent);
+    return true;
+}
+
+void netSessionDestroy(NetSession *net) {
+    if (net->socket >= 0) {
+        closeSocket(net->socket);
+        net->socket = -1;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+    for (int i = 0; i < 2; i++) {
+        if (net->walls[i]) {
+            cpSpaceRemoveShape(net->world->space, net->walls[i]);
+            cpShapeFree(net->walls[i]);
+            net->walls[i] = NULL;
+        }
+    }
+    inputScriptFree(&net->botScript);
+    allocFree(ALLOC_TAG_OTHER, net->states);
+    net->states = NULL;
+
+    if (net->stats.ticks > 0) {
+        LOG_INFO("Rollback: %lu ticks, %lu rollbacks (%lu ticks re-simulated, max %d), "
+                 "rollback avg %.3f ms max %.3f ms, %lu stalls, %lu desyncs",
+                 net->stats.ticks, net->stats.rollbacks, net->stats.resimulatedTicks,
+                 net->stats.maxRollbackTicks,
+                 net->stats.rollbacks ? net->stats.totalRollbackMs / net->stats.rollbacks : 0.0,
+                 net->stats.maxRollbackMs, net->stats.stalls, net->stats.desyncs);
+    }
+}
+
+// A session on `world` with no socket, every state final and no prediction
+static bool benchSessionInit(NetSession *net, World *world) {
+    memset(net, 0, sizeof(*net));
+    net->world = world;
+    net->socket = -1;
+    net->states = allocCalloc(ALLOC_TAG_OTHER, NET_HISTORY, sizeof(NetSavedState));
+    if (!net->states || !world->playerBody) {
+        allocFree(ALLOC_TAG_OTHER, net->states);
+        return false;
+    }
+    net->players[0] = net->players[1] = world->playerBody;
+    net->shapeIdBase = worldNextShapeId(world);
+    net->remoteConfirmed = ULONG_MAX / 2;
+    return true;
+}
+
+double netBenchmarkRollback(World *world, int ticks, int repeats) {
+    NetSession net;
+    if (!benchSessionInit(&net, world)) {
+        return -1.0;
+    }
+    // Start on a canonical tick so the rollback covers exactly `ticks`
+    unsigned long from = NET_CANONICAL_TICKS;
+    for (net.tick = 0; net.tick < from + ticks; net.tick++) {
+        simulateTick(&net, net.tick);
+    }
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < repeats; r++) {
+        restoreState(&net, from);
+        for (unsigned long t = from; t < net.tick; t++) {
+            simulateTick(&net, t);
+        }
+    }
+    double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / repeats;
+    allocFree(ALLOC_TAG_OTHER, net.states);
+    return ms;
+}
+
+double netBenchmarkTicks(World *world, int ticks) {
+    NetSession net;
+    if (!benchSessionInit(&net, world)) {
+        return -1.0;
+    }
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (net.tick = 0; net.tick < (unsigned long)ticks; net.tick++) {
+        simulateTick(&net, net.tick);
+    }
+    double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / ticks;
+    allocFree(ALLOC_TAG_OTHER, net.states);
+    return ms;
+}
+
+double netBenchmarkDivergence(World *straight, World *rolled, int ticks, int period) {
+    NetSession a;
+    NetSession b;
+    if (!benchSessionInit(&a, straight)) {
+        return -1.0;
+    }
+    if (!benchSessionInit(&b, rolled) || straight->boxCount != rolled->boxCount) {
+        allocFree(ALLOC_TAG_OTHER, a.states);
+        allocFree(ALLOC_TAG_OTHER, b.states);
+        return -1.0;
+    }
+
+    for (unsigned long t = 0; t < (unsigned long)ticks; t++) {
+        simulateTick(&a, t);
+        if (t % period != (unsigned long)period - 1) {
+            simulateTick(&b, t);
+            continue;
+        }
+        // Simulate this tick with a wrong input, learn the real (empty) one and roll back
+        NetInput *input = inputAt(&b, b.config.localPlayer, t);
+        *input = (NetInput){.tick = t, .held = INPUT_RIGHT | INPUT_JUMP, .valid = true};
+        simulateTick(&b, t);
+        input->valid = false;
+        unsigned long from = t - t % NET_CANONICAL_TICKS;
+        if (!restoreState(&b, from)) {
+            allocFree(ALLOC_TAG_OTHER, a.states);
+            allocFree(ALLOC_TAG_OTHER, b.states);
+            return -1.0;
+        }
+        for (unsigned long r = from; r <= t; r++) {
+            simulateTick(&b, r);
+        }
+    }
+
+    double divergence = 0.0;
+    for (int i = 0; i < straight->boxCount; i++) {
+        double d = cpvdist(cpBodyGetPosition(straight->boxes[i].body), cpBodyGetPosition(rolled->boxes[i].body));
+        if (d > divergence) {
+            divergence = d;
+        }
+    }
+    allocFree(ALLOC_TAG_OTHER, a.states);
+    allocFree(ALLOC_TAG_OTHER, b.states);
+    return divergence;
+}
@@ -0,0 +1,133 @@
+#ifndef NET_H
+#define NET_H
+
+#include <SDL2/SDL.h>
+#include <chipmunk/chipmunk.h>
+#include <stdbool.h>
+#include "world.h"
+#include "batch.h"
+
+#define NET_PLAYERS 2
+#define NET_HISTORY 64              // Ticks of inputs and saved states kept, power of two
+#define NET_MAX_ROLLBACK 12         // Never simulate further ahead of confirmed remote input
+#define NET_INPUT_DELAY 2           // Local input applies this many ticks later, hides small latency
+#define NET_CANONICAL_TICKS 8       // Shapes are re-added every this many ticks; rollbacks restore from those
+#define NET_TICK_DT (1.0 / 60.0)
+#define NET_MAX_BODIES 1024
+#define NET_DELAY_QUEUE 256
+#define NET_PACKET_MAX 256
+
+typedef struct {
+    int localPlayer;                // 0 or 1; both peers must agree on who is who
+    int localPort;
+    const char *peer;               // host:port
+    int latencyMs;                  // Artificial one-way latency on outgoing packets
+    double lossPercent;             // Artificial loss on outgoing packets
+    bool bot;                       // Scripted local input instead of the keyboard
+    unsigned int seed;
+} NetConfig;
+
+// Dynamic state of one body. Contacts and the broadphase are rebuilt at canonical ticks.
+typedef struct {
+    cpVect p, v;
+    cpFloat a, w;
+} NetBodyState;
+
+// World state at the start of a tick
+typedef struct {
+    unsigned long tick;
+    bool valid;
+    bool final;                     // Simulated from confirmed inputs only
+    Uint32 checksum;
+    int count;
+    NetBodyState bodies[NET_MAX_BODIES];
+} NetSavedState;
+
+typedef struct {
+    unsigned long tick;
+    bool valid;
+    int held;
+} NetInput;
+
+// Outgoing packet held back by the latency shim
+typedef struct {
+    Uint32 dueMs;
+    int size;
+    unsigned char data[NET_PACKET_MAX];
+} NetDelayedPacket;
+
+typedef struct {
+    unsigned long ticks;            // Ticks simulated the first time
+    unsigned long rollbacks;
+    unsigned long resimulatedTicks;
+    int lastRollbackTicks;
+    int maxRollbackTicks;
+    double lastRollbackMs;          // Restore + re-simulation
+    double maxRollbackMs;
+    double totalRollbackMs;
+    unsigned long stalls;           // Frames spent waiting for the remote peer
+    unsigned long desyncs;          // Checksum mismatches on confirmed ticks
+    unsigned long packetsSent;
+    unsigned long packetsReceived;
+    unsigned long packetsDropped;   // By the loss shim
+} NetStats;
+
+// Two-player rollback session over UDP. Each peer simulates both players,
+// predicting the remote one by repeating its last confirmed input, and rolls
+// back to the first mispredicted tick when the real input arrives.
+typedef struct {
+    NetConfig config;
+    int socket;
+    unsigned char peerAddress[128]; // struct sockaddr storage
+    int peerAddressLength;
+    bool connected;                 // A packet from the peer has arrived
+
+    World *world;
+    cpBody *players[NET_PLAYERS];
+    cpShape *walls[2];
+    cpHashValue shapeIdBase;        // Box shapes are re-added with ids from here
+    unsigned long tick;             // Next tick to simulate
+
+    NetInput inputs[NET_PLAYERS][NET_HISTORY];
+    int usedRemote[NET_HISTORY];    // Remote input the last simulation of a tick used
+    unsigned long remoteConfirmed;  // Every remote input before this tick is known
+    unsigned long peerAck;          // The peer knows our inputs before this tick
+    unsigned long lastCheckedTick;  // Latest remote checksum compared
+    NetSavedState *states;          // NET_HISTORY entries
+
+    InputScript botScript;
+    int botCursor;
+
+    NetDelayedPacket delayed[NET_DELAY_QUEUE];
+    int delayedCount;
+    unsigned int lossState;
+
+    NetStats stats;
+} NetSession;
+
+// Open the socket, move the player and spawn the remote one. Call right after
+// the world is created and before anything else is spawned, with the same
+// options on both peers, so body order matches.
+bool netSessionInit(NetSession *net, World *world, const NetConfig *config);
+void netSessionDestroy(NetSession *net);
+
+// Receive, roll back if a prediction was wrong, simulate one new tick unless
+// too far ahead of the peer, and send our inputs
+void netSessionUpdate(NetSession *net, int localHeld);
+
+// Parse "host:port"
+bool netParsePeer(const char *text, char *host, int hostSize, int *port);
+
+// Save a state, step `ticks`, restore and re-simulate them. Returns ms per rollback.
+double netBenchmarkRollback(World *world, int ticks, int repeats);
+
+// Step `ticks` as a session does, with no input. Returns ms per tick.
+double netBenchmarkTicks(World *world, int ticks);
+
+// Step two identical worlds `ticks` ticks with no input. One goes straight
+// through; every `period` ticks the other simulates a tick with a wrong input,
+// rolls back and re-simulates. Returns the largest distance between matching
+// boxes afterwards, 0 when rollbacks are deterministic.
+double netBenchmarkDivergence(World *straight, World *rolled, int ticks, int period);
+
+#endif // NET_H
@@ -0,0 +1,360 @@
+#include "options.h"
+#include "alloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void printUsage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --scenario NAME   Load a stress scenario at startup\n");
+    printf("                    (pyramid, stack, rain, pile, mixed, rope, chain, bridge, swing)\n");
+    printf("  --count N         Number of bodies for the scenario\n");
+    printf("  --links N         Links per rope, chain, bridge or swing spawned with 1-4\n");
+    printf("                    (default %d)\n", LINKAGE_DEFAULT_LINKS);
+    printf("  --seed N          Seed for randomized scenarios (default 1)\n");
+    printf("  --sweep           Run scenarios across solver settings headless and exit;\n");
+    printf("                    restrict to one scenario with --scenario\n");
+    printf("  --frame-budget MS Frame budget for the physics governor (default 16.67)\n");
+    printf("  --no-governor     Keep solver quality fixed at Chipmunk defaults\n");
+    printf("  --pacing MODE     Frame pacing: vsync, uncapped or fps (default fps)\n");
+    printf("  --fps N           Target rate for --pacing fps (default 60)\n");
+    printf("  --sim-thread      Step physics on a separate thread at a fixed rate\n");
+    printf("  --tick-rate N     Simulation rate for --sim-thread (default 60)\n");
+    printf("  --jobs N          Worker threads for per-frame jobs (default: one per CPU)\n");
+    printf("  --bench-jobs      Time batched box vertex generation on 1..N workers and exit;\n");
+    printf("                    box count from --count (default 100000)\n");
+    printf("  --bench-layers    Count broadphase and narrowphase pairs with and without\n");
+    printf("                    the collision layer matrix and exit\n");
+    printf("  --stats FILE      Write per-step physics statistics to FILE ('-' for stdout)\n");
+    printf("  --stats-format F  csv or json (one object per line, default csv)\n");
+    printf("  --level DIR       Stream the level from chunk files in DIR around the player;\n");
+    printf("                    missing chunks are generated from --seed and saved\n");
+    printf("  --level-chunks N  Level length in screen-wide chunks (default 16)\n");
+    printf("  --lod             Put resting bodies far from the player to sleep, and\n");
+    printf("                    freeze the farthest ones as static until approached\n");
+    printf("  --lod-radius R    Freeze radius in pixels for --lod (default 1000);\n");
+    printf("                    bodies sleep beyond 0.6 R\n");
+    printf("  --batch K         Step K independent headless worlds on the job system and\n");
+    printf("                    exit; worlds use --scenario, --count and --seed + index\n");
+    printf("  --batch-steps N   Steps per batch world (default 3600)\n");
+    printf("  --batch-mode M    lockstep or free (default lockstep)\n");
+    printf("  --input FILE      Drive batch worlds with recorded input instead of\n");
+    printf("                    per-world scripted walking and jumping\n");
+    printf("  --record-input F  Record held input while playing, for --input\n");
+    printf("  --alloc-strict    Log and assert when a steady-state frame allocates from\n");
+    printf("                    physics, rendering, sprites or jobs (after %d frames)\n", ALLOC_WARMUP_FRAMES);
+    printf("  --net-port PORT   Play a two-player rollback session, listening on UDP PORT\n");
+    printf("  --net-peer H:P    Address of the other peer (required with --net-port)\n");
+    printf("  --net-player N    0 or 1; each peer controls one player (default 0)\n");
+    printf("  --net-latency MS  Delay outgoing packets by MS (default 0)\n");
+    printf("  --net-loss PCT    Drop PCT percent of outgoing packets (default 0)\n");
+    printf("  --net-bot         Play with scripted input instead of the keyboard\n");
+    printf("  --frames N        Exit after N frames\n");
+    printf("  --capture PATH    Record every frame: a directory of PNGs, or a Y4M file\n");
+    printf("  --capture-format F png or y4m (default: y4m if PATH ends in .y4m, else png)\n");
+    printf("  --metrics-port N  Serve Prometheus metrics on http://127.0.0.1:N/metrics\n");
+    printf("  --metrics-socket P  Serve them on the Unix domain socket P instead\n");
+    printf("  --no-particles    Turn off impact, jump and landing particles\n");
+    printf("  --dynamic-res     Lower the scene resolution when rendering is over budget\n");
+    printf("  --res-min-scale S Lowest scene scale for --dynamic-res (default %.2f)\n", RESOLUTION_DEFAULT_MIN_SCALE);
+    printf("  --res-filter F    Upscaling filter, nearest or linear (default linear)\n");
+    printf("  --dirty-rects     Render in software and redraw only the regions that changed\n");
+    printf("  --no-audio        Turn off sound effects\n");
+    printf("  --golden FILE     Render scripted scenes offscreen, compare per-frame pixel\n");
+    printf("                    hashes with FILE and exit; fails if FILE is missing\n");
+    printf("  --write-golden    With --golden, record the hashes to FILE instead\n");
+    printf("  --help            Show this help\n");
+}
+
+// Fetch the value following a flag, or report it missing
+static const char *optionValue(int argc, char *argv[], int *i) {
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "Missing value for %s\n", argv[*i]);
+        return NULL;
+    }
+    (*i)++;
+    return argv[*i];
+}
+
+bool parseOptions(int argc, char *argv[], GameOptions *options) {
+    GameOptions defaults = {
+        .scenario = SCENARIO_NONE,
+        .scenarioCount = 0,
+        .links = LINKAGE_DEFAULT_LINKS,
+        .seed = 1,
+        .sweep = false,
+        .frameBudgetMs = 1000.0 / 60.0,
+        .governor = true,
+        .pacing = PACING_TARGET_FPS,
+        .targetFps = 60.0,
+        .simThread = false,
+        .tickRate = 60.0,
+        .jobWorkers = 0,
+        .benchJobs = false,
+        .benchLayers = false,
+        .statsPath = NULL,
+        .statsFormat = STATS_FORMAT_CSV,
+        .levelPath = NULL,
+        .levelChunks = 16,
+        .lod = false,
+        .lodRadius = 0.0,
+        .batchWorlds = 0,
+        .batchSteps = 3600,
+        .batchMode = BATCH_LOCKSTEP,
+        .inputPath = NULL,
+        .recordInputPath = NULL,
+        .allocStrict = false,
+        .netPort = 0,
+        .netPeer = NULL,
+        .netPlayer = 0,
+        .netLatencyMs = 0,
+        .netLossPercent = 0.0,
+        .netBot = false,
+        .frames = 0,
+        .capturePath = NULL,
+        .captureFormat = CAPTURE_PNG,
+        .metricsPort = 0,
+        .metricsSocket = NULL,
+        .particles = true,
+        .dynamicResolution = false,
+        .resolutionMinScale = RESOLUTION_DEFAULT_MIN_SCALE,
+        .resolutionFilter = RESOLUTION_FILTER_LINEAR,
+        .dirtyRects = false,
+        .audio = true,
+        .goldenPath = NULL,
+        .writeGolden = false
+    };
+    *options = defaults;
+    bool captureFormatSet = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = NULL;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return false;
+        } else if (strcmp(arg, "--scenario") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->scenario = scenarioFromName(value);
+            if (options->scenario == SCENARIO_NONE) {
+                fprintf(stderr, "Unknown scenario: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--count") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->scenarioCount = atoi(value);
+        } else if (strcmp(arg, "--links") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->links = atoi(value);
+            if (options->links < 1) {
+                fprintf(stderr, "Link count must be at least 1\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--seed") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--sweep") == 0) {
+            options->sweep = true;
+        } else if (strcmp(arg, "--frame-budget") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->frameBudgetMs = atof(value);
+            if (options->frameBudgetMs <= 0.0) {
+                fprintf(stderr, "Frame budget must be positive\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--no-governor") == 0) {
+            options->governor = false;
+        } else if (strcmp(arg, "--pacing") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            if (!parsePacingMode(value, &options->pacing)) {
+                fprintf(stderr, "Unknown pacing mode: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--fps") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->targetFps = atof(value);
+            if (options->targetFps <= 0.0) {
+                fprintf(stderr, "Target FPS must be positive\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--sim-thread") == 0) {
+            options->simThread = true;
+        } else if (strcmp(arg, "--tick-rate") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->tickRate = atof(value);
+            if (options->tickRate <= 0.0) {
+                fprintf(stderr, "Tick rate must be positive\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--jobs") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->jobWorkers = atoi(value);
+        } else if (strcmp(arg, "--bench-jobs") == 0) {
+            options->benchJobs = true;
+        } else if (strcmp(arg, "--bench-layers") == 0) {
+            options->benchLayers = true;
+        } else if (strcmp(arg, "--stats") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->statsPath = value;
+        } else if (strcmp(arg, "--stats-format") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            if (!parseStatsFormat(value, &options->statsFormat)) {
+                fprintf(stderr, "Unknown stats format: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--level") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->levelPath = value;
+        } else if (strcmp(arg, "--level-chunks") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->levelChunks = atoi(value);
+            if (options->levelChunks < 1) {
+                fprintf(stderr, "Level needs at least one chunk\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--lod") == 0) {
+            options->lod = true;
+        } else if (strcmp(arg, "--lod-radius") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->lodRadius = atof(value);
+            if (options->lodRadius <= 0.0) {
+                fprintf(stderr, "LOD radius must be positive\n");
+                return false;
+            }
+            options->lod = true;
+        } else if (strcmp(arg, "--batch") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->batchWorlds = atoi(value);
+            if (options->batchWorlds < 1) {
+                fprintf(stderr, "Batch needs at least one world\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--batch-steps") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->batchSteps = atoi(value);
+            if (options->batchSteps < 1) {
+                fprintf(stderr, "Batch steps must be positive\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--batch-mode") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            if (!parseBatchMode(value, &options->batchMode)) {
+                fprintf(stderr, "Unknown batch mode: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--input") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->inputPath = value;
+        } else if (strcmp(arg, "--record-input") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->recordInputPath = value;
+        } else if (strcmp(arg, "--alloc-strict") == 0) {
+            options->allocStrict = true;
+        } else if (strcmp(arg, "--net-port") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->netPort = atoi(value);
+            if (options->netPort <= 0 || options->netPort > 65535) {
+                fprintf(stderr, "Bad UDP port: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--net-peer") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->netPeer = value;
+        } else if (strcmp(arg, "--net-player") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->netPlayer = atoi(value);
+            if (options->netPlayer != 0 && options->netPlayer != 1) {
+                fprintf(stderr, "Net player must be 0 or 1\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--net-latency") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->netLatencyMs = atoi(value);
+            if (options->netLatencyMs < 0) {
+                fprintf(stderr, "Latency can't be negative\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--net-loss") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->netLossPercent = atof(value);
+            if (options->netLossPercent < 0.0 || options->netLossPercent >= 100.0) {
+                fprintf(stderr, "Loss must be in [0, 100)\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--net-bot") == 0) {
+            options->netBot = true;
+        } else if (strcmp(arg, "--frames") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->frames = atoi(value);
+            if (options->frames < 1) {
+                fprintf(stderr, "Frame count must be positive\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--capture") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->capturePath = value;
+            size_t length = strlen(value);
+            if (!captureFormatSet && length > 4 && strcmp(value + length - 4, ".y4m") == 0) {
+                options->captureFormat = CAPTURE_Y4M;
+            }
+        } else if (strcmp(arg, "--capture-format") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            if (!parseCaptureFormat(value, &options->captureFormat)) {
+                fprintf(stderr, "Unknown capture format: %s\n", value);
+                return false;
+            }
+            captureFormatSet = true;
+        } else if (strcmp(arg, "--metrics-port") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->metricsPort = atoi(value);
+            if (options->metricsPort <= 0 || options->metricsPort > 65535) {
+                fprintf(stderr, "Bad metrics port: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--metrics-socket") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->metricsSocket = value;
+        } else if (strcmp(arg, "--no-particles") == 0) {
+            options->particles = false;
+        } else if (strcmp(arg, "--no-audio") == 0) {
+            options->audio = false;
+        } else if (strcmp(arg, "--golden") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->goldenPath = value;
+        } else if (strcmp(arg, "--write-golden") == 0) {
+            options->writeGolden = true;
+        } else if (strcmp(arg, "--dirty-rects") == 0) {
+            options->dirtyRects = true;
+        } else if (strcmp(arg, "--dynamic-res") == 0) {
+            options->dynamicResolution = true;
+        } else if (strcmp(arg, "--res-min-scale") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            options->resolutionMinScale = atof(value);
+            if (options->resolutionMinScale < RESOLUTION_MIN_SCALE || options->resolutionMinScale > 1.0) {
+                fprintf(stderr, "Minimum scale must be between %.2f and 1\n", RESOLUTION_MIN_SCALE);
+                return false;
+            }
+        } else if (strcmp(arg, "--res-filter") == 0) {
+            if (!(value = optionValue(argc, argv, &i))) return false;
+            if (!parseResolutionFilter(value, &options->resolutionFilter)) {
+                fprintf(stderr, "Unknown filter: %s\n", value);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options->writeGolden && !options->goldenPath) {
+        fprintf(stderr, "--write-golden needs --golden\n");
+        return false;
+    }
+    if (options->netPort && !options->netPeer) {
+        fprintf(stderr, "--net-port needs --net-peer\n");
+        return false;
+    }
+    return true;
+}
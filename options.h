@@ -0,0 +1,68 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdbool.h>
+#include "scenario.h"
+#include "pacing.h"
+#include "physstats.h"
+#include "batch.h"
+#include "capture.h"
+#include "resolution.h"
+#include "linkage.h"
+
+// Command line options
+typedef struct {
+    ScenarioType scenario;   // Scenario loaded at startup (or swept)
+    int scenarioCount;       // Bodies for the scenario, 0 = scenario default
+    int links;               // Links per interactively spawned linkage
+    unsigned int seed;       // Seed for randomized scenarios
+    bool sweep;              // Run the headless solver sweep and exit
+    double frameBudgetMs;    // Target frame time for the physics governor
+    bool governor;           // Adapt solver quality to the frame budget
+    PacingMode pacing;       // Frame pacing mode
+    double targetFps;        // Rate for PACING_TARGET_FPS (and expected vsync rate)
+    bool simThread;          // Step physics on its own thread
+    double tickRate;         // Simulation rate with --sim-thread
+    int jobWorkers;          // Job system workers, 0 = one per CPU
+    bool benchJobs;          // Run the job system scaling benchmark and exit
+    bool benchLayers;        // Compare pair counts with and without collision layers and exit
+    const char *statsPath;   // Per-step physics statistics stream, NULL = off
+    StatsFormat statsFormat;
+    const char *levelPath;   // Directory of streamed level chunks, NULL = fixed single-screen level
+    int levelChunks;         // Level length in chunks
+    bool lod;                // Sleep/freeze bodies far from the player
+    double lodRadius;        // Freeze radius, 0 = default
+    int batchWorlds;         // Run this many headless worlds and exit, 0 = off
+    int batchSteps;
+    BatchMode batchMode;
+    const char *inputPath;   // Recorded input replayed by batch worlds
+    const char *recordInputPath; // Record held input while playing
+    bool allocStrict;        // Assert on heap allocations in steady-state frames
+    int netPort;             // Local UDP port for a rollback session, 0 = single player
+    const char *netPeer;     // host:port of the other peer
+    int netPlayer;           // 0 or 1, the same world on both peers
+    int netLatencyMs;        // Added to every outgoing packet
+    double netLossPercent;   // Outgoing packets dropped
+    bool netBot;             // Scripted input instead of the keyboard
+    int frames;              // Exit after this many frames, 0 = run until closed
+    const char *capturePath; // Record presented frames here, NULL = off
+    CaptureFormat captureFormat;
+    int metricsPort;         // Serve Prometheus metrics on 127.0.0.1:port, 0 = off
+    const char *metricsSocket; // Serve them on this Unix domain socket instead
+    bool particles;          // Impact, jump and landing particles
+    bool dynamicResolution;  // Scale the scene resolution with render time
+    double resolutionMinScale;
+    ResolutionFilter resolutionFilter;
+    bool dirtyRects;         // Software rendering into the window surface, redrawing only changes
+    bool audio;              // Impact, jump and landing sounds
+    const char *goldenPath;  // Render the golden scenes offscreen against this file and exit
+    bool writeGolden;        // Record the golden hashes instead of comparing
+} GameOptions;
+
+// Fill options with defaults and parse argv. Returns false if the program should exit.
+bool parseOptions(int argc, char *argv[], GameOptions *options);
+
+// Print command line help
+void printUsage(const char *program);
+
+#endif // OPTIONS_H
@@ -0,0 +1,105 @@
+#include "pacing.h"
+#include "logging.h"
+#include <string.h>
+#include <math.h>
+
+// Sleep until this close to the deadline, then spin; covers scheduler granularity
+#define PACING_SPIN_MS 2.0
+#define PACING_ERROR_SMOOTHING 0.05
+
+bool parsePacingMode(const char *name, PacingMode *mode) {
+    if (strcmp(name, "vsync") == 0) {
+        *mode = PACING_VSYNC;
+    } else if (strcmp(name, "uncapped") == 0) {
+        *mode = PACING_UNCAPPED;
+    } else if (strcmp(name, "fps") == 0) {
+        *mode = PACING_TARGET_FPS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *pacingModeName(PacingMode mode) {
+    switch (mode) {
+        case PACING_VSYNC:      return "vsync";
+        case PACING_UNCAPPED:   return "uncapped";
+        case PACING_TARGET_FPS: return "fps";
+        default:                return "unknown";
+    }
+}
+
+void pacerInit(FramePacer *pacer, PacingMode mode, double targetFps) {
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->mode = mode;
+    pacer->targetFps = targetFps;
+    pacer->frequency = SDL_GetPerformanceFrequency();
+    pacer->period = (Uint64)(pacer->frequency / targetFps);
+    pacer->lastFrame = SDL_GetPerformanceCounter();
+    pacer->nextDeadline = pacer->lastFrame + pacer->period;
+}
+
+Uint32 pacerRendererFlags(const FramePacer *pacer) {
+    Uint32 flags = SDL_RENDERER_ACCELERATED;
+    if (pacer->mode == PACING_VSYNC) {
+        flags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    return flags;
+}
+
+void pacerCheckRenderer(FramePacer *pacer, SDL_Renderer *renderer) {
+    if (pacer->mode != PACING_VSYNC) {
+        return;
+    }
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0 && !(info.flags & SDL_RENDERER_PRESENTVSYNC)) {
+        LOG_WARNING("Renderer %s does not support vsync, pacing to %.0f fps instead",
+                    info.name, pacer->targetFps);
+        pacer->mode = PACING_TARGET_FPS;
+    }
+}
+
+static double ticksToMs(const FramePacer *pacer, Uint64 ticks) {
+    return (double)ticks * 1000.0 / pacer->frequency;
+}
+
+double pacerWait(FramePacer *pacer) {
+    Uint64 waitStart = SDL_GetPerformanceCounter();
+    Uint64 now = waitStart;
+
+    if (pacer->mode == PACING_TARGET_FPS) {
+        if (now > pacer->nextDeadline) {
+            pacer->missedDeadlines++;
+            // Too far behind to catch up: restart the schedule instead of bursting
+            if (now - pacer->nextDeadline > pacer->period) {
+                pacer->nextDeadline = now;
+            }
+        } else {
+            // Coarse sleep for most of the remaining time...
+            double remainingMs = ticksToMs(pacer, pacer->nextDeadline - now);
+            if (remainingMs > PACING_SPIN_MS) {
+                SDL_Delay((Uint32)(remainingMs - PACING_SPIN_MS));
+            }
+            // ...then spin on the high resolution counter for the last stretch
+            do {
+                now = SDL_GetPerformanceCounter();
+            } while (now < pacer->nextDeadline);
+        }
+        pacer->nextDeadline += pacer->period;
+    }
+
+    // Measure delivery against the target period
+    pacer->intervalMs = ticksToMs(pacer, now - pacer->lastFrame);
+    pacer->lastFrame = now;
+    if (pacer->mode != PACING_UNCAPPED) {
+        pacer->errorMs = pacer->intervalMs - ticksToMs(pacer, pacer->period);
+        double absError = fabs(pacer->errorMs);
+        pacer->avgAbsErrorMs += (absError - pacer->avgAbsErrorMs) * PACING_ERROR_SMOOTHING;
+        if (absError > pacer->maxAbsErrorMs) {
+            pacer->maxAbsErrorMs = absError;
+        }
+    }
+
+    return ticksToMs(pacer, now - waitStart);
+}
@@ -0,0 +1,46 @@
+#ifndef PACING_H
+#define PACING_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// How frames are paced after SDL_RenderPresent
+typedef enum {
+    PACING_VSYNC,       // Let the renderer block on vertical sync
+    PACING_UNCAPPED,    // Run as fast as possible
+    PACING_TARGET_FPS   // Hybrid sleep-then-spin to a fixed rate
+} PacingMode;
+
+// Frame pacer state and delivery statistics
+typedef struct {
+    PacingMode mode;
+    double targetFps;
+    Uint64 frequency;        // Performance counter ticks per second
+    Uint64 period;           // Target ticks per frame
+    Uint64 nextDeadline;     // When the next frame should be delivered
+    Uint64 lastFrame;        // When the previous frame was delivered
+    double intervalMs;       // Last measured frame interval
+    double errorMs;          // Last interval minus the target period
+    double avgAbsErrorMs;    // Moving average of |error|
+    double maxAbsErrorMs;    // Worst |error| seen
+    int missedDeadlines;     // Frames that finished after their deadline
+} FramePacer;
+
+// Parse "vsync", "uncapped" or "fps"
+bool parsePacingMode(const char *name, PacingMode *mode);
+const char *pacingModeName(PacingMode mode);
+
+// Initialize the pacer. targetFps is also the expected rate in vsync mode.
+void pacerInit(FramePacer *pacer, PacingMode mode, double targetFps);
+
+// Renderer flags for the pacing mode
+Uint32 pacerRendererFlags(const FramePacer *pacer);
+
+// Check that the created renderer honours vsync; falls back to target FPS if not
+void pacerCheckRenderer(FramePacer *pacer, SDL_Renderer *renderer);
+
+// Call after presenting. Waits for the next deadline in target mode and
+// updates the pacing error statistics. Returns the time spent waiting in ms.
+double pacerWait(FramePacer *pacer);
+
+#endif // PACING_H
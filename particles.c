@@ -0,0 +1,176 @@
+#include "particles.h"
+#include "world.h"
+#include "alloc.h"
+#include "logging.h"
+#include <math.h>
+#include <string.h>
+
+#define PARTICLE_BOUNCE 0.3f        // Vertical speed kept when hitting the ground
+#define PARTICLE_GROUND_FRICTION 0.7f
+
+typedef struct {
+    float angle, spread;            // Launch direction (radians, 0 = right, up is positive)
+    float minSpeed, maxSpeed;
+    float minLife, maxLife;
+    Uint32 color;                   // 0xRRGGBB
+} BurstPreset;
+
+static const BurstPreset presets[PARTICLE_BURST_COUNT] = {
+    [PARTICLE_BURST_IMPACT]  = {1.5707963f, 3.1415926f,  80.0f, 260.0f, 0.25f, 0.6f, 0xffc040},
+    [PARTICLE_BURST_JUMP]    = {-1.5707963f, 2.2f,       30.0f, 120.0f, 0.2f,  0.45f, 0xc8c8c8},
+    [PARTICLE_BURST_LANDING] = {1.5707963f, 2.8f,        60.0f, 180.0f, 0.3f,  0.6f, 0xb4aa96},
+};
+
+static void freeArrays(ParticleSystem *particles) {
+    allocFree(ALLOC_TAG_RENDER, particles->x);
+    allocFree(ALLOC_TAG_RENDER, particles->y);
+    allocFree(ALLOC_TAG_RENDER, particles->vx);
+    allocFree(ALLOC_TAG_RENDER, particles->vy);
+    allocFree(ALLOC_TAG_RENDER, particles->life);
+    allocFree(ALLOC_TAG_RENDER, particles->invLifetime);
+    allocFree(ALLOC_TAG_RENDER, particles->color);
+    allocFree(ALLOC_TAG_RENDER, particles->vertices);
+}
+
+bool particleSystemInit(ParticleSystem *particles, int capacity) {
+    memset(particles, 0, sizeof(*particles));
+    particles->capacity = capacity;
+    particles->rng = 0x9e3779b9u;
+
+    size_t floats = sizeof(float) * (size_t)capacity;
+    particles->x = allocMalloc(ALLOC_TAG_RENDER, floats);
+    particles->y = allocMalloc(ALLOC_TAG_RENDER, floats);
+    particles->vx = allocMalloc(ALLOC_TAG_RENDER, floats);
+    particles->vy = allocMalloc(ALLOC_TAG_RENDER, floats);
+    particles->life = allocMalloc(ALLOC_TAG_RENDER, floats);
+    particles->invLifetime = allocMalloc(ALLOC_TAG_RENDER, floats);
+    particles->color = allocMalloc(ALLOC_TAG_RENDER, sizeof(Uint32) * (size_t)capacity);
+    particles->vertices = allocMalloc(ALLOC_TAG_RENDER, sizeof(SDL_Vertex) * 3 * (size_t)capacity);
+    if (!particles->x || !particles->y || !particles->vx || !particles->vy || !particles->life ||
+        !particles->invLifetime || !particles->color || !particles->vertices) {
+        LOG_ERROR("Failed to allocate %d particles", capacity);
+        freeArrays(particles);
+        memset(particles, 0, sizeof(*particles));
+        return false;
+    }
+    return true;
+}
+
+void particleSystemDestroy(ParticleSystem *particles) {
+    freeArrays(particles);
+    memset(particles, 0, sizeof(*particles));
+}
+
+// xorshift32, mapped to [0, 1)
+static float randomUnit(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+void particleSystemEmit(ParticleSystem *particles, ParticleBurst burst, float x, float y,
+                        float strength, int count) {
+    const BurstPreset *preset = &presets[burst];
+    int room = particles->capacity - particles->count;
+    if (count > room) {
+        particles->dropped += count - room;
+        count = room;
+    }
+
+    for (int n = 0; n < count; n++) {
+        int i = particles->count++;
+        float angle = preset->angle + (randomUnit(&particles->rng) - 0.5f) * preset->spread;
+        float speed = (preset->minSpeed + randomUnit(&particles->rng) * (preset->maxSpeed - preset->minSpeed)) * strength;
+        float life = preset->minLife + randomUnit(&particles->rng) * (preset->maxLife - preset->minLife);
+        particles->x[i] = x;
+        particles->y[i] = y;
+        particles->vx[i] = cosf(angle) * speed;
+        particles->vy[i] = sinf(angle) * speed;
+        particles->life[i] = life;
+        particles->invLifetime[i] = 1.0f / life;
+        particles->color[i] = preset->color;
+    }
+    particles->emitted += count;
+}
+
+void particleSystemUpdate(ParticleSystem *particles, float dt) {
+    int count = particles->count;
+    float *restrict px = particles->x;
+    float *restrict py = particles->y;
+    float *restrict vx = particles->vx;
+    float *restrict vy = particles->vy;
+    float *restrict life = particles->life;
+    const float ground = (float)GROUND_HEIGHT;
+    const float gravity = PARTICLE_GRAVITY * dt;
+
+    // Straight-line loops; the ground response is a 0/1 mask multiplied in
+    // rather than a branch
+    for (int i = 0; i < count; i++) {
+        vy[i] -= gravity;
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        life[i] -= dt;
+    }
+    for (int i = 0; i < count; i++) {
+        float below = py[i] < ground ? 1.0f : 0.0f;
+        py[i] += (ground - py[i]) * below;
+        vy[i] *= 1.0f - (1.0f + PARTICLE_BOUNCE) * below;
+        vx[i] *= 1.0f - (1.0f - PARTICLE_GROUND_FRICTION) * below;
+    }
+
+    // Compact survivors to the front, keeping their order
+    int alive = 0;
+    for (int i = 0; i < count; i++) {
+        if (life[i] > 0.0f) {
+            px[alive] = px[i];
+            py[alive] = py[i];
+            vx[alive] = vx[i];
+            vy[alive] = vy[i];
+            life[alive] = life[i];
+            particles->invLifetime[alive] = particles->invLifetime[i];
+            particles->color[alive] = particles->color[i];
+            alive++;
+        }
+    }
+    particles->count = alive;
+}
+
+int particleSystemBuild(ParticleSystem *particles, float cameraX) {
+    SDL_Vertex *vertex = particles->vertices;
+    const float half = PARTICLE_SIZE * 0.5f;
+
+    for (int i = 0; i < particles->count; i++) {
+        float sx = particles->x[i] - cameraX;
+        if (sx < -PARTICLE_SIZE || sx > WINDOW_WIDTH + PARTICLE_SIZE) {
+            continue;
+        }
+        float sy = WINDOW_HEIGHT - particles->y[i];
+        float fade = particles->life[i] * particles->invLifetime[i];
+        Uint32 rgb = particles->color[i];
+        SDL_Color color = {(Uint8)(rgb >> 16), (Uint8)(rgb >> 8), (Uint8)rgb, (Uint8)(fade * 255.0f)};
+
+        vertex[0].position.x = sx - half; vertex[0].position.y = sy + half;
+        vertex[1].position.x = sx + half; vertex[1].position.y = sy + half;
+        vertex[2].position.x = sx;        vertex[2].position.y = sy - half;
+        for (int v = 0; v < 3; v++) {
+            vertex[v].color = color;
+            vertex[v].tex_coord.x = 0.0f;
+            vertex[v].tex_coord.y = 0.0f;
+        }
+        vertex += 3;
+    }
+    particles->vertexCount = (int)(vertex - particles->vertices);
+    return particles->vertexCount;
+}
+
+void particleSystemRender(const ParticleSystem *particles, SDL_Renderer *renderer) {
+    if (particles->vertexCount == 0) {
+        return;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(renderer, NULL, particles->vertices, particles->vertexCount, NULL, 0);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
@@ -0,0 +1,56 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#define PARTICLE_CAPACITY 131072    // Default pool size; emits beyond it are dropped
+#define PARTICLE_GRAVITY 600.0f     // Lighter than the physics world, so dust hangs a little
+#define PARTICLE_SIZE 3.0f          // Triangle edge in pixels
+
+// Burst presets
+typedef enum {
+    PARTICLE_BURST_IMPACT,          // Sparks where boxes collide hard
+    PARTICLE_BURST_JUMP,            // Dust kicked down by a jump
+    PARTICLE_BURST_LANDING,         // Dust thrown sideways on landing
+    PARTICLE_BURST_COUNT
+} ParticleBurst;
+
+// Structure-of-arrays pool. Integration walks each array linearly with no
+// branches; dead particles are compacted out afterwards. Particles never touch the physics space: they only
+// collide with the ground height.
+typedef struct {
+    float *x, *y;                   // World coordinates, Chipmunk orientation (y up)
+    float *vx, *vy;
+    float *life;                    // Seconds left
+    float *invLifetime;             // 1 / initial life, for fading
+    Uint32 *color;                  // RGB of the burst; alpha comes from life
+    int count;
+    int capacity;
+    unsigned int rng;
+
+    SDL_Vertex *vertices;           // 3 per particle, drawn with one SDL_RenderGeometry call
+    int vertexCount;
+
+    // Statistics
+    unsigned long emitted;
+    unsigned long dropped;          // Pool full
+} ParticleSystem;
+
+bool particleSystemInit(ParticleSystem *particles, int capacity);
+void particleSystemDestroy(ParticleSystem *particles);
+
+// Spawn `count` particles of a preset at (x, y), scaled by `strength` (1 = nominal)
+void particleSystemEmit(ParticleSystem *particles, ParticleBurst burst, float x, float y,
+                        float strength, int count);
+
+// Integrate by `dt` seconds, bounce off the ground and remove dead particles
+void particleSystemUpdate(ParticleSystem *particles, float dt);
+
+// Fill the vertex buffer for a camera at `cameraX`. Returns the vertex count.
+int particleSystemBuild(ParticleSystem *particles, float cameraX);
+
+// Draw the vertices from the last build
+void particleSystemRender(const ParticleSystem *particles, SDL_Renderer *renderer);
+
+#endif // PARTICLES_H
@@ -0,0 +1,133 @@
+#include "physstats.h"
+#include "world.h"
+#include <chipmunk/chipmunk_structs.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+bool parseStatsFormat(const char *name, StatsFormat *format) {
+    if (strcmp(name, "csv") == 0) {
+        *format = STATS_FORMAT_CSV;
+    } else if (strcmp(name, "json") == 0) {
+        *format = STATS_FORMAT_JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void countBody(cpBody *body, void *data) {
+    PhysicsStats *stats = data;
+    if (cpBodyGetType(body) != CP_BODY_TYPE_DYNAMIC) {
+        return;
+    }
+    stats->dynamicBodies++;
+    if (cpBodyIsSleeping(body)) {
+        stats->sleepingBodies++;
+    }
+}
+
+static void addHeat(PhysicsStats *stats, cpVect point, cpFloat originX) {
+    int col = (int)floor((point.x - originX) / HEATMAP_CELL);
+    int row = (int)((WINDOW_HEIGHT - point.y) / HEATMAP_CELL);
+    if (col < 0 || col >= HEATMAP_COLS || row < 0 || row >= HEATMAP_ROWS) {
+        return;
+    }
+    int heat = ++stats->heat[row][col];
+    if (heat > stats->maxHeat) {
+        stats->maxHeat = heat;
+    }
+}
+
+typedef struct {
+    cpShape *self;
+    bool selfStatic;
+    cpShapeFilter filter;
+    int pairs;
+    int candidates;
+} PairQuery;
+
+// Same test Chipmunk applies to a broadphase pair before the narrowphase
+static bool filtersReject(cpShapeFilter a, cpShapeFilter b) {
+    return (a.group != CP_NO_GROUP && a.group == b.group) ||
+           (a.categories & b.mask) == 0 ||
+           (b.categories & a.mask) == 0;
+}
+
+static bool isStatic(cpShape *shape) {
+    return cpBodyGetType(cpShapeGetBody(shape)) == CP_BODY_TYPE_STATIC;
+}
+
+// Count each overlapping pair once, from the shape with the lower address.
+// Static-static pairs are skipped: Chipmunk keeps static shapes in their own
+// index and never tests them against each other.
+static void countPair(cpShape *shape, void *data) {
+    PairQuery *query = data;
+    if ((uintptr_t)shape > (uintptr_t)query->self && !(query->selfStatic && isStatic(shape))) {
+        query->pairs++;
+        if (!filtersReject(query->filter, cpShapeGetFilter(shape))) {
+            query->candidates++;
+        }
+    }
+}
+
+static void queryPairs(cpShape *shape, void *data) {
+    PhysicsStats *stats = data;
+    cpSpace *space = cpShapeGetSpace(shape);
+    PairQuery query = {shape, isStatic(shape), cpShapeGetFilter(shape), 0, 0};
+    cpSpaceBBQuery(space, cpShapeGetBB(shape), CP_SHAPE_FILTER_ALL, countPair, &query);
+    stats->broadphasePairs += query.pairs;
+    stats->candidatePairs += query.candidates;
+}
+
+void physicsStatsCollect(PhysicsStats *stats, cpSpace *space, double stepMs, bool countPairs,
+                         cpFloat originX) {
+    memset(stats, 0, sizeof(*stats));
+    stats->stepMs = stepMs;
+
+    cpSpaceEachBody(space, countBody, stats);
+    stats->activeBodies = space->dynamicBodies->num;
+    stats->constraints = space->constraints->num;
+
+    // Arbiters that were solved in the last step, with their contact points
+    cpArray *arbiters = space->arbiters;
+    stats->arbiters = arbiters->num;
+    for (int i = 0; i < arbiters->num; i++) {
+        cpArbiter *arb = arbiters->arr[i];
+        int count = cpArbiterGetCount(arb);
+        stats->contacts += count;
+        for (int j = 0; j < count; j++) {
+            addHeat(stats, cpArbiterGetPointA(arb, j), originX);
+        }
+    }
+
+    if (countPairs) {
+        cpSpaceEachShape(space, queryPairs, stats);
+    } else {
+        stats->broadphasePairs = -1;
+        stats->candidatePairs = -1;
+    }
+}
+
+void physicsStatsWriteHeader(FILE *out, StatsFormat format) {
+    if (format == STATS_FORMAT_CSV) {
+        fprintf(out, "tick,step_ms,dynamic_bodies,active_bodies,sleeping_bodies,"
+                     "broadphase_pairs,candidate_pairs,arbiters,contacts,constraints,max_cell_contacts\n");
+    }
+}
+
+void physicsStatsWrite(FILE *out, StatsFormat format, unsigned long tick, const PhysicsStats *stats) {
+    if (format == STATS_FORMAT_CSV) {
+        fprintf(out, "%lu,%.4f,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+                tick, stats->stepMs, stats->dynamicBodies, stats->activeBodies,
+                stats->sleepingBodies, stats->broadphasePairs, stats->candidatePairs, stats->arbiters,
+                stats->contacts, stats->constraints, stats->maxHeat);
+    } else {
+        fprintf(out, "{\"tick\":%lu,\"step_ms\":%.4f,\"dynamic_bodies\":%d,\"active_bodies\":%d,"
+                     "\"sleeping_bodies\":%d,\"broadphase_pairs\":%d,\"candidate_pairs\":%d,"
+                     "\"arbiters\":%d,\"contacts\":%d,\"constraints\":%d,\"max_cell_contacts\":%d}\n",
+                tick, stats->stepMs, stats->dynamicBodies, stats->activeBodies,
+                stats->sleepingBodies, stats->broadphasePairs, stats->candidatePairs, stats->arbiters,
+                stats->contacts, stats->constraints, stats->maxHeat);
+    }
+}
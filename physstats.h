@@ -0,0 +1,46 @@
+#ifndef PHYSSTATS_H
+#define PHYSSTATS_H
+
+#include <chipmunk/chipmunk.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// Contact density grid over the window, one cell per HEATMAP_CELL pixels
+#define HEATMAP_CELL 50
+#define HEATMAP_COLS 16
+#define HEATMAP_ROWS 12
+
+// What one cpSpaceStep had to work with
+typedef struct {
+    int dynamicBodies;
+    int activeBodies;
+    int sleepingBodies;
+    int broadphasePairs;       // Overlapping shape bounding boxes, static-static excluded, -1 when not counted
+    int candidatePairs;        // Of those, pairs whose filters pass (reach narrowphase), -1 when not counted
+    int arbiters;              // Colliding shape pairs
+    int contacts;
+    int constraints;
+    double stepMs;
+
+    int heat[HEATMAP_ROWS][HEATMAP_COLS];
+    int maxHeat;
+} PhysicsStats;
+
+typedef enum {
+    STATS_FORMAT_CSV,
+    STATS_FORMAT_JSON          // One object per line
+} StatsFormat;
+
+bool parseStatsFormat(const char *name, StatsFormat *format);
+
+// Count bodies, arbiters, contacts and constraints after a step. Broadphase
+// pairs need a bounding box query per shape and are only counted on request.
+// The heatmap covers the window scrolled to start at world x `originX`.
+void physicsStatsCollect(PhysicsStats *stats, cpSpace *space, double stepMs, bool countPairs,
+                         cpFloat originX);
+
+// Stream one record per step
+void physicsStatsWriteHeader(FILE *out, StatsFormat format);
+void physicsStatsWrite(FILE *out, StatsFormat format, unsigned long tick, const PhysicsStats *stats);
+
+#endif // PHYSSTATS_H
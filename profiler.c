@@ -0,0 +1,118 @@
+#include "profiler.h"
+#include "logging.h"
+#include <string.h>
+
+#define PROFILER_SMOOTHING 0.1          // Weight of a new sample in the moving average
+#define PROFILER_REPORT_INTERVAL_MS 1000
+
+static const char *sectionNames[PROFILE_SECTION_COUNT] = {
+    "frame", "step", "render", "wait"
+};
+
+static const char *gaugeNames[GAUGE_COUNT] = {
+    "bodies", "quality_level", "iterations", "substeps", "sleep_threshold",
+    "pacing_error_ms", "pool_live", "pool_high_water", "pool_recycled",
+    "pool_exhausted", "active_bodies", "sleeping_bodies", "broadphase_pairs",
+    "arbiters", "contacts", "constraints", "lod_sleeping", "lod_frozen",
+    "allocs_per_frame", "alloc_bytes_per_frame", "heap_live_bytes", "heap_high_water_bytes",
+    "rollback_ticks", "rollback_ms", "capture_ms", "capture_dropped",
+    "particles", "particle_ms", "render_scale", "dirty_rects", "redraw_fraction",
+    "audio_callback_us", "audio_voices", "audio_rate_limited",
+    "area_effects", "effect_bodies", "effect_ms"
+};
+
+static ProfileStat g_stats[PROFILE_SECTION_COUNT];
+static double g_gauges[GAUGE_COUNT];
+static Uint64 g_lastReport = 0;
+static int g_framesSinceReport = 0;
+
+void profiler_init(void) {
+    memset(g_stats, 0, sizeof(g_stats));
+    memset(g_gauges, 0, sizeof(g_gauges));
+    g_lastReport = SDL_GetPerformanceCounter();
+    g_framesSinceReport = 0;
+}
+
+Uint64 profiler_begin(void) {
+    return SDL_GetPerformanceCounter();
+}
+
+double profiler_end(ProfileSection section, Uint64 start) {
+    double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    profiler_record(section, ms);
+    return ms;
+}
+
+void profiler_record(ProfileSection section, double ms) {
+    ProfileStat *stat = &g_stats[section];
+    stat->lastMs = ms;
+    stat->avgMs = (stat->avgMs == 0.0) ? ms : stat->avgMs + (ms - stat->avgMs) * PROFILER_SMOOTHING;
+    if (ms > stat->maxMs) {
+        stat->maxMs = ms;
+    }
+}
+
+const ProfileStat *profiler_stat(ProfileSection section) {
+    return &g_stats[section];
+}
+
+void profiler_set_gauge(ProfileGauge gauge, double value) {
+    g_gauges[gauge] = value;
+}
+
+double profiler_gauge(ProfileGauge gauge) {
+    return g_gauges[gauge];
+}
+
+const char *profiler_section_name(ProfileSection section) {
+    return sectionNames[section];
+}
+
+const char *profiler_gauge_name(ProfileGauge gauge) {
+    return gaugeNames[gauge];
+}
+
+void profiler_format_hud(char *buffer, size_t size) {
+    double frameMs = g_stats[PROFILE_FRAME].avgMs;
+    snprintf(buffer, size, "%.0f fps | pace err %.2f ms | step %.2f ms | render %.2f ms | %d bodies (%d awake) | %d contacts | Q%d it%d x%d | res %.0f%% | %d allocs/frame",
+             frameMs > 0.0 ? 1000.0 / frameMs : 0.0,
+             g_gauges[GAUGE_PACING_ERROR],
+             g_stats[PROFILE_STEP].avgMs,
+             g_stats[PROFILE_RENDER].avgMs,
+             (int)g_gauges[GAUGE_BODIES],
+             (int)g_gauges[GAUGE_ACTIVE_BODIES],
+             (int)g_gauges[GAUGE_CONTACTS],
+             (int)g_gauges[GAUGE_QUALITY_LEVEL],
+             (int)g_gauges[GAUGE_ITERATIONS],
+             (int)g_gauges[GAUGE_SUBSTEPS],
+             g_gauges[GAUGE_RENDER_SCALE] * 100.0,
+             (int)g_gauges[GAUGE_ALLOCS_PER_FRAME]);
+}
+
+bool profiler_frame_end(void) {
+    g_framesSinceReport++;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    double sinceReportMs = (double)(now - g_lastReport) * 1000.0 / SDL_GetPerformanceFrequency();
+    if (sinceReportMs < PROFILER_REPORT_INTERVAL_MS) {
+        return false;
+    }
+
+    char line[1024];
+    int len = snprintf(line, sizeof(line), "Profile: %d frames", g_framesSinceReport);
+    for (int i = 0; i < PROFILE_SECTION_COUNT && len < (int)sizeof(line); i++) {
+        len += snprintf(line + len, sizeof(line) - len, " | %s avg %.2f max %.2f ms",
+                        sectionNames[i], g_stats[i].avgMs, g_stats[i].maxMs);
+    }
+    for (int i = 0; i < GAUGE_COUNT && len < (int)sizeof(line); i++) {
+        len += snprintf(line + len, sizeof(line) - len, " | %s %.2f", gaugeNames[i], g_gauges[i]);
+    }
+    LOG_DEBUG("%s", line);
+
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        g_stats[i].maxMs = 0.0;
+    }
+    g_lastReport = now;
+    g_framesSinceReport = 0;
+    return true;
+}
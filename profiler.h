@@ -0,0 +1,95 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Timed sections of a frame
+typedef enum {
+    PROFILE_FRAME,
+    PROFILE_STEP,
+    PROFILE_RENDER,
+    PROFILE_WAIT,
+    PROFILE_SECTION_COUNT
+} ProfileSection;
+
+// Values sampled once per frame
+typedef enum {
+    GAUGE_BODIES,
+    GAUGE_QUALITY_LEVEL,
+    GAUGE_ITERATIONS,
+    GAUGE_SUBSTEPS,
+    GAUGE_SLEEP_THRESHOLD,
+    GAUGE_PACING_ERROR,
+    GAUGE_POOL_LIVE,
+    GAUGE_POOL_HIGH_WATER,
+    GAUGE_POOL_RECYCLED,
+    GAUGE_POOL_EXHAUSTED,
+    GAUGE_ACTIVE_BODIES,
+    GAUGE_SLEEPING_BODIES,
+    GAUGE_BROADPHASE_PAIRS,
+    GAUGE_ARBITERS,
+    GAUGE_CONTACTS,
+    GAUGE_CONSTRAINTS,
+    GAUGE_LOD_SLEEPING,
+    GAUGE_LOD_FROZEN,
+    GAUGE_ALLOCS_PER_FRAME,
+    GAUGE_ALLOC_BYTES_PER_FRAME,
+    GAUGE_HEAP_LIVE,
+    GAUGE_HEAP_HIGH_WATER,
+    GAUGE_ROLLBACK_TICKS,
+    GAUGE_ROLLBACK_MS,
+    GAUGE_CAPTURE_MS,
+    GAUGE_CAPTURE_DROPPED,
+    GAUGE_PARTICLES,
+    GAUGE_PARTICLE_MS,
+    GAUGE_RENDER_SCALE,
+    GAUGE_DIRTY_RECTS,
+    GAUGE_REDRAW_FRACTION,
+    GAUGE_AUDIO_CALLBACK_US,
+    GAUGE_AUDIO_VOICES,
+    GAUGE_AUDIO_LIMITED,
+    GAUGE_EFFECTS,
+    GAUGE_EFFECT_BODIES,
+    GAUGE_EFFECT_MS,
+    GAUGE_COUNT
+} ProfileGauge;
+
+// Timing statistics for one section
+typedef struct {
+    double lastMs;   // Most recent sample
+    double avgMs;    // Exponential moving average
+    double maxMs;    // Worst sample since the last report
+} ProfileStat;
+
+// Reset all statistics
+void profiler_init(void);
+
+// Start timing a section
+Uint64 profiler_begin(void);
+
+// Stop timing a section started with profiler_begin, returns elapsed ms
+double profiler_end(ProfileSection section, Uint64 start);
+
+// Record an externally measured sample
+void profiler_record(ProfileSection section, double ms);
+
+// Statistics for a section
+const ProfileStat *profiler_stat(ProfileSection section);
+
+// Set / get a gauge
+void profiler_set_gauge(ProfileGauge gauge, double value);
+double profiler_gauge(ProfileGauge gauge);
+
+// Section and gauge names for reports
+const char *profiler_section_name(ProfileSection section);
+const char *profiler_gauge_name(ProfileGauge gauge);
+
+// Short one-line summary for the window title HUD
+void profiler_format_hud(char *buffer, size_t size);
+
+// Call once per frame. Returns true (and writes a report to the log) once per report interval.
+bool profiler_frame_end(void);
+
+#endif // PROFILER_H
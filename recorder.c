@@ -0,0 +1,169 @@
+#include "recorder.h"
+#include <string.h>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#define write _write
+#define close _close
+#define open _open
+#else
+#include <unistd.h>
+#endif
+
+typedef struct {
+    char level[8];
+    char text[RECORDER_LOG_LENGTH];
+} LogRecord;
+
+static FrameRecord frames[RECORDER_FRAMES];
+static LogRecord logLines[RECORDER_LOG_LINES];
+static volatile Uint32 frameCount;     // Frames recorded so far
+static SDL_atomic_t logCount;          // Log lines claimed so far
+static int crashFd = -1;
+
+void recorder_init(const char *crashLogPath) {
+    memset(frames, 0, sizeof(frames));
+    memset(logLines, 0, sizeof(logLines));
+    frameCount = 0;
+    SDL_AtomicSet(&logCount, 0);
+    crashFd = open(crashLogPath, O_WRONLY | O_CREAT | O_APPEND, 0644);
+}
+
+void recorder_close(void) {
+    if (crashFd >= 0) {
+        close(crashFd);
+        crashFd = -1;
+    }
+}
+
+void recorder_frame(const FrameRecord *record) {
+    frames[frameCount & (RECORDER_FRAMES - 1)] = *record;
+    frameCount++;  // Published after the slot is written
+}
+
+void recorder_log(const char *level, const char *message) {
+    int index = SDL_AtomicAdd(&logCount, 1);
+    LogRecord *line = &logLines[index & (RECORDER_LOG_LINES - 1)];
+    strncpy(line->level, level, sizeof(line->level) - 1);
+    line->level[sizeof(line->level) - 1] = '\0';
+    strncpy(line->text, message, sizeof(line->text) - 1);
+    line->text[sizeof(line->text) - 1] = '\0';
+}
+
+int recorder_crash_fd(void) {
+    return crashFd;
+}
+
+// Minimal formatting for the dump; snprintf is not async-signal-safe
+
+typedef struct {
+    char data[256];
+    int length;
+} DumpLine;
+
+static void appendString(DumpLine *line, const char *text) {
+    while (*text && line->length < (int)sizeof(line->data) - 1) {
+        line->data[line->length++] = *text++;
+    }
+}
+
+static void appendUnsigned(DumpLine *line, unsigned long value) {
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0 && line->length < (int)sizeof(line->data) - 1) {
+        line->data[line->length++] = digits[--count];
+    }
+}
+
+static void appendInt(DumpLine *line, int value) {
+    if (value < 0) {
+        appendString(line, "-");
+        appendUnsigned(line, (unsigned long)(-(long)value));
+    } else {
+        appendUnsigned(line, (unsigned long)value);
+    }
+}
+
+// Fixed point with two decimals
+static void appendFloat(DumpLine *line, float value) {
+    if (value < 0.0f) {
+        appendString(line, "-");
+        value = -value;
+    }
+    unsigned long hundredths = (unsigned long)(value * 100.0f + 0.5f);
+    appendUnsigned(line, hundredths / 100);
+    appendString(line, ".");
+    if (hundredths % 100 < 10) {
+        appendString(line, "0");
+    }
+    appendUnsigned(line, hundredths % 100);
+}
+
+static void flushLine(int fd, DumpLine *line) {
+    appendString(line, "\n");
+    int ignored = (int)write(fd, line->data, line->length);
+    (void)ignored;
+    line->length = 0;
+}
+
+void recorder_dump(int fd) {
+    if (fd < 0) {
+        return;
+    }
+
+    DumpLine line = {{0}, 0};
+    Uint32 total = frameCount;
+    Uint32 first = total > RECORDER_FRAMES ? total - RECORDER_FRAMES : 0;
+
+    appendString(&line, "--- Flight recorder: last ");
+    appendUnsigned(&line, total - first);
+    appendString(&line, " frames ---");
+    flushLine(fd, &line);
+    appendString(&line, "frame,time_ms,tick,frame_ms,step_ms,render_ms,wait_ms,bodies,quality,input");
+    flushLine(fd, &line);
+
+    for (Uint32 i = first; i < total; i++) {
+        const FrameRecord *r = &frames[i & (RECORDER_FRAMES - 1)];
+        appendUnsigned(&line, r->frame);
+        appendString(&line, ",");
+        appendUnsigned(&line, r->timeMs);
+        appendString(&line, ",");
+        appendUnsigned(&line, r->tick);
+        appendString(&line, ",");
+        appendFloat(&line, r->frameMs);
+        appendString(&line, ",");
+        appendFloat(&line, r->stepMs);
+        appendString(&line, ",");
+        appendFloat(&line, r->renderMs);
+        appendString(&line, ",");
+        appendFloat(&line, r->waitMs);
+        appendString(&line, ",");
+        appendInt(&line, r->bodies);
+        appendString(&line, ",");
+        appendInt(&line, r->qualityLevel);
+        appendString(&line, ",");
+        appendInt(&line, r->inputBits);
+        flushLine(fd, &line);
+    }
+
+    int logTotal = SDL_AtomicGet(&logCount);
+    int logFirst = logTotal > RECORDER_LOG_LINES ? logTotal - RECORDER_LOG_LINES : 0;
+    appendString(&line, "--- Last ");
+    appendInt(&line, logTotal - logFirst);
+    appendString(&line, " log lines ---");
+    flushLine(fd, &line);
+
+    for (int i = logFirst; i < logTotal; i++) {
+        const LogRecord *r = &logLines[i & (RECORDER_LOG_LINES - 1)];
+        appendString(&line, r->level);
+        appendString(&line, ": ");
+        appendString(&line, r->text);
+        flushLine(fd, &line);
+    }
+    appendString(&line, "--- End flight recorder ---");
+    flushLine(fd, &line);
+}
@@ -0,0 +1,44 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#define RECORDER_FRAMES 512        // Power of two
+#define RECORDER_LOG_LINES 64      // Power of two
+#define RECORDER_LOG_LENGTH 160
+
+// What one frame did, kept for post-mortem analysis
+typedef struct {
+    Uint32 frame;
+    Uint32 timeMs;                 // SDL_GetTicks at the end of the frame
+    unsigned long tick;            // Simulation tick that was drawn
+    float frameMs;
+    float stepMs;
+    float renderMs;
+    float waitMs;
+    int bodies;
+    int qualityLevel;
+    int inputBits;
+} FrameRecord;
+
+// Flight recorder: preallocated rings of recent frames and log lines that
+// a crash handler can dump with write(2) alone. Recording is a struct copy.
+// Open the crash log now so the handler never has to.
+void recorder_init(const char *crashLogPath);
+void recorder_close(void);
+
+// Main thread, once per frame
+void recorder_frame(const FrameRecord *record);
+
+// Any thread; the line is truncated to RECORDER_LOG_LENGTH
+void recorder_log(const char *level, const char *message);
+
+// Descriptor of the crash log opened by recorder_init, or -1
+int recorder_crash_fd(void);
+
+// Write the recorded frames and log lines to `fd`, oldest first.
+// Async-signal-safe: no allocation, no stdio, no locks.
+void recorder_dump(int fd);
+
+#endif // RECORDER_H
@@ -0,0 +1,451 @@
+#include "render.h"
+#include "alloc.h"
+#include "world.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+bool boxBatchInit(BoxBatch *batch, int capacity, int jointCapacity) {
+    memset(batch, 0, sizeof(*batch));
+
+    int chunks = (capacity + BOX_BATCH_GRAIN - 1) / BOX_BATCH_GRAIN;
+    int quads = capacity > jointCapacity ? capacity : jointCapacity;
+    batch->vertices = allocMalloc(ALLOC_TAG_RENDER, sizeof(SDL_Vertex) * 4 * capacity);
+    batch->jointVertices = jointCapacity > 0 ? allocMalloc(ALLOC_TAG_RENDER, sizeof(SDL_Vertex) * 4 * jointCapacity) : NULL;
+    batch->indices = allocMalloc(ALLOC_TAG_RENDER, sizeof(int) * 6 * quads);
+    batch->visible = allocMalloc(ALLOC_TAG_RENDER, capacity);
+    batch->chunkOffsets = allocCalloc(ALLOC_TAG_RENDER, chunks + 1, sizeof(int));
+    if (!batch->vertices || (jointCapacity > 0 && !batch->jointVertices) || !batch->indices ||
+        !batch->visible || !batch->chunkOffsets) {
+        fprintf(stderr, "Failed to allocate box batch for %d boxes and %d joints\n", capacity, jointCapacity);
+        boxBatchDestroy(batch);
+        return false;
+    }
+    batch->capacity = capacity;
+    batch->jointCapacity = jointCapacity;
+
+    // Two triangles per quad; the pattern never changes so build it once
+    for (int i = 0; i < quads; i++) {
+        int *quad = &batch->indices[i * 6];
+        quad[0] = i * 4;
+        quad[1] = i * 4 + 1;
+        quad[2] = i * 4 + 2;
+        quad[3] = i * 4;
+        quad[4] = i * 4 + 2;
+        quad[5] = i * 4 + 3;
+    }
+    return true;
+}
+
+void boxBatchDestroy(BoxBatch *batch) {
+    allocFree(ALLOC_TAG_RENDER, batch->vertices);
+    allocFree(ALLOC_TAG_RENDER, batch->jointVertices);
+    allocFree(ALLOC_TAG_RENDER, batch->indices);
+    allocFree(ALLOC_TAG_RENDER, batch->visible);
+    allocFree(ALLOC_TAG_RENDER, batch->chunkOffsets);
+    memset(batch, 0, sizeof(*batch));
+}
+
+// Phase 1: mark boxes whose bounding circle touches the window, count per chunk
+static void cullBoxes(void *data, int begin, int end) {
+    BoxBatch *batch = data;
+    const SnapshotBox *boxes = batch->snapshot->boxes;
+    int count = 0;
+
+    for (int i = begin; i < end; i++) {
+        const SnapshotBox *box = &boxes[i];
+        float r = (box->width + box->height) * 0.5f;  // Covers the half diagonal
+        bool visible = box->x + r >= 0.0f && box->x - r <= WINDOW_WIDTH &&
+                       box->y + r >= 0.0f && box->y - r <= WINDOW_HEIGHT;
+        batch->visible[i] = visible;
+        count += visible;
+    }
+    batch->chunkOffsets[begin / BOX_BATCH_GRAIN + 1] = count;
+}
+
+// Phase 2: write the rotated quad of each visible box at the chunk's offset
+static void generateBoxVertices(void *data, int begin, int end) {
+    BoxBatch *batch = data;
+    const SnapshotBox *boxes = batch->snapshot->boxes;
+    SDL_Vertex *out = &batch->vertices[batch->chunkOffsets[begin / BOX_BATCH_GRAIN] * 4];
+
+    for (int i = begin; i < end; i++) {
+        if (!batch->visible[i]) {
+            continue;
+        }
+
+        const SnapshotBox *box = &boxes[i];
+        float c = cosf(box->angle);
+        float s = sinf(box->angle);
+        float hw = box->width / 2.0f;
+        float hh = box->height / 2.0f;
+        const float corners[4][2] = {{-hw, -hh}, {hw, -hh}, {hw, hh}, {-hw, hh}};
+
+        for (int k = 0; k < 4; k++) {
+            out[k].position.x = box->x + corners[k][0] * c - corners[k][1] * s;
+            out[k].position.y = WINDOW_HEIGHT - (box->y + corners[k][0] * s + corners[k][1] * c);
+            out[k].color = box->color;
+            out[k].tex_coord.x = 0.0f;
+            out[k].tex_coord.y = 0.0f;
+        }
+        out += 4;
+    }
+}
+
+// Two-pixel quads along each rope segment. A linkage has far fewer segments
+// than a scene has boxes, so this runs inline rather than as jobs.
+static void buildJointVertices(BoxBatch *batch, const RenderSnapshot *snapshot) {
+    int count = snapshot->jointCount < batch->jointCapacity ? snapshot->jointCount : batch->jointCapacity;
+    SDL_Vertex *out = batch->jointVertices;
+    batch->visibleJoints = 0;
+
+    for (int i = 0; i < count; i++) {
+        const SnapshotJoint *joint = &snapshot->joints[i];
+        float dx = joint->bx - joint->ax;
+        float dy = joint->by - joint->ay;
+        float length = sqrtf(dx * dx + dy * dy);
+        bool visible = fmaxf(joint->ax, joint->bx) >= 0.0f && fminf(joint->ax, joint->bx) <= WINDOW_WIDTH &&
+                       fmaxf(joint->ay, joint->by) >= 0.0f && fminf(joint->ay, joint->by) <= WINDOW_HEIGHT;
+        if (length < 0.01f || !visible) {
+            continue;
+        }
+
+        // Half the width along the segment's normal
+        float nx = -dy / length;
+        float ny = dx / length;
+        const float ends[4][3] = {
+            {joint->ax, joint->ay, 1.0f}, {joint->bx, joint->by, 1.0f},
+            {joint->bx, joint->by, -1.0f}, {joint->ax, joint->ay, -1.0f}
+        };
+        for (int k = 0; k < 4; k++) {
+            out[k].position.x = ends[k][0] + nx * ends[k][2];
+            out[k].position.y = WINDOW_HEIGHT - (ends[k][1] + ny * ends[k][2]);
+            out[k].color = joint->color;
+            out[k].tex_coord.x = 0.0f;
+            out[k].tex_coord.y = 0.0f;
+        }
+        out += 4;
+        batch->visibleJoints++;
+    }
+}
+
+int boxBatchBuild(BoxBatch *batch, JobSystem *jobs, const RenderSnapshot *snapshot) {
+    int count = snapshot->boxCount < batch->capacity ? snapshot->boxCount : batch->capacity;
+    int chunks = (count + BOX_BATCH_GRAIN - 1) / BOX_BATCH_GRAIN;
+    batch->snapshot = snapshot;
+
+    JobCounter culled = {{0}};
+    jobParallelFor(jobs, count, BOX_BATCH_GRAIN, cullBoxes, batch, &culled);
+    jobWait(jobs, &culled);
+
+    // Exclusive prefix sum: chunk c starts after all visible boxes of earlier chunks
+    batch->chunkOffsets[0] = 0;
+    for (int c = 1; c <= chunks; c++) {
+        batch->chunkOffsets[c] += batch->chunkOffsets[c - 1];
+    }
+    batch->visibleCount = batch->chunkOffsets[chunks];
+
+    JobCounter generated = {{0}};
+    jobParallelFor(jobs, count, BOX_BATCH_GRAIN, generateBoxVertices, batch, &generated);
+    buildJointVertices(batch, snapshot);
+    jobWait(jobs, &generated);
+
+    return batch->visibleCount;
+}
+
+// Red cells, more opaque where more contacts were solved in the last step
+static void drawContactHeatmap(SDL_Renderer *renderer, const PhysicsStats *stats) {
+    if (stats->maxHeat == 0) {
+        return;
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    for (int row = 0; row < HEATMAP_ROWS; row++) {
+        for (int col = 0; col < HEATMAP_COLS; col++) {
+            int heat = stats->heat[row][col];
+            if (heat == 0) {
+                continue;
+            }
+            Uint8 alpha = (Uint8)(32 + 160 * heat / stats->maxHeat);
+            SDL_Rect cell = {col * HEATMAP_CELL, row * HEATMAP_CELL, HEATMAP_CELL, HEATMAP_CELL};
+            SDL_SetRenderDrawColor(renderer, 255, 0, 0, alpha);
+            SDL_RenderFillRect(renderer, &cell);
+        }
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
+
+static void drawGround(SDL_Renderer *renderer) {
+    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
+    SDL_Rect groundRect = {
+        0,
+        WINDOW_HEIGHT - GROUND_HEIGHT,
+        WINDOW_WIDTH,
+        GROUND_HEIGHT
+    };
+    SDL_RenderFillRect(renderer, &groundRect);
+}
+
+// Draw player as animated sprite
+static void drawPlayer(SDL_Renderer *renderer, const Sprite *playerSprite, const RenderSnapshot *snapshot) {
+    if (!snapshot->hasPlayer) {
+        return;
+    }
+    int x, y;
+    cpToSDL(cpv(snapshot->playerX, snapshot->playerY), &x, &y);
+
+    if (playerSprite && playerSprite->texture && snapshot->playerHasSprite) {
+        renderSpriteFrame(renderer, playerSprite->texture, &snapshot->playerFrame,
+                          snapshot->playerFacingLeft, x, y);
+    } else {
+        // Fallback to rectangle if sprite failed to load
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+        SDL_Rect boxRect = {
+            x - BOX_SIZE/2,
+            y - BOX_SIZE/2,
+            BOX_SIZE,
+            BOX_SIZE
+        };
+        SDL_RenderFillRect(renderer, &boxRect);
+    }
+}
+
+static void drawOverlays(SDL_Renderer *renderer, const RenderSnapshot *snapshot, int overlays) {
+    // Draw debug visualization if enabled
+    if ((overlays & RENDER_OVERLAY_DEBUG) && snapshot->hasDebug) {
+        debugDrawRender(renderer, &snapshot->debug);
+    }
+
+    if (overlays & RENDER_OVERLAY_HEATMAP) {
+        drawContactHeatmap(renderer, &snapshot->physics);
+    }
+}
+
+void renderSnapshot(SDL_Renderer *renderer, const Sprite *playerSprite, BoxBatch *batch,
+                    JobSystem *jobs, const RenderSnapshot *snapshot,
+                    const ParticleSystem *particles, DynamicResolution *resolution, int overlays) {
+    if (resolution) {
+        resolutionBeginScene(resolution, renderer);
+    }
+
+    // Clear screen
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+
+    drawGround(renderer);
+    drawPlayer(renderer, playerSprite, snapshot);
+
+    // Draw rope segments, then the other boxes, as one batch of quads each
+    int visible = boxBatchBuild(batch, jobs, snapshot);
+    if (batch->visibleJoints > 0) {
+        SDL_RenderGeometry(renderer, NULL, batch->jointVertices, batch->visibleJoints * 4,
+                           batch->indices, batch->visibleJoints * 6);
+    }
+    if (visible > 0) {
+        SDL_RenderGeometry(renderer, NULL, batch->vertices, visible * 4,
+                           batch->indices, visible * 6);
+    }
+
+    if (particles) {
+        particleSystemRender(particles, renderer);
+    }
+
+    if (resolution) {
+        resolutionEndScene(resolution, renderer);
+    }
+
+    drawOverlays(renderer, snapshot, overlays);
+}
+
+bool dirtyRedrawInit(DirtyRedraw *dirty, int width, int height, int vertexCapacity) {
+    memset(dirty, 0, sizeof(*dirty));
+    if (!damageInit(&dirty->damage, width, height)) {
+        return false;
+    }
+    dirty->scratch = allocMalloc(ALLOC_TAG_RENDER, sizeof(SDL_Vertex) * vertexCapacity);
+    if (!dirty->scratch) {
+        fprintf(stderr, "Failed to allocate %d dirty redraw vertices\n", vertexCapacity);
+        dirtyRedrawDestroy(dirty);
+        return false;
+    }
+    dirty->scratchCapacity = vertexCapacity;
+    return true;
+}
+
+void dirtyRedrawDestroy(DirtyRedraw *dirty) {
+    damageDestroy(&dirty->damage);
+    allocFree(ALLOC_TAG_RENDER, dirty->scratch);
+    memset(dirty, 0, sizeof(*dirty));
+}
+
+// Copy the shapes whose bounds touch `rect` into `out`, up to `capacity` vertices
+static int gatherShapes(const SDL_Vertex *vertices, int shapes, int verticesPerShape,
+                        const SDL_Rect *rect, SDL_Vertex *out, int capacity) {
+    float left = (float)rect->x - 1.0f, right = (float)(rect->x + rect->w) + 1.0f;
+    float top = (float)rect->y - 1.0f, bottom = (float)(rect->y + rect->h) + 1.0f;
+    int gathered = 0;
+
+    for (int s = 0; s < shapes && (gathered + 1) * verticesPerShape <= capacity; s++) {
+        const SDL_Vertex *shape = &vertices[s * verticesPerShape];
+        float minX = shape[0].position.x, maxX = minX;
+        float minY = shape[0].position.y, maxY = minY;
+        for (int v = 1; v < verticesPerShape; v++) {
+            minX = shape[v].position.x < minX ? shape[v].position.x : minX;
+            maxX = shape[v].position.x > maxX ? shape[v].position.x : maxX;
+            minY = shape[v].position.y < minY ? shape[v].position.y : minY;
+            maxY = shape[v].position.y > maxY ? shape[v].position.y : maxY;
+        }
+        if (maxX < left || minX > right || maxY < top || minY > bottom) {
+            continue;
+        }
+        memcpy(&out[gathered * verticesPerShape], shape, sizeof(SDL_Vertex) * verticesPerShape);
+        gathered++;
+    }
+    return gathered;
+}
+
+int renderSnapshotDirty(SDL_Renderer *renderer, const Sprite *playerSprite, BoxBatch *batch,
+                        JobSystem *jobs, const RenderSnapshot *snapshot,
+                        const ParticleSystem *particles, DirtyRedraw *dirty, int overlays) {
+    DamageTracker *damage = &dirty->damage;
+    int visible = boxBatchBuild(batch, jobs, snapshot);
+    int particleShapes = particles ? particles->vertexCount / 3 : 0;
+
+    // Hash everything in draw order; the ground never changes
+    damageBegin(damage);
+    if (snapshot->hasPlayer) {
+        int x, y;
+        cpToSDL(cpv(snapshot->playerX, snapshot->playerY), &x, &y);
+        // Covers both the sprite (2x body, feet at the body's bottom) and the fallback box
+        SDL_Rect bounds = {x - BOX_SIZE, y - 2 * BOX_SIZE + BOX_SIZE / 2, 2 * BOX_SIZE, 2 * BOX_SIZE};
+        Uint32 key = (Uint32)x * 73856093u ^ (Uint32)y * 19349663u ^
+                     (Uint32)snapshot->playerFrame.x * 83492791u ^ (Uint32)snapshot->playerFrame.y ^
+                     (snapshot->playerFacingLeft ? 1u : 0u) << 31 ^ (snapshot->playerHasSprite ? 1u : 0u) << 30;
+        damageAddRect(damage, &bounds, key);
+    }
+    damageAddGeometry(damage, batch->jointVertices, batch->visibleJoints, 4);
+    damageAddGeometry(damage, batch->vertices, visible, 4);
+    if (particles) {
+        damageAddGeometry(damage, particles->vertices, particleShapes, 3);
+    }
+
+    // Overlays are drawn over everything, so they and the frame after them are full redraws
+    bool forceFull = overlays != 0 || dirty->lastOverlays != 0;
+    dirty->lastOverlays = overlays;
+    int rects = damageEnd(damage, forceFull);
+
+    for (int i = 0; i < rects; i++) {
+        const SDL_Rect *rect = &damage->rects[i];
+        SDL_RenderSetClipRect(renderer, damage->full ? NULL : rect);
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderFillRect(renderer, rect);
+        drawGround(renderer);
+        drawPlayer(renderer, playerSprite, snapshot);
+
+        // Only submit what can touch this rect; the rasterizer would reject the rest one triangle at a time
+        const SDL_Vertex *jointVertices = batch->jointVertices;
+        int joints = batch->visibleJoints;
+        if (!damage->full) {
+            joints = gatherShapes(batch->jointVertices, joints, 4, rect, dirty->scratch, dirty->scratchCapacity);
+            jointVertices = dirty->scratch;
+        }
+        if (joints > 0) {
+            SDL_RenderGeometry(renderer, NULL, jointVertices, joints * 4, batch->indices, joints * 6);
+        }
+
+        const SDL_Vertex *boxVertices = batch->vertices;
+        int boxes = visible;
+        if (!damage->full) {
+            boxes = gatherShapes(batch->vertices, visible, 4, rect, dirty->scratch, dirty->scratchCapacity);
+            boxVertices = dirty->scratch;
+        }
+        if (boxes > 0) {
+            SDL_RenderGeometry(renderer, NULL, boxVertices, boxes * 4, batch->indices, boxes * 6);
+        }
+
+        if (particleShapes > 0) {
+            const SDL_Vertex *particleVertices = particles->vertices;
+            int shapes = particleShapes;
+            if (!damage->full) {
+                shapes = gatherShapes(particles->vertices, particleShapes, 3, rect,
+                                      dirty->scratch, dirty->scratchCapacity);
+                particleVertices = dirty->scratch;
+            }
+            if (shapes > 0) {
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                SDL_RenderGeometry(renderer, NULL, particleVertices, shapes * 3, NULL, 0);
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+            }
+        }
+    }
+    SDL_RenderSetClipRect(renderer, NULL);
+
+    drawOverlays(renderer, snapshot, overlays);
+    return rects;
+}
+
+void runJobsBenchmark(int boxCount, FILE *out) {
+    RenderSnapshot snapshot = {0};
+    snapshot.boxes = malloc(sizeof(SnapshotBox) * boxCount);
+    BoxBatch batch;
+    if (!snapshot.boxes || !boxBatchInit(&batch, boxCount, 0)) {
+        free(snapshot.boxes);
+        return;
+    }
+
+    // Boxes spread over and around the window so culling has work to do
+    srand(1);
+    for (int i = 0; i < boxCount; i++) {
+        SnapshotBox *box = &snapshot.boxes[i];
+        box->x = (float)(rand() % (WINDOW_WIDTH * 2)) - WINDOW_WIDTH / 2;
+        box->y = (float)(rand() % (WINDOW_HEIGHT * 2)) - WINDOW_HEIGHT / 2;
+        box->angle = (float)(rand() % 628) / 100.0f;
+        box->width = box->height = 20.0f;
+        box->color = (SDL_Color){255, 100, 100, 255};
+    }
+    snapshot.boxCount = boxCount;
+    snapshot.capacity = boxCount;
+
+    const int warmup = 10;
+    const int iterations = 200;
+    double baseline = 0.0;
+    int maxWorkers = SDL_GetCPUCount();
+    if (maxWorkers > JOB_MAX_WORKERS) {
+        maxWorkers = JOB_MAX_WORKERS;
+    }
+
+    fprintf(out, "workers,boxes,visible,build_ms,speedup,stolen\n");
+    for (int workers = 1; ; workers = workers * 2 < maxWorkers ? workers * 2 : maxWorkers) {
+        JobSystem jobs;
+        if (!jobSystemInit(&jobs, workers)) {
+            break;
+        }
+
+        for (int i = 0; i < warmup; i++) {
+            boxBatchBuild(&batch, &jobs, &snapshot);
+        }
+        SDL_AtomicSet(&jobs.stolen, 0);
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < iterations; i++) {
+            boxBatchBuild(&batch, &jobs, &snapshot);
+        }
+        double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 /
+                    SDL_GetPerformanceFrequency() / iterations;
+        if (workers == 1) {
+            baseline = ms;
+        }
+
+        fprintf(out, "%d,%d,%d,%.4f,%.2f,%d\n", jobs.workerCount, boxCount, batch.visibleCount,
+                ms, ms > 0.0 ? baseline / ms : 0.0, SDL_AtomicGet(&jobs.stolen));
+        fflush(out);
+        jobSystemDestroy(&jobs);
+
+        if (workers >= maxWorkers) {
+            break;
+        }
+    }
+
+    boxBatchDestroy(&batch);
+    free(snapshot.boxes);
+}
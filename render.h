@@ -0,0 +1,78 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "sprite.h"
+#include "snapshot.h"
+#include "jobs.h"
+#include "particles.h"
+#include "resolution.h"
+#include "damage.h"
+
+// Optional overlays drawn over the scene
+typedef enum {
+    RENDER_OVERLAY_DEBUG   = 1 << 0,   // Physics debug geometry (F1)
+    RENDER_OVERLAY_HEATMAP = 1 << 1    // Contact density per cell (F3)
+} RenderOverlay;
+
+#define BOX_BATCH_GRAIN 512        // Boxes per culling / vertex generation job
+
+// Vertex buffers for drawing every box, and every rope segment, with one
+// SDL_RenderGeometry call each.
+// Built in two job phases: cull, then (after a prefix sum over chunk counts)
+// generate vertices. Each chunk writes its own range, so the output order is
+// the snapshot order no matter how many workers run.
+typedef struct {
+    SDL_Vertex *vertices;          // 4 per visible box
+    SDL_Vertex *jointVertices;     // 4 per visible rope segment, drawn behind the boxes
+    int *indices;                  // 6 per quad, fixed pattern built once; shared by boxes and joints
+    unsigned char *visible;        // Per box culling result
+    int *chunkOffsets;             // Visible boxes before each chunk
+    int capacity;                  // Boxes
+    int jointCapacity;             // Rope segments
+    int visibleCount;
+    int visibleJoints;
+    const RenderSnapshot *snapshot;
+} BoxBatch;
+
+// Joints can outnumber boxes; size `jointCapacity` from the world's maxJoints
+bool boxBatchInit(BoxBatch *batch, int capacity, int jointCapacity);
+void boxBatchDestroy(BoxBatch *batch);
+
+// Cull and generate vertices for all boxes and joints in the snapshot. Returns visible boxes.
+int boxBatchBuild(BoxBatch *batch, JobSystem *jobs, const RenderSnapshot *snapshot);
+
+// Draw ground, boxes, the player, built particles (may be NULL) and RenderOverlay
+// bits from a snapshot. Only reads the snapshot and the sprite texture, never the
+// physics space. With a resolution scaler (may be NULL) the scene is drawn at its
+// current scale and upscaled; overlays are always drawn at native resolution.
+void renderSnapshot(SDL_Renderer *renderer, const Sprite *playerSprite, BoxBatch *batch,
+                    JobSystem *jobs, const RenderSnapshot *snapshot,
+                    const ParticleSystem *particles, DynamicResolution *resolution, int overlays);
+
+// Persistent-framebuffer state for redrawing only damaged regions
+typedef struct {
+    DamageTracker damage;
+    SDL_Vertex *scratch;           // Shapes touching one damaged rect
+    int scratchCapacity;           // Vertices
+    int lastOverlays;
+} DirtyRedraw;
+
+// `vertexCapacity` must cover the largest of 4 per box, 4 per joint and 3 per particle
+bool dirtyRedrawInit(DirtyRedraw *dirty, int width, int height, int vertexCapacity);
+void dirtyRedrawDestroy(DirtyRedraw *dirty);
+
+// Like renderSnapshot, but into a target that keeps last frame's pixels (a
+// software renderer on the window surface). Only tiles whose content changed
+// are cleared and redrawn, clipped. Returns the number of rects in
+// dirty->damage.rects that need presenting.
+int renderSnapshotDirty(SDL_Renderer *renderer, const Sprite *playerSprite, BoxBatch *batch,
+                        JobSystem *jobs, const RenderSnapshot *snapshot,
+                        const ParticleSystem *particles, DirtyRedraw *dirty, int overlays);
+
+// Time box batch building for 1..N workers and write CSV to `out`
+void runJobsBenchmark(int boxCount, FILE *out);
+
+#endif // RENDER_H
@@ -0,0 +1,144 @@
+#include "resolution.h"
+#include "logging.h"
+#include <math.h>
+#include <string.h>
+
+// Same shape as the physics governor's hysteresis
+#define RESOLUTION_SMOOTHING 0.2
+#define RESOLUTION_DOWNGRADE_RATIO 0.90
+#define RESOLUTION_UPGRADE_RATIO 0.50   // One step up adds ~30% pixels at 0.75, so leave room
+#define RESOLUTION_TARGET_RATIO 0.75    // Where a downgrade aims
+#define RESOLUTION_DOWNGRADE_FRAMES 10
+#define RESOLUTION_UPGRADE_FRAMES 90
+#define RESOLUTION_COOLDOWN_FRAMES 30
+
+bool parseResolutionFilter(const char *name, ResolutionFilter *filter) {
+    if (strcmp(name, "nearest") == 0) {
+        *filter = RESOLUTION_FILTER_NEAREST;
+    } else if (strcmp(name, "linear") == 0) {
+        *filter = RESOLUTION_FILTER_LINEAR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static double quantizeScale(const DynamicResolution *resolution, double scale) {
+    scale = floor(scale / RESOLUTION_SCALE_STEP) * RESOLUTION_SCALE_STEP;
+    if (scale < resolution->minScale) scale = resolution->minScale;
+    if (scale > 1.0) scale = 1.0;
+    return scale;
+}
+
+bool resolutionInit(DynamicResolution *resolution, SDL_Renderer *renderer, double frameBudgetMs,
+                    double minScale, ResolutionFilter filter) {
+    memset(resolution, 0, sizeof(*resolution));
+    resolution->scale = 1.0;
+    resolution->filter = filter;
+    resolution->budgetMs = frameBudgetMs * RESOLUTION_RENDER_SHARE;
+    double lowest = ceil(minScale / RESOLUTION_SCALE_STEP) * RESOLUTION_SCALE_STEP;
+    resolution->minScale = lowest < RESOLUTION_MIN_SCALE ? RESOLUTION_MIN_SCALE : lowest > 1.0 ? 1.0 : lowest;
+
+    if (!SDL_RenderTargetSupported(renderer)) {
+        LOG_WARNING("Renderer has no render targets, dynamic resolution disabled");
+        return false;
+    }
+    if (SDL_GetRendererOutputSize(renderer, &resolution->width, &resolution->height) != 0) {
+        LOG_ERROR("Failed to get renderer size for dynamic resolution: %s", SDL_GetError());
+        return false;
+    }
+    resolution->target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                           resolution->width, resolution->height);
+    if (!resolution->target) {
+        LOG_ERROR("Failed to create dynamic resolution target: %s", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureScaleMode(resolution->target, filter == RESOLUTION_FILTER_LINEAR ?
+                                                SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+
+    resolution->enabled = true;
+    LOG_INFO("Dynamic resolution: %dx%d, scale %.3f..1, %s filter, render budget %.2f ms",
+             resolution->width, resolution->height, resolution->minScale,
+             filter == RESOLUTION_FILTER_LINEAR ? "linear" : "nearest", resolution->budgetMs);
+    return true;
+}
+
+void resolutionDestroy(DynamicResolution *resolution) {
+    if (resolution->target) {
+        SDL_DestroyTexture(resolution->target);
+    }
+    if (resolution->changes > 0) {
+        LOG_INFO("Dynamic resolution: %d scale changes, final scale %.3f", resolution->changes, resolution->scale);
+    }
+    memset(resolution, 0, sizeof(*resolution));
+}
+
+void resolutionBeginScene(DynamicResolution *resolution, SDL_Renderer *renderer) {
+    if (!resolution->enabled || resolution->scale >= 1.0) {
+        return;
+    }
+    SDL_SetRenderTarget(renderer, resolution->target);
+    // Setting a target resets the scale, so this must come after
+    SDL_RenderSetScale(renderer, (float)resolution->scale, (float)resolution->scale);
+}
+
+void resolutionEndScene(DynamicResolution *resolution, SDL_Renderer *renderer) {
+    if (!resolution->enabled || resolution->scale >= 1.0) {
+        return;
+    }
+    SDL_SetRenderTarget(renderer, NULL);
+    SDL_Rect scene = {
+        0, 0,
+        (int)lround(resolution->width * resolution->scale),
+        (int)lround(resolution->height * resolution->scale)
+    };
+    SDL_RenderCopy(renderer, resolution->target, &scene, NULL);
+}
+
+static void changeScale(DynamicResolution *resolution, double scale, const char *reason) {
+    scale = quantizeScale(resolution, scale);
+    if (scale == resolution->scale) {
+        return;
+    }
+    LOG_INFO("Dynamic resolution: scale %.3f -> %.3f (%s), render %.2f ms of %.2f ms budget",
+             resolution->scale, scale, reason, resolution->renderMs, resolution->budgetMs);
+    resolution->scale = scale;
+    resolution->changes++;
+    resolution->overBudgetFrames = 0;
+    resolution->underBudgetFrames = 0;
+    resolution->cooldownFrames = RESOLUTION_COOLDOWN_FRAMES;
+}
+
+bool resolutionUpdate(DynamicResolution *resolution, double renderMs) {
+    resolution->renderMs = (resolution->renderMs == 0.0) ? renderMs
+                         : resolution->renderMs + (renderMs - resolution->renderMs) * RESOLUTION_SMOOTHING;
+    if (!resolution->enabled) {
+        return false;
+    }
+    if (resolution->cooldownFrames > 0) {
+        resolution->cooldownFrames--;
+        return false;
+    }
+
+    double previous = resolution->scale;
+    if (resolution->renderMs > resolution->budgetMs * RESOLUTION_DOWNGRADE_RATIO) {
+        resolution->underBudgetFrames = 0;
+        if (++resolution->overBudgetFrames >= RESOLUTION_DOWNGRADE_FRAMES) {
+            // Fill cost goes with area, so the side scales with the square root
+            double fit = resolution->scale * sqrt(resolution->budgetMs * RESOLUTION_TARGET_RATIO / resolution->renderMs);
+            if (fit > resolution->scale - RESOLUTION_SCALE_STEP) {
+                fit = resolution->scale - RESOLUTION_SCALE_STEP;
+            }
+            changeScale(resolution, fit, "over budget");
+        }
+    } else if (resolution->scale < 1.0 && resolution->renderMs < resolution->budgetMs * RESOLUTION_UPGRADE_RATIO) {
+        resolution->overBudgetFrames = 0;
+        if (++resolution->underBudgetFrames >= RESOLUTION_UPGRADE_FRAMES) {
+            changeScale(resolution, resolution->scale + RESOLUTION_SCALE_STEP, "headroom");
+        }
+    } else {
+        resolution->overBudgetFrames = 0;
+        resolution->underBudgetFrames = 0;
+    }
+    return resolution->scale != previous;
+}
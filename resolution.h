@@ -0,0 +1,56 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#define RESOLUTION_SCALE_STEP 0.125     // Scales are multiples of this, so scene sizes are whole pixels
+#define RESOLUTION_MIN_SCALE 0.25
+#define RESOLUTION_DEFAULT_MIN_SCALE 0.5
+#define RESOLUTION_RENDER_SHARE 0.5     // Share of the frame budget the scene may use for rendering
+
+// How the scene is stretched to the window
+typedef enum {
+    RESOLUTION_FILTER_NEAREST,
+    RESOLUTION_FILTER_LINEAR
+} ResolutionFilter;
+
+// Dynamic internal resolution. The scene is drawn into the top-left
+// scale * window of an offscreen target, then stretched to the window.
+// The scale follows smoothed render time with the same hysteresis as the
+// physics governor: down quickly (straight to the scale predicted to fit,
+// since fill cost goes with pixel count), up one step after a quiet period.
+typedef struct {
+    bool enabled;
+    SDL_Texture *target;        // Window sized, allocated once
+    int width, height;          // Window size in pixels
+    ResolutionFilter filter;
+    double budgetMs;            // Render time to stay under
+    double minScale;
+    double scale;               // Current scale, 1 = native
+    double renderMs;            // Smoothed render time
+    int overBudgetFrames;
+    int underBudgetFrames;
+    int cooldownFrames;
+    int changes;
+} DynamicResolution;
+
+// Parse "nearest" or "linear"
+bool parseResolutionFilter(const char *name, ResolutionFilter *filter);
+
+// Create the offscreen target. On failure (e.g. no render target support)
+// the scaler stays disabled and the scene is drawn at native resolution.
+bool resolutionInit(DynamicResolution *resolution, SDL_Renderer *renderer, double frameBudgetMs,
+                    double minScale, ResolutionFilter filter);
+void resolutionDestroy(DynamicResolution *resolution);
+
+// Redirect drawing into the scaled target. Scene code keeps using window coordinates.
+void resolutionBeginScene(DynamicResolution *resolution, SDL_Renderer *renderer);
+
+// Return to the window and stretch the scene over it. Overlays drawn afterwards are native.
+void resolutionEndScene(DynamicResolution *resolution, SDL_Renderer *renderer);
+
+// Feed one frame's render time. Returns true when the scale changed.
+bool resolutionUpdate(DynamicResolution *resolution, double renderMs);
+
+#endif // RESOLUTION_H
@@ -0,0 +1,366 @@
+#include "scenario.h"
+#include "linkage.h"
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SWEEP_DT (1.0 / 60.0)
+#define SWEEP_SETTLE_STEPS 180   // 3 seconds to let the scenario come to rest
+#define SWEEP_MEASURE_STEPS 120  // 2 seconds of measurement
+
+// A run counts as stable when nothing sinks, shakes or slides past these limits
+#define STABLE_MAX_PENETRATION 2.0
+#define STABLE_MAX_JITTER 2.0
+#define STABLE_MAX_DRIFT 5.0
+
+// Ropes and swings are meant to keep moving, so jointed scenarios are judged on
+// how well the joints hold instead of jitter and drift
+#define STABLE_MAX_JOINT_ERROR 2.0
+
+static const char *scenarioNames[SCENARIO_COUNT] = {
+    "none", "pyramid", "stack", "rain", "pile", "mixed", "rope", "chain", "bridge", "swing"
+};
+
+// Solver grid explored by the sweep
+static const int sweepIterations[] = {2, 5, 10, 20};
+static const cpFloat sweepDamping[] = {1.0, 0.9};
+static const cpFloat sweepSleep[] = {INFINITY, 0.5};
+static const int sweepCounts[] = {50, 100, 200};
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+// Small deterministic generator so scenarios are reproducible from a seed
+static unsigned int nextRandom(unsigned int *state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7fff;
+}
+
+static cpFloat randomRange(unsigned int *state, cpFloat min, cpFloat max) {
+    return min + (max - min) * (nextRandom(state) / 32767.0);
+}
+
+const char *scenarioName(ScenarioType type) {
+    if (type < 0 || type >= SCENARIO_COUNT) {
+        return "unknown";
+    }
+    return scenarioNames[type];
+}
+
+ScenarioType scenarioFromName(const char *name) {
+    for (int i = SCENARIO_NONE + 1; i < SCENARIO_COUNT; i++) {
+        if (strcmp(name, scenarioNames[i]) == 0) {
+            return (ScenarioType)i;
+        }
+    }
+    return SCENARIO_NONE;
+}
+
+bool scenarioHasJoints(ScenarioType type) {
+    return type == SCENARIO_ROPE || type == SCENARIO_CHAIN || type == SCENARIO_BRIDGE || type == SCENARIO_SWING;
+}
+
+int scenarioDefaultCount(ScenarioType type) {
+    switch (type) {
+        case SCENARIO_PYRAMID: return 55;   // 10 box base
+        case SCENARIO_STACK:   return 60;
+        case SCENARIO_RAIN:    return 150;
+        case SCENARIO_PILE:    return 120;
+        case SCENARIO_MIXED:   return 60;
+        case SCENARIO_ROPE:    return 40;
+        case SCENARIO_CHAIN:   return 40;
+        case SCENARIO_BRIDGE:  return 24;
+        case SCENARIO_SWING:   return 25;   // Two ropes of 12 links and the platform
+        default:               return 0;
+    }
+}
+
+// Pyramid with the widest base that fits bodyCount boxes
+static int spawnPyramid(World *world, int bodyCount) {
+    int base = 1;
+    while ((base + 1) * (base + 2) / 2 <= bodyCount) {
+        base++;
+    }
+
+    cpFloat size = fmin(BOX_SIZE, (WINDOW_WIDTH - 100.0) / base);
+    int spawned = 0;
+    for (int row = 0; row < base; row++) {
+        int boxesInRow = base - row;
+        cpFloat startX = WINDOW_WIDTH / 2.0 - (boxesInRow - 1) * size / 2.0;
+        cpFloat y = GROUND_HEIGHT + size / 2.0 + row * size;
+        for (int i = 0; i < boxesInRow; i++) {
+            if (!spawnBox(world, cpv(startX + i * size, y), size, size)) {
+                return spawned;
+            }
+            spawned++;
+        }
+    }
+    return spawned;
+}
+
+// Several tall single-box columns
+static int spawnStacks(World *world, int bodyCount) {
+    const cpFloat size = 25.0;
+    const int maxColumns = (int)((WINDOW_WIDTH - 100) / (size * 2));
+    int height = 20;
+    if ((bodyCount + height - 1) / height > maxColumns) {
+        height = (bodyCount + maxColumns - 1) / maxColumns;
+    }
+    int columns = (bodyCount + height - 1) / height;
+
+    cpFloat startX = WINDOW_WIDTH / 2.0 - (columns - 1) * size;
+    int spawned = 0;
+    for (int c = 0; c < columns && spawned < bodyCount; c++) {
+        for (int r = 0; r < height && spawned < bodyCount; r++) {
+            cpVect pos = cpv(startX + c * size * 2, GROUND_HEIGHT + size / 2.0 + r * size);
+            if (!spawnBox(world, pos, size, size)) {
+                return spawned;
+            }
+            spawned++;
+        }
+    }
+    return spawned;
+}
+
+// Small boxes dropped from above the window in staggered rows
+static int spawnRain(World *world, int bodyCount, unsigned int *rng) {
+    const cpFloat size = 20.0;
+    const cpFloat spacing = size * 1.5;
+    const int perRow = (int)((WINDOW_WIDTH - 40) / spacing);
+
+    int spawned = 0;
+    for (int i = 0; i < bodyCount; i++) {
+        cpFloat x = 20 + (i % perRow) * spacing + randomRange(rng, 0, size / 2);
+        cpFloat y = WINDOW_HEIGHT + (i / perRow) * spacing;
+        if (!spawnBox(world, cpv(x, y), size, size)) {
+            break;
+        }
+        spawned++;
+    }
+    return spawned;
+}
+
+// Tightly packed, slightly overlapping boxes the solver has to push apart
+static int spawnPile(World *world, int bodyCount) {
+    const cpFloat size = 30.0;
+    const cpFloat spacing = size * 0.95;
+    const int columns = 8;
+
+    cpFloat startX = WINDOW_WIDTH / 2.0 - (columns - 1) * spacing / 2.0;
+    int spawned = 0;
+    for (int i = 0; i < bodyCount; i++) {
+        cpVect pos = cpv(startX + (i % columns) * spacing,
+                         GROUND_HEIGHT + size / 2.0 + (i / columns) * spacing);
+        if (!spawnBox(world, pos, size, size)) {
+            break;
+        }
+        spawned++;
+    }
+    return spawned;
+}
+
+// Random box sizes dropped on a grid
+static int spawnMixed(World *world, int bodyCount, unsigned int *rng) {
+    const cpFloat cell = 90.0;
+    const int perRow = (int)((WINDOW_WIDTH - 40) / cell);
+
+    int spawned = 0;
+    for (int i = 0; i < bodyCount; i++) {
+        cpFloat width = randomRange(rng, 15, 80);
+        cpFloat height = randomRange(rng, 15, 80);
+        cpVect pos = cpv(20 + cell / 2 + (i % perRow) * cell,
+                         GROUND_HEIGHT + cell / 2 + (i / perRow) * cell);
+        if (!spawnBox(world, pos, width, height)) {
+            break;
+        }
+        spawned++;
+    }
+    return spawned;
+}
+
+// One linkage with every body as a link. Links get shorter as the count grows
+// so the linkage always fits the window: more links means a longer chain of
+// joints for the solver, not a longer structure.
+static int spawnJointed(World *world, ScenarioType type, int bodyCount) {
+    const cpFloat span = WINDOW_WIDTH - 120.0;
+    switch (type) {
+        case SCENARIO_ROPE:
+            return spawnLinkage(world, LINKAGE_ROPE, cpv(60, WINDOW_HEIGHT - 40), bodyCount,
+                                fmin(16.0, span / bodyCount));
+        case SCENARIO_CHAIN:
+            return spawnLinkage(world, LINKAGE_CHAIN, cpv(60, WINDOW_HEIGHT - 40), bodyCount,
+                                fmin(18.0, span / bodyCount));
+        case SCENARIO_BRIDGE:
+            return spawnLinkage(world, LINKAGE_BRIDGE, cpv(60, WINDOW_HEIGHT * 0.6), bodyCount,
+                                fmin(30.0, span / bodyCount));
+        case SCENARIO_SWING: {
+            int links = bodyCount > 2 ? (bodyCount - 1) / 2 : 1;
+            return spawnLinkage(world, LINKAGE_SWING, cpv(WINDOW_WIDTH / 2, WINDOW_HEIGHT - 40), links,
+                                fmin(14.0, (WINDOW_HEIGHT - 200.0) / (links + 1)));
+        }
+        default:
+            return 0;
+    }
+}
+
+int spawnScenario(World *world, ScenarioType type, int bodyCount, unsigned int seed) {
+    unsigned int rng = seed;
+    if (bodyCount <= 0) {
+        bodyCount = scenarioDefaultCount(type);
+    }
+
+    switch (type) {
+        case SCENARIO_PYRAMID: return spawnPyramid(world, bodyCount);
+        case SCENARIO_STACK:   return spawnStacks(world, bodyCount);
+        case SCENARIO_RAIN:    return spawnRain(world, bodyCount, &rng);
+        case SCENARIO_PILE:    return spawnPile(world, bodyCount);
+        case SCENARIO_MIXED:   return spawnMixed(world, bodyCount, &rng);
+        case SCENARIO_ROPE:
+        case SCENARIO_CHAIN:
+        case SCENARIO_BRIDGE:
+        case SCENARIO_SWING:   return spawnJointed(world, type, bodyCount);
+        default:               return 0;
+    }
+}
+
+void applySolverSettings(cpSpace *space, const SolverSettings *settings) {
+    cpSpaceSetIterations(space, settings->iterations);
+    cpSpaceSetDamping(space, settings->damping);
+    cpSpaceSetSleepTimeThreshold(space, settings->sleepThreshold);
+}
+
+static void deepestContact(cpBody *body, cpArbiter *arb, void *data) {
+    (void)body;
+    double *maxPenetration = data;
+    cpContactPointSet set = cpArbiterGetContactPointSet(arb);
+    for (int i = 0; i < set.count; i++) {
+        double depth = -set.points[i].distance;
+        if (depth > *maxPenetration) {
+            *maxPenetration = depth;
+        }
+    }
+}
+
+bool measureScenario(ScenarioType type, const SolverSettings *settings, unsigned int seed, ScenarioMetrics *metrics) {
+    memset(metrics, 0, sizeof(*metrics));
+
+    World world;
+    if (!createWorld(&world, settings->bodyCount)) {
+        return false;
+    }
+    applySolverSettings(world.space, settings);
+    metrics->bodies = spawnScenario(&world, type, settings->bodyCount, seed);
+    metrics->joints = world.jointCount;
+
+    cpVect *startPositions = malloc(sizeof(cpVect) * (world.boxCount > 0 ? world.boxCount : 1));
+    if (!startPositions) {
+        destroyWorld(&world);
+        return false;
+    }
+
+    Uint64 stepTicks = 0;
+    double speedSum = 0.0;
+    for (int step = 0; step < SWEEP_SETTLE_STEPS + SWEEP_MEASURE_STEPS; step++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        cpSpaceStep(world.space, SWEEP_DT);
+        stepTicks += SDL_GetPerformanceCounter() - start;
+
+        if (step == SWEEP_SETTLE_STEPS - 1) {
+            for (int i = 0; i < world.boxCount; i++) {
+                startPositions[i] = cpBodyGetPosition(world.boxes[i].body);
+            }
+        } else if (step >= SWEEP_SETTLE_STEPS) {
+            double frameSpeed = 0.0;
+            for (int i = 0; i < world.boxCount; i++) {
+                cpBody *body = world.boxes[i].body;
+                cpVect v = cpBodyGetVelocity(body);
+                frameSpeed += sqrt(v.x * v.x + v.y * v.y);
+                cpBodyEachArbiter(body, deepestContact, &metrics->maxPenetration);
+            }
+            if (world.boxCount > 0) {
+                speedSum += frameSpeed / world.boxCount;
+            }
+            double jointError = linkageMaxError(&world);
+            if (jointError > metrics->jointError) {
+                metrics->jointError = jointError;
+            }
+        }
+    }
+
+    for (int i = 0; i < world.boxCount; i++) {
+        cpBody *body = world.boxes[i].body;
+        double d = cpvdist(cpBodyGetPosition(body), startPositions[i]);
+        if (d > metrics->drift) {
+            metrics->drift = d;
+        }
+        metrics->kineticEnergy += cpBodyKineticEnergy(body);
+    }
+
+    double steps = SWEEP_SETTLE_STEPS + SWEEP_MEASURE_STEPS;
+    metrics->stepMicros = (double)stepTicks * 1000000.0 / SDL_GetPerformanceFrequency() / steps;
+    metrics->jitter = speedSum / SWEEP_MEASURE_STEPS;
+    if (scenarioHasJoints(type)) {
+        metrics->stable = metrics->maxPenetration < STABLE_MAX_PENETRATION &&
+                          metrics->jointError < STABLE_MAX_JOINT_ERROR;
+    } else {
+        metrics->stable = metrics->maxPenetration < STABLE_MAX_PENETRATION &&
+                          metrics->jitter < STABLE_MAX_JITTER &&
+                          metrics->drift < STABLE_MAX_DRIFT;
+    }
+
+    free(startPositions);
+    destroyWorld(&world);
+    return true;
+}
+
+void runScenarioSweep(ScenarioType only, unsigned int seed, FILE *out) {
+    fprintf(out, "scenario,bodies,joints,iterations,damping,sleep,step_us,max_penetration,jitter,energy,drift,"
+                 "joint_error,stable\n");
+
+    for (int type = SCENARIO_NONE + 1; type < SCENARIO_COUNT; type++) {
+        if (only != SCENARIO_NONE && type != (int)only) {
+            continue;
+        }
+
+        for (int c = 0; c < COUNT_OF(sweepCounts); c++) {
+            SolverSettings best = {0};
+            double bestCost = INFINITY;
+
+            for (int it = 0; it < COUNT_OF(sweepIterations); it++) {
+                for (int d = 0; d < COUNT_OF(sweepDamping); d++) {
+                    for (int s = 0; s < COUNT_OF(sweepSleep); s++) {
+                        SolverSettings settings = {
+                            sweepIterations[it], sweepDamping[d], sweepSleep[s], sweepCounts[c]
+                        };
+                        ScenarioMetrics m;
+                        if (!measureScenario((ScenarioType)type, &settings, seed, &m)) {
+                            fprintf(stderr, "Scenario %s failed to build\n", scenarioName(type));
+                            continue;
+                        }
+
+                        fprintf(out, "%s,%d,%d,%d,%.2f,%.2f,%.1f,%.3f,%.3f,%.1f,%.2f,%.3f,%d\n",
+                                scenarioName(type), m.bodies, m.joints, settings.iterations,
+                                settings.damping, settings.sleepThreshold, m.stepMicros,
+                                m.maxPenetration, m.jitter, m.kineticEnergy, m.drift,
+                                m.jointError, m.stable ? 1 : 0);
+                        fflush(out);
+
+                        if (m.stable && m.stepMicros < bestCost) {
+                            bestCost = m.stepMicros;
+                            best = settings;
+                        }
+                    }
+                }
+            }
+
+            if (isinf(bestCost)) {
+                fprintf(out, "# %s n=%d: no stable settings in the grid\n",
+                        scenarioName(type), sweepCounts[c]);
+            } else {
+                fprintf(out, "# %s n=%d: cheapest stable = iterations %d, damping %.2f, sleep %.2f (%.1f us/step)\n",
+                        scenarioName(type), sweepCounts[c], best.iterations,
+                        best.damping, best.sleepThreshold, bestCost);
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "world.h"
+
+// Stress scenarios that can be loaded instead of clicking boxes in one at a time
+typedef enum {
+    SCENARIO_NONE = 0,
+    SCENARIO_PYRAMID,
+    SCENARIO_STACK,
+    SCENARIO_RAIN,
+    SCENARIO_PILE,
+    SCENARIO_MIXED,
+    SCENARIO_ROPE,           // Jointed scenarios: one linkage using every body
+    SCENARIO_CHAIN,
+    SCENARIO_BRIDGE,
+    SCENARIO_SWING,
+    SCENARIO_COUNT
+} ScenarioType;
+
+// Solver settings varied by the sweep
+typedef struct {
+    int iterations;          // cpSpaceSetIterations
+    cpFloat damping;         // cpSpaceSetDamping (1.0 = none)
+    cpFloat sleepThreshold;  // cpSpaceSetSleepTimeThreshold (INFINITY = sleeping off)
+    int bodyCount;           // Bodies spawned by the scenario
+} SolverSettings;
+
+// Stability and cost measured over one scenario run
+typedef struct {
+    double stepMicros;       // Average cpSpaceStep cost
+    double maxPenetration;   // Deepest contact seen during the measure window
+    double jitter;           // Mean body speed during the measure window
+    double kineticEnergy;    // Total kinetic energy at the end of the run
+    double drift;            // Largest displacement of a body across the measure window
+    double jointError;       // Largest joint violation during the measure window (pixels)
+    int bodies;              // Bodies actually spawned
+    int joints;              // Joints spawned
+    bool stable;
+} ScenarioMetrics;
+
+// Scenario name for command line and reports
+const char *scenarioName(ScenarioType type);
+
+// Parse a scenario name, returns SCENARIO_NONE when unknown
+ScenarioType scenarioFromName(const char *name);
+
+// True for scenarios built from jointed linkages
+bool scenarioHasJoints(ScenarioType type);
+
+// Default body count for a scenario
+int scenarioDefaultCount(ScenarioType type);
+
+// Spawn a scenario into the world. Returns the number of boxes spawned.
+int spawnScenario(World *world, ScenarioType type, int bodyCount, unsigned int seed);
+
+// Apply solver settings to a space
+void applySolverSettings(cpSpace *space, const SolverSettings *settings);
+
+// Build a headless world, run the scenario and measure it
+bool measureScenario(ScenarioType type, const SolverSettings *settings, unsigned int seed, ScenarioMetrics *metrics);
+
+// Run every scenario (or only `only` when not SCENARIO_NONE) across the solver grid.
+// Writes CSV rows plus a per-scenario recommendation to out.
+void runScenarioSweep(ScenarioType only, unsigned int seed, FILE *out);
+
+#endif // SCENARIO_H
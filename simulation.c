@@ -0,0 +1,521 @@
+#include "simulation.h"
+#include "pacing.h"
+#include "logging.h"
+#include "alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RAIN_PER_FRAME 50           // Boxes spawned per tick while box rain is on
+#define MAX_STEP_DT 0.033f          // Clamp to reasonable value
+#define IMPACT_MIN_IMPULSE 150.0f   // Softer first contacts don't raise impact events
+#define LANDING_REFERENCE_SPEED 400.0f  // Fall speed of a landing with strength 1
+#define EXPLOSION_RADIUS 150.0
+#define EXPLOSION_IMPULSE 900.0     // At the center, on a unit-mass box
+#define WIND_FORCE 600.0
+#define MAGNET_RADIUS 250.0
+#define MAGNET_FORCE 2500.0
+
+static void pushEvent(Simulation *sim, SimEventType type, cpVect position, float strength) {
+    SimEvents *events = &sim->events;
+    int head = SDL_AtomicGet(&events->head);
+    if (head - SDL_AtomicGet(&events->tail) >= SIM_EVENT_CAPACITY) {
+        SDL_AtomicAdd(&events->dropped, 1);
+        return;
+    }
+
+    SimEvent *event = &events->events[head & (SIM_EVENT_CAPACITY - 1)];
+    event->type = type;
+    event->position = position;
+    event->strength = strength;
+    SDL_AtomicSet(&events->head, head + 1);
+}
+
+// Runs inside cpSpaceStep for every touching pair, so it bails out early
+static void impactPostSolve(cpArbiter *arb, cpSpace *space, cpDataPointer data) {
+    (void)space;
+    Simulation *sim = data;
+    // Rollback resimulates ticks, which would repeat their impacts
+    if (sim->net || !cpArbiterIsFirstContact(arb) || cpArbiterGetCount(arb) == 0) {
+        return;
+    }
+    cpFloat impulse = cpvlength(cpArbiterTotalImpulse(arb));
+    if (impulse < IMPACT_MIN_IMPULSE) {
+        return;
+    }
+    pushEvent(sim, SIM_EVENT_IMPACT, cpArbiterGetPointA(arb, 0), (float)(impulse / IMPACT_MIN_IMPULSE));
+}
+
+bool simulationInit(Simulation *sim, int maxBoxes, double budgetMs, bool governorEnabled) {
+    memset(sim, 0, sizeof(*sim));
+
+    if (!createWorld(&sim->world, maxBoxes)) {
+        return false;
+    }
+    if (!snapshotBufferInit(&sim->snapshots, maxBoxes, sim->world.maxJoints)) {
+        destroyWorld(&sim->world);
+        return false;
+    }
+    if (!effectSystemInit(&sim->effects, sim->world.pool.capacity)) {
+        snapshotBufferDestroy(&sim->snapshots);
+        destroyWorld(&sim->world);
+        return false;
+    }
+
+    // Create initial box (player)
+    spawnPlayer(&sim->world);
+    sim->linkCount = LINKAGE_DEFAULT_LINKS;
+
+    cpCollisionHandler *handler = cpSpaceAddDefaultCollisionHandler(sim->world.space);
+    handler->postSolveFunc = impactPostSolve;
+    handler->userData = sim;
+
+    governorInit(&sim->governor, budgetMs, governorEnabled);
+    governorApply(&sim->governor, sim->world.space);
+    return true;
+}
+
+void simulationDestroy(Simulation *sim) {
+    simulationStopThread(sim);
+    if (sim->net) {
+        netSessionDestroy(sim->net);
+        allocFree(ALLOC_TAG_OTHER, sim->net);
+        sim->net = NULL;
+    }
+    if (sim->streaming) {
+        chunkStreamerDestroy(&sim->streamer, &sim->world);
+        sim->streaming = false;
+    }
+    effectSystemDestroy(&sim->effects);
+    snapshotBufferDestroy(&sim->snapshots);
+    destroyWorld(&sim->world);
+}
+
+bool simulationPushCommand(Simulation *sim, SimCommandType type, cpVect position) {
+    SimInput *input = &sim->input;
+    int head = SDL_AtomicGet(&input->head);
+    if (head - SDL_AtomicGet(&input->tail) >= SIM_COMMAND_CAPACITY) {
+        return false;  // Queue full, drop the command
+    }
+
+    SimCommand *command = &input->commands[head & (SIM_COMMAND_CAPACITY - 1)];
+    command->type = type;
+    command->position = position;
+    SDL_AtomicSet(&input->head, head + 1);  // Publish after the slot is written
+    return true;
+}
+
+void simulationSetHeldInput(Simulation *sim, int bits) {
+    SDL_AtomicSet(&sim->input.held, bits);
+}
+
+void simulationSetDebugDraw(Simulation *sim, bool enabled) {
+    SDL_AtomicSet(&sim->debugDraw, enabled ? 1 : 0);
+}
+
+void simulationSetStatsStream(Simulation *sim, FILE *out, StatsFormat format) {
+    sim->statsOut = out;
+    sim->statsFormat = format;
+    if (out) {
+        physicsStatsWriteHeader(out, format);
+    }
+}
+
+// Keep the player centered, without scrolling past either end of the level
+static void updateCamera(Simulation *sim) {
+    World *world = &sim->world;
+    if (!sim->streaming || !world->playerBody) {
+        sim->cameraX = 0;
+        return;
+    }
+
+    cpFloat x = cpBodyGetPosition(world->playerBody).x - WINDOW_WIDTH / 2;
+    sim->cameraX = cpfclamp(x, world->minX, world->maxX - WINDOW_WIDTH);
+}
+
+bool simulationEnableStreaming(Simulation *sim, const char *directory, int chunkCount, unsigned int seed) {
+    if (!chunkStreamerInit(&sim->streamer, &sim->world, directory, chunkCount, seed)) {
+        chunkStreamerDestroy(&sim->streamer, &sim->world);
+        return false;
+    }
+    sim->streaming = true;
+
+    if (sim->world.playerBody) {
+        chunkStreamerPrime(&sim->streamer, &sim->world, cpBodyGetPosition(sim->world.playerBody).x);
+    }
+    updateCamera(sim);
+    return true;
+}
+
+void simulationSetLod(Simulation *sim, const LodConfig *config) {
+    if (config) {
+        lodInit(&sim->lod, config);
+        sim->lodEnabled = true;
+    } else if (sim->lodEnabled) {
+        lodRestoreAll(&sim->lod, &sim->world);
+        sim->lodEnabled = false;
+    }
+}
+
+bool simulationEnableNet(Simulation *sim, const NetConfig *config) {
+    sim->net = allocMalloc(ALLOC_TAG_OTHER, sizeof(NetSession));
+    if (!sim->net) {
+        return false;
+    }
+    if (!netSessionInit(sim->net, &sim->world, config)) {
+        allocFree(ALLOC_TAG_OTHER, sim->net);
+        sim->net = NULL;
+        return false;
+    }
+    return true;
+}
+
+void simulationSetInputRecording(Simulation *sim, FILE *out) {
+    sim->inputOut = out;
+    sim->recordedHeld = -1;
+    if (out) {
+        fprintf(out, "# platformer input v1: tick held_bits\n");
+    }
+}
+
+bool simulationPopEvent(Simulation *sim, SimEvent *event) {
+    SimEvents *events = &sim->events;
+    int tail = SDL_AtomicGet(&events->tail);
+    if (tail == SDL_AtomicGet(&events->head)) {
+        return false;
+    }
+
+    *event = events->events[tail & (SIM_EVENT_CAPACITY - 1)];
+    SDL_AtomicSet(&events->tail, tail + 1);
+    return true;
+}
+
+static bool popCommand(SimInput *input, SimCommand *command) {
+    int tail = SDL_AtomicGet(&input->tail);
+    if (tail == SDL_AtomicGet(&input->head)) {
+        return false;
+    }
+
+    *command = input->commands[tail & (SIM_COMMAND_CAPACITY - 1)];
+    SDL_AtomicSet(&input->tail, tail + 1);  // Release the slot after reading it
+    return true;
+}
+
+// Raise a landing event when the player touches down after being airborne
+static void detectLanding(Simulation *sim) {
+    cpBody *playerBody = sim->world.playerBody;
+    if (!playerBody) {
+        return;
+    }
+
+    bool onGround = isOnGround(sim->world.space, playerBody);
+    if (!onGround) {
+        // Remember how fast we were falling; contact has already stopped us on the landing tick
+        cpFloat fall = -cpBodyGetVelocity(playerBody).y;
+        sim->playerFallSpeed = fall > 0 ? fall : 0;
+    } else if (!sim->playerOnGround && sim->playerFallSpeed > 0) {
+        cpVect feet = cpvsub(cpBodyGetPosition(playerBody), cpv(0, BOX_SIZE / 2));
+        pushEvent(sim, SIM_EVENT_LANDING, feet, (float)(sim->playerFallSpeed / LANDING_REFERENCE_SPEED));
+        sim->playerFallSpeed = 0;
+    }
+    sim->playerOnGround = onGround;
+}
+
+// Update player sprite animation based on movement state
+static void animatePlayer(Simulation *sim, float dt) {
+    Sprite *sprite = sim->playerSprite;
+    cpBody *playerBody = sim->world.playerBody;
+    if (!sprite || sprite->animationCount == 0 || !playerBody) {
+        return;
+    }
+
+    cpVect vel = cpBodyGetVelocity(playerBody);
+    bool onGround = isOnGround(sim->world.space, playerBody);
+
+    // Update sprite direction based on velocity
+    if (vel.x < -5.0f) {
+        sprite->facingLeft = true;
+    } else if (vel.x > 5.0f) {
+        sprite->facingLeft = false;
+    }
+
+    // Update animation based on state
+    if (!onGround) {
+        setSpriteAnimation(sprite, ANIM_JUMP);
+    } else if (fabs(vel.x) > 10.0f) {
+        setSpriteAnimation(sprite, ANIM_WALK);
+    } else {
+        setSpriteAnimation(sprite, ANIM_IDLE);
+    }
+
+    // Update sprite animation timer
+    updateSprite(sprite, dt);
+}
+
+double simulationTick(Simulation *sim, cpFloat dt) {
+    World *world = &sim->world;
+
+    // Consume one-shot commands from the event loop
+    SimCommand command;
+    while (popCommand(&sim->input, &command)) {
+        if (sim->net) {
+            continue;  // Only inputs both peers know about may change the world
+        }
+        switch (command.type) {
+            case SIM_COMMAND_SPAWN_BOX:
+                spawnBox(world, command.position, BOX_SIZE, BOX_SIZE);
+                break;
+            case SIM_COMMAND_TOGGLE_RAIN:
+                sim->boxRain = !sim->boxRain;
+                break;
+            case SIM_COMMAND_SPAWN_ROPE:
+                spawnLinkage(world, LINKAGE_ROPE, command.position, sim->linkCount, 0.0);
+                break;
+            case SIM_COMMAND_SPAWN_CHAIN:
+                spawnLinkage(world, LINKAGE_CHAIN, command.position, sim->linkCount, 0.0);
+                break;
+            case SIM_COMMAND_SPAWN_BRIDGE:
+                spawnLinkage(world, LINKAGE_BRIDGE, command.position, sim->linkCount, 0.0);
+                break;
+            case SIM_COMMAND_SPAWN_SWING:
+                spawnLinkage(world, LINKAGE_SWING, command.position, sim->linkCount, 0.0);
+                break;
+            case SIM_COMMAND_EXPLOSION: {
+                AreaEffect explosion = effectExplosion(command.position, EXPLOSION_RADIUS, EXPLOSION_IMPULSE);
+                effectQueue(&sim->effects, &explosion);
+                pushEvent(sim, SIM_EVENT_IMPACT, command.position, 3.0f);
+                break;
+            }
+            case SIM_COMMAND_TOGGLE_WIND:
+                sim->wind = !sim->wind;
+                break;
+            case SIM_COMMAND_TOGGLE_MAGNET:
+                sim->magnet = !sim->magnet;
+                sim->magnetPosition = command.position;
+                break;
+        }
+    }
+
+    // The session steps the world itself, at the rate the peer allows
+    if (sim->net) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        netSessionUpdate(sim->net, SDL_AtomicGet(&sim->input.held));
+        sim->lastStepMs = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+        sim->tick = sim->net->tick;
+        detectLanding(sim);
+        animatePlayer(sim, (float)dt);
+        physicsStatsCollect(&sim->stats, world->space, sim->lastStepMs, sim->statsOut != NULL, sim->cameraX);
+        if (sim->statsOut) {
+            physicsStatsWrite(sim->statsOut, sim->statsFormat, sim->tick, &sim->stats);
+        }
+        return sim->lastStepMs;
+    }
+
+    // Bring chunks around the player in and out before anything else touches the space
+    if (sim->streaming && world->playerBody) {
+        AllocTag tag = allocSetTag(ALLOC_TAG_STREAMING);
+        chunkStreamerUpdate(&sim->streamer, world, cpBodyGetPosition(world->playerBody).x);
+        allocSetTag(tag);
+    }
+
+    // Spawn burst from above the window; the pool recycles boxes that fall off the world
+    if (sim->boxRain) {
+        for (int i = 0; i < RAIN_PER_FRAME; i++) {
+            cpVect pos = cpv(sim->cameraX + rand() % WINDOW_WIDTH, WINDOW_HEIGHT + 20 + rand() % 200);
+            if (!spawnBoxOnLayer(world, pos, 20, 20, LAYER_DEBRIS)) {
+                break;
+            }
+        }
+    }
+    despawnOutOfBounds(world);
+
+    // Far-away bodies at rest sleep or freeze; done between steps so the space is unlocked
+    if (sim->lodEnabled && world->playerBody) {
+        lodUpdate(&sim->lod, world, cpBodyGetPosition(world->playerBody));
+    }
+
+    // Update player movement
+    int held = SDL_AtomicGet(&sim->input.held);
+    if (sim->inputOut && held != sim->recordedHeld) {
+        fprintf(sim->inputOut, "%lu %d\n", sim->tick, held);
+        sim->recordedHeld = held;
+    }
+    if (world->playerBody &&
+        updatePlayerMovement(world->space, world->playerBody,
+                             held & INPUT_LEFT, held & INPUT_RIGHT, held & INPUT_JUMP)) {
+        cpVect feet = cpvsub(cpBodyGetPosition(world->playerBody), cpv(0, BOX_SIZE / 2));
+        pushEvent(sim, SIM_EVENT_JUMP, feet, 1.0f);
+    }
+    animatePlayer(sim, (float)dt);
+
+    // Update physics
+    if (dt > MAX_STEP_DT) {
+        dt = MAX_STEP_DT;
+    }
+
+    // Fields push every tick; everything queued this tick is applied in one batch
+    if (sim->wind) {
+        AreaEffect wind = effectWind(cpv(sim->cameraX + WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2), WINDOW_WIDTH,
+                                     cpv(1, 0), WIND_FORCE, dt);
+        effectQueue(&sim->effects, &wind);
+    }
+    if (sim->magnet) {
+        AreaEffect magnet = effectMagnet(sim->magnetPosition, MAGNET_RADIUS, MAGNET_FORCE, dt);
+        effectQueue(&sim->effects, &magnet);
+    }
+    Uint64 effectStart = SDL_GetPerformanceCounter();
+    effectSystemApply(&sim->effects, world);
+    sim->lastEffectMs = (double)(SDL_GetPerformanceCounter() - effectStart) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    governorStep(&sim->governor, world->space, dt);
+    sim->lastStepMs = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    sim->tick++;
+    updateCamera(sim);
+    detectLanding(sim);
+
+    // Broadphase pairs cost a query per shape, so only count them when streaming stats
+    physicsStatsCollect(&sim->stats, world->space, sim->lastStepMs, sim->statsOut != NULL, sim->cameraX);
+    if (sim->statsOut) {
+        physicsStatsWrite(sim->statsOut, sim->statsFormat, sim->tick, &sim->stats);
+    }
+    return sim->lastStepMs;
+}
+
+void simulationPublish(Simulation *sim) {
+    World *world = &sim->world;
+    RenderSnapshot *snap = snapshotBeginWrite(&sim->snapshots);
+
+    snap->tick = sim->tick;
+    snap->cameraX = (float)sim->cameraX;
+    snap->boxCount = 0;
+    snap->hasPlayer = false;
+
+    for (int i = 0; i < world->boxCount && snap->boxCount < snap->capacity; i++) {
+        Box *box = &world->boxes[i];
+        cpVect pos = cpBodyGetPosition(box->body);
+        cpFloat angle = cpBodyGetAngle(box->body);
+
+        if (box->body == world->playerBody) {
+            snap->hasPlayer = true;
+            snap->playerX = (float)(pos.x - sim->cameraX);
+            snap->playerY = (float)pos.y;
+            snap->playerAngle = (float)angle;
+            continue;
+        }
+
+        SnapshotBox *out = &snap->boxes[snap->boxCount++];
+        out->x = (float)(pos.x - sim->cameraX);
+        out->y = (float)pos.y;
+        out->angle = (float)angle;
+        out->width = (float)box->width;
+        out->height = (float)box->height;
+
+        // Simple rotation rendering (for visual feedback)
+        SDL_Color resting = {255, 100, 100, 255};
+        SDL_Color rotated = {200, 50, 50, 255};
+        SDL_Color linked = {170, 120, 70, 255};
+        if (bodyHasJoints(box->body)) {
+            out->color = linked;
+        } else {
+            out->color = (fabs(angle) > 0.01) ? rotated : resting;
+        }
+    }
+
+    // Rope segments; pivots join touching bodies and need no drawing
+    snap->jointCount = 0;
+    for (int i = 0; i < world->jointCount && snap->jointCount < snap->jointCapacity; i++) {
+        cpConstraint *joint = world->joints[i];
+        cpVect a, b;
+        if (cpConstraintIsPivotJoint(joint) || !jointAnchors(joint, &a, &b)) {
+            continue;
+        }
+        SnapshotJoint *out = &snap->joints[snap->jointCount++];
+        out->ax = (float)(a.x - sim->cameraX);
+        out->ay = (float)a.y;
+        out->bx = (float)(b.x - sim->cameraX);
+        out->by = (float)b.y;
+
+        SDL_Color taut = {140, 100, 60, 255};
+        SDL_Color slack = {200, 170, 110, 255};
+        out->color = cpConstraintIsSlideJoint(joint) ? slack : taut;
+    }
+
+    const SpriteFrame *frame = sim->playerSprite ? currentSpriteFrame(sim->playerSprite) : NULL;
+    snap->playerHasSprite = (frame != NULL);
+    if (frame) {
+        snap->playerFrame = *frame;
+        snap->playerFacingLeft = sim->playerSprite->facingLeft;
+    }
+
+    // Debug geometry is built here, where the space may be read safely
+    snap->hasDebug = SDL_AtomicGet(&sim->debugDraw) != 0;
+    if (snap->hasDebug) {
+        debugDrawSpace(&snap->debug, world->space, sim->cameraX);
+    }
+
+    snap->stepMs = sim->lastStepMs;
+    snap->physics = sim->stats;
+    snap->lod = sim->lod.stats;
+    snap->qualityLevel = sim->governor.level;
+    snap->iterations = governorIterations(&sim->governor);
+    snap->substeps = governorSubsteps(&sim->governor);
+    snap->sleepThreshold = governorSleepThreshold(&sim->governor);
+    snap->poolLive = world->pool.live;
+    snap->poolHighWater = world->pool.highWater;
+    snap->poolReleased = world->pool.released;
+    snap->poolExhausted = world->pool.exhausted;
+    snap->effects = sim->effects.stats;
+    snap->effectMs = sim->lastEffectMs;
+    snap->hasNet = sim->net != NULL;
+    if (sim->net) {
+        snap->net = sim->net->stats;
+    }
+
+    snapshotPublish(&sim->snapshots);
+}
+
+// Fixed-rate simulation loop; render time is off this thread so only step cost is governed
+static int simulationThread(void *data) {
+    Simulation *sim = data;
+    allocSetTag(ALLOC_TAG_PHYSICS);
+
+    FramePacer pacer;
+    pacerInit(&pacer, PACING_TARGET_FPS, sim->tickRate);
+    cpFloat dt = 1.0 / sim->tickRate;
+
+    while (SDL_AtomicGet(&sim->running)) {
+        double stepMs = simulationTick(sim, dt);
+        if (governorUpdate(&sim->governor, stepMs, 0.0)) {
+            governorApply(&sim->governor, sim->world.space);
+        }
+        simulationPublish(sim);
+        pacerWait(&pacer);
+    }
+
+    LOG_INFO("Simulation thread stopped after %lu ticks, %d missed deadlines",
+             sim->tick, pacer.missedDeadlines);
+    return 0;
+}
+
+bool simulationStartThread(Simulation *sim, double tickRate) {
+    sim->tickRate = tickRate;
+    SDL_AtomicSet(&sim->running, 1);
+    sim->thread = SDL_CreateThread(simulationThread, "simulation", sim);
+    if (!sim->thread) {
+        LOG_ERROR("Failed to create simulation thread: %s", SDL_GetError());
+        SDL_AtomicSet(&sim->running, 0);
+        return false;
+    }
+    return true;
+}
+
+void simulationStopThread(Simulation *sim) {
+    if (!sim->thread) {
+        return;
+    }
+    SDL_AtomicSet(&sim->running, 0);
+    SDL_WaitThread(sim->thread, NULL);
+    sim->thread = NULL;
+}
@@ -0,0 +1,165 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include "world.h"
+#include "governor.h"
+#include "sprite.h"
+#include "snapshot.h"
+#include "physstats.h"
+#include "chunks.h"
+#include "lod.h"
+#include "net.h"
+#include "linkage.h"
+
+// Held input bits, written by the event loop and read by the simulation
+typedef enum {
+    INPUT_LEFT  = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_JUMP  = 1 << 2
+} InputBits;
+
+// One-shot commands from the event loop
+typedef enum {
+    SIM_COMMAND_SPAWN_BOX,
+    SIM_COMMAND_TOGGLE_RAIN,
+    SIM_COMMAND_SPAWN_ROPE,    // Linkages anchored at the command position
+    SIM_COMMAND_SPAWN_CHAIN,
+    SIM_COMMAND_SPAWN_BRIDGE,
+    SIM_COMMAND_SPAWN_SWING,
+    SIM_COMMAND_EXPLOSION,     // At the command position
+    SIM_COMMAND_TOGGLE_WIND,
+    SIM_COMMAND_TOGGLE_MAGNET  // Placed at the command position
+} SimCommandType;
+
+typedef struct {
+    SimCommandType type;
+    cpVect position;
+} SimCommand;
+
+#define SIM_COMMAND_CAPACITY 256   // Power of two
+
+// Lock-free single producer / single consumer input queue
+typedef struct {
+    SimCommand commands[SIM_COMMAND_CAPACITY];
+    SDL_atomic_t head;     // Next slot to write (producer)
+    SDL_atomic_t tail;     // Next slot to read (consumer)
+    SDL_atomic_t held;     // InputBits currently held
+} SimInput;
+
+// Gameplay events for presentation-only systems (particles), from the simulation
+typedef enum {
+    SIM_EVENT_IMPACT,      // Two shapes first touched with a large impulse
+    SIM_EVENT_JUMP,
+    SIM_EVENT_LANDING
+} SimEventType;
+
+typedef struct {
+    SimEventType type;
+    cpVect position;
+    float strength;        // Roughly 1 for a typical event
+} SimEvent;
+
+#define SIM_EVENT_CAPACITY 1024    // Power of two
+
+// Lock-free single producer / single consumer event queue, the reverse of SimInput
+typedef struct {
+    SimEvent events[SIM_EVENT_CAPACITY];
+    SDL_atomic_t head;     // Next slot to write (simulation)
+    SDL_atomic_t tail;     // Next slot to read (main loop)
+    SDL_atomic_t dropped;  // Events lost to a full queue
+} SimEvents;
+
+// Everything that advances the game: world, governor, player animation and input.
+// Runs either inline in the main loop or on its own thread.
+typedef struct {
+    World world;
+    PhysicsGovernor governor;
+    Sprite *playerSprite;       // Animation state advanced by the simulation, may be NULL
+    SimInput input;
+    SimEvents events;
+    bool playerOnGround;        // For landing events
+    cpFloat playerFallSpeed;
+    SnapshotBuffer snapshots;
+    bool boxRain;
+    int linkCount;              // Links per linkage spawned by command
+
+    // Area effects queued during a tick, applied just before the step
+    EffectSystem effects;
+    double lastEffectMs;
+    bool wind;
+    bool magnet;
+    cpVect magnetPosition;
+    SDL_atomic_t debugDraw;     // Build debug geometry into snapshots (F1)
+    unsigned long tick;
+    double lastStepMs;
+    PhysicsStats stats;         // Collected after every step
+    cpFloat cameraX;            // Follows the player while streaming, 0 otherwise
+
+    // Distance-based level of detail around the player
+    bool lodEnabled;
+    LodSystem lod;
+
+    // Level streamed from disk around the player
+    bool streaming;
+    ChunkStreamer streamer;
+
+    // Two-player rollback session; the network decides when ticks happen
+    NetSession *net;
+
+    // Optional per-step statistics stream, written from the simulation
+    FILE *statsOut;
+    StatsFormat statsFormat;
+
+    // Optional held-input recording, replayable with --batch --input
+    FILE *inputOut;
+    int recordedHeld;
+
+    // Simulation thread
+    SDL_Thread *thread;
+    SDL_atomic_t running;
+    double tickRate;
+} Simulation;
+
+// Create the world with a player and the snapshot buffers
+bool simulationInit(Simulation *sim, int maxBoxes, double budgetMs, bool governorEnabled);
+void simulationDestroy(Simulation *sim);
+
+// Producer side of the input queue (event loop)
+bool simulationPushCommand(Simulation *sim, SimCommandType type, cpVect position);
+void simulationSetHeldInput(Simulation *sim, int bits);
+void simulationSetDebugDraw(Simulation *sim, bool enabled);
+
+// Consumer side of the event queue (main loop). Returns false when empty.
+bool simulationPopEvent(Simulation *sim, SimEvent *event);
+
+// Stream per-step statistics to `out` (owned by the caller). Call before starting the thread.
+void simulationSetStatsStream(Simulation *sim, FILE *out, StatsFormat format);
+
+// Replace the fixed ground with chunks streamed from `directory`. Call before starting the thread.
+bool simulationEnableStreaming(Simulation *sim, const char *directory, int chunkCount, unsigned int seed);
+
+// Slow down far-away bodies with `config`, or return everything to full rate with NULL.
+// Call before starting the thread.
+void simulationSetLod(Simulation *sim, const LodConfig *config);
+
+// Play a rollback session with `config`. The world must only contain the player;
+// spawn commands, box rain and the governor are ignored from here on so both
+// peers stay deterministic. Call before anything else is spawned.
+bool simulationEnableNet(Simulation *sim, const NetConfig *config);
+
+// Record held input changes to `out` (owned by the caller). Call before starting the thread.
+void simulationSetInputRecording(Simulation *sim, FILE *out);
+
+// Consume input, move the player, animate and step physics. Returns step time in ms.
+double simulationTick(Simulation *sim, cpFloat dt);
+
+// Copy render-relevant state into the next snapshot and publish it
+void simulationPublish(Simulation *sim);
+
+// Run ticks at a fixed rate on a separate thread
+bool simulationStartThread(Simulation *sim, double tickRate);
+void simulationStopThread(Simulation *sim);
+
+#endif // SIMULATION_H
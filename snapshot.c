@@ -0,0 +1,62 @@
+#include "snapshot.h"
+#include "alloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_FRESH 4        // Set in `latest` when it has not been acquired yet
+#define SNAPSHOT_INDEX_MASK 3
+
+bool snapshotBufferInit(SnapshotBuffer *buffer, int capacity, int jointCapacity) {
+    memset(buffer, 0, sizeof(*buffer));
+
+    for (int i = 0; i < 3; i++) {
+        buffer->buffers[i].boxes = allocCalloc(ALLOC_TAG_RENDER, capacity, sizeof(SnapshotBox));
+        buffer->buffers[i].joints = allocCalloc(ALLOC_TAG_RENDER, jointCapacity, sizeof(SnapshotJoint));
+        if (!buffer->buffers[i].boxes || (jointCapacity > 0 && !buffer->buffers[i].joints)) {
+            fprintf(stderr, "Failed to allocate render snapshots for %d boxes and %d joints\n",
+                    capacity, jointCapacity);
+            snapshotBufferDestroy(buffer);
+            return false;
+        }
+        buffer->buffers[i].capacity = capacity;
+        buffer->buffers[i].jointCapacity = jointCapacity;
+        debugDrawInit(&buffer->buffers[i].debug);
+    }
+
+    buffer->writeIndex = 0;
+    SDL_AtomicSet(&buffer->latest, 1);
+    buffer->readIndex = 2;
+    return true;
+}
+
+void snapshotBufferDestroy(SnapshotBuffer *buffer) {
+    for (int i = 0; i < 3; i++) {
+        allocFree(ALLOC_TAG_RENDER, buffer->buffers[i].boxes);
+        allocFree(ALLOC_TAG_RENDER, buffer->buffers[i].joints);
+        buffer->buffers[i].boxes = NULL;
+        buffer->buffers[i].joints = NULL;
+        debugDrawDestroy(&buffer->buffers[i].debug);
+    }
+}
+
+RenderSnapshot *snapshotBeginWrite(SnapshotBuffer *buffer) {
+    return &buffer->buffers[buffer->writeIndex];
+}
+
+void snapshotPublish(SnapshotBuffer *buffer) {
+    // Swap the written buffer into `latest` and take whatever was there to write next
+    int previous = SDL_AtomicSet(&buffer->latest, buffer->writeIndex | SNAPSHOT_FRESH);
+    buffer->writeIndex = previous & SNAPSHOT_INDEX_MASK;
+}
+
+const RenderSnapshot *snapshotAcquire(SnapshotBuffer *buffer, bool *fresh) {
+    *fresh = false;
+    if (SDL_AtomicGet(&buffer->latest) & SNAPSHOT_FRESH) {
+        // Swap our read buffer for the latest one
+        int latest = SDL_AtomicSet(&buffer->latest, buffer->readIndex);
+        buffer->readIndex = latest & SNAPSHOT_INDEX_MASK;
+        *fresh = true;
+    }
+    return &buffer->buffers[buffer->readIndex];
+}
@@ -0,0 +1,93 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include "sprite.h"
+#include "debugdraw.h"
+#include "physstats.h"
+#include "lod.h"
+#include "net.h"
+#include "effects.h"
+
+// Render-relevant state of one box
+typedef struct {
+    float x, y;            // Center in Chipmunk coordinates, relative to the camera
+    float angle;
+    float width, height;
+    SDL_Color color;
+} SnapshotBox;
+
+// Rope segment between two joint anchors, relative to the camera
+typedef struct {
+    float ax, ay;
+    float bx, by;
+    SDL_Color color;
+} SnapshotJoint;
+
+// Immutable copy of everything the renderer needs for one simulation tick
+typedef struct {
+    unsigned long tick;
+    float cameraX;         // World x at the left edge of the window
+    SnapshotBox *boxes;    // Preallocated, `capacity` entries
+    int boxCount;
+    int capacity;          // Boxes
+    SnapshotJoint *joints; // Preallocated, `jointCapacity` entries
+    int jointCount;
+    int jointCapacity;
+
+    // Player sprite
+    bool hasPlayer;
+    bool playerHasSprite;
+    float playerX, playerY;
+    float playerAngle;
+    SpriteFrame playerFrame;
+    bool playerFacingLeft;
+
+    // Physics debug geometry, only filled while debug drawing is enabled
+    bool hasDebug;
+    DebugDrawBuffer debug;
+
+    // Simulation statistics for instrumentation
+    double stepMs;
+    PhysicsStats physics;
+    LodStats lod;
+    int qualityLevel;
+    int iterations;
+    int substeps;
+    double sleepThreshold;
+    int poolLive;
+    int poolHighWater;
+    unsigned long poolReleased;
+    unsigned long poolExhausted;
+    bool hasNet;
+    NetStats net;
+    EffectStats effects;
+    double effectMs;
+} RenderSnapshot;
+
+// Lock-free triple buffer: the simulation always has a buffer to write,
+// the renderer always has a buffer to read, and the third holds the latest
+// published snapshot. Publishing and acquiring are single atomic exchanges.
+typedef struct {
+    RenderSnapshot buffers[3];
+    SDL_atomic_t latest;   // Index of the latest published buffer, plus SNAPSHOT_FRESH
+    int writeIndex;        // Owned by the producer
+    int readIndex;         // Owned by the consumer
+} SnapshotBuffer;
+
+// Allocate the three snapshots for up to `capacity` boxes and `jointCapacity` joints
+bool snapshotBufferInit(SnapshotBuffer *buffer, int capacity, int jointCapacity);
+void snapshotBufferDestroy(SnapshotBuffer *buffer);
+
+// Producer: snapshot to fill for the current tick
+RenderSnapshot *snapshotBeginWrite(SnapshotBuffer *buffer);
+
+// Producer: make the filled snapshot the latest one
+void snapshotPublish(SnapshotBuffer *buffer);
+
+// Consumer: latest published snapshot. Sets *fresh when it is newer than the
+// previous call's. The snapshot stays valid until the next acquire.
+const RenderSnapshot *snapshotAcquire(SnapshotBuffer *buffer, bool *fresh);
+
+#endif // SNAPSHOT_H
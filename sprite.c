@@ -0,0 +1,166 @@
+#include "sprite.h"
+#include "alloc.h"
+#include "world.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Load character spritesheet from file
+SDL_Texture* loadCharacterSpritesheet(SDL_Renderer *renderer) {
+    SDL_Texture *texture = IMG_LoadTexture(renderer, "./assets/characters.png");
+    if (!texture) {
+        fprintf(stderr, "Failed to load character spritesheet: %s\n", IMG_GetError());
+        return NULL;
+    }
+    return texture;
+}
+
+// Initialize sprite with character spritesheet
+Sprite createCharacterSprite(SDL_Renderer *renderer) {
+    Sprite sprite = {0};
+    
+    // Load character spritesheet
+    sprite.texture = loadCharacterSpritesheet(renderer);
+    if (!sprite.texture) {
+        return sprite;
+    }
+    
+    // Allocate animations
+    sprite.animationCount = ANIM_COUNT;
+    sprite.animations = allocMalloc(ALLOC_TAG_SPRITE, sizeof(Animation) * ANIM_COUNT);
+    if (!sprite.animations) {
+        fprintf(stderr, "Failed to allocate memory for animations\n");
+        SDL_DestroyTexture(sprite.texture);
+        sprite.texture = NULL;
+        return sprite;
+    }
+    
+    // Setup idle animation - frame (1,0) = x:0, y:32, 32x32 (swapped x,y)
+    sprite.animations[ANIM_IDLE].frameCount = 1;
+    sprite.animations[ANIM_IDLE].frames = allocMalloc(ALLOC_TAG_SPRITE, sizeof(SpriteFrame));
+    sprite.animations[ANIM_IDLE].frames[0] = (SpriteFrame){0, 32, 32, 32};
+    sprite.animations[ANIM_IDLE].frameTime = 1.0f;
+    sprite.animations[ANIM_IDLE].loop = true;
+    
+    // Setup walk animation - frames (1,0), (1,1), (1,2), (1,3) with swapped coordinates
+    sprite.animations[ANIM_WALK].frameCount = 4;
+    sprite.animations[ANIM_WALK].frames = allocMalloc(ALLOC_TAG_SPRITE, sizeof(SpriteFrame) * 4);
+    sprite.animations[ANIM_WALK].frames[0] = (SpriteFrame){0, 32, 32, 32};   // (1,0) -> (0,1)
+    sprite.animations[ANIM_WALK].frames[1] = (SpriteFrame){32, 32, 32, 32};  // (1,1) -> (1,1)
+    sprite.animations[ANIM_WALK].frames[2] = (SpriteFrame){64, 32, 32, 32};  // (1,2) -> (2,1)
+    sprite.animations[ANIM_WALK].frames[3] = (SpriteFrame){96, 32, 32, 32};  // (1,3) -> (3,1)
+    sprite.animations[ANIM_WALK].frameTime = 0.15f; // Slightly faster animation
+    sprite.animations[ANIM_WALK].loop = true;
+    
+    // Setup jump animation - use frame (1,0) for now
+    sprite.animations[ANIM_JUMP].frameCount = 1;
+    sprite.animations[ANIM_JUMP].frames = allocMalloc(ALLOC_TAG_SPRITE, sizeof(SpriteFrame));
+    sprite.animations[ANIM_JUMP].frames[0] = (SpriteFrame){0, 32, 32, 32};
+    sprite.animations[ANIM_JUMP].frameTime = 1.0f;
+    sprite.animations[ANIM_JUMP].loop = false;
+    
+    // Start with idle animation, facing right
+    sprite.currentAnimation = ANIM_IDLE;
+    sprite.currentFrame = 0;
+    sprite.animationTimer = 0.0f;
+    sprite.isPlaying = true;
+    sprite.facingLeft = false;
+    
+    return sprite;
+}
+
+// Update sprite animation
+void updateSprite(Sprite *sprite, float deltaTime) {
+    if (!sprite->isPlaying || sprite->animationCount == 0) return;
+    
+    Animation *anim = &sprite->animations[sprite->currentAnimation];
+    
+    sprite->animationTimer += deltaTime;
+    
+    if (sprite->animationTimer >= anim->frameTime) {
+        sprite->animationTimer = 0.0f;
+        sprite->currentFrame++;
+        
+        if (sprite->currentFrame >= anim->frameCount) {
+            if (anim->loop) {
+                sprite->currentFrame = 0;
+            } else {
+                sprite->currentFrame = anim->frameCount - 1;
+                sprite->isPlaying = false;
+            }
+        }
+    }
+}
+
+// Set sprite animation
+void setSpriteAnimation(Sprite *sprite, int animation) {
+    if (animation >= 0 && animation < sprite->animationCount && 
+        animation != sprite->currentAnimation) {
+        sprite->currentAnimation = animation;
+        sprite->currentFrame = 0;
+        sprite->animationTimer = 0.0f;
+        sprite->isPlaying = true;
+    }
+}
+
+// Frame currently shown by the sprite, NULL if there is none
+const SpriteFrame* currentSpriteFrame(const Sprite *sprite) {
+    if (sprite->animationCount == 0) {
+        return NULL;
+    }
+    
+    Animation *anim = &sprite->animations[sprite->currentAnimation];
+    if (sprite->currentFrame >= anim->frameCount) {
+        return NULL;
+    }
+    
+    return &anim->frames[sprite->currentFrame];
+}
+
+// Render one frame of a spritesheet at given position with optional horizontal flipping
+void renderSpriteFrame(SDL_Renderer *renderer, SDL_Texture *texture, const SpriteFrame *frame, bool flip, int x, int y) {
+    SDL_Rect srcRect = {
+        frame->x, frame->y,
+        frame->width, frame->height
+    };
+    
+    // Scale sprite to double the physics body size (32x32 -> 100x100)
+    int spriteSize = BOX_SIZE * 2;  // Double the physics body size
+    SDL_Rect dstRect = {
+        x - spriteSize/2,                    // Center horizontally
+        y - spriteSize + BOX_SIZE/2,         // Align physics body with bottom of sprite
+        spriteSize, spriteSize               // Double scale (100x100)
+    };
+    
+    // Use SDL_RenderCopyEx for flipping support
+    SDL_RenderCopyEx(renderer, texture, &srcRect, &dstRect, 0.0, NULL, flip ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+}
+
+// Render sprite at given position with optional horizontal flipping
+void renderSprite(SDL_Renderer *renderer, Sprite *sprite, int x, int y) {
+    if (!sprite->texture) {
+        return;
+    }
+    
+    const SpriteFrame *frame = currentSpriteFrame(sprite);
+    if (frame) {
+        renderSpriteFrame(renderer, sprite->texture, frame, sprite->facingLeft, x, y);
+    }
+}
+
+// Cleanup sprite resources
+void destroySprite(Sprite *sprite) {
+    if (sprite->texture) {
+        SDL_DestroyTexture(sprite->texture);
+    }
+    
+    for (int i = 0; i < sprite->animationCount; i++) {
+        if (sprite->animations[i].frames) {
+            allocFree(ALLOC_TAG_SPRITE, sprite->animations[i].frames);
+        }
+    }
+    
+    if (sprite->animations) {
+        allocFree(ALLOC_TAG_SPRITE, sprite->animations);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Sprite frame structure
+typedef struct {
+    int x, y;        // Position in spritesheet
+    int width, height; // Frame dimensions
+} SpriteFrame;
+
+// Animation structure
+typedef struct {
+    SpriteFrame *frames;  // Array of frames
+    int frameCount;      // Number of frames
+    float frameTime;     // Time per frame in seconds
+    bool loop;          // Whether animation loops
+} Animation;
+
+// Sprite structure
+typedef struct {
+    SDL_Texture *texture;     // The spritesheet texture
+    Animation *animations;    // Array of animations
+    int animationCount;      // Number of animations
+    int currentAnimation;    // Current playing animation
+    int currentFrame;        // Current frame in animation
+    float animationTimer;    // Timer for frame changes
+    bool isPlaying;         // Whether animation is playing
+    bool facingLeft;        // Whether sprite should be flipped horizontally
+} Sprite;
+
+// Animation states
+typedef enum {
+    ANIM_IDLE = 0,
+    ANIM_WALK,
+    ANIM_JUMP,
+    ANIM_COUNT
+} AnimationState;
+
+// Load character spritesheet from file
+SDL_Texture* loadCharacterSpritesheet(SDL_Renderer *renderer);
+
+// Initialize sprite with character spritesheet
+Sprite createCharacterSprite(SDL_Renderer *renderer);
+
+// Update sprite animation
+void updateSprite(Sprite *sprite, float deltaTime);
+
+// Set sprite animation
+void setSpriteAnimation(Sprite *sprite, int animation);
+
+// Frame currently shown by the sprite, NULL if there is none
+const SpriteFrame* currentSpriteFrame(const Sprite *sprite);
+
+// Render one frame of a spritesheet at given position with optional horizontal flipping
+void renderSpriteFrame(SDL_Renderer *renderer, SDL_Texture *texture, const SpriteFrame *frame, bool flip, int x, int y);
+
+// Render sprite at given position with optional horizontal flipping
+void renderSprite(SDL_Renderer *renderer, Sprite *sprite, int x, int y);
+
+// Cleanup sprite resources
+void destroySprite(Sprite *sprite);
+
+#endif // SPRITE_H
@@ -0,0 +1,320 @@
+#define _USE_MATH_DEFINES
+#include "world.h"
+#include "alloc.h"
+#include <chipmunk/chipmunk_structs.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+bool createWorld(World *world, int maxBoxes) {
+    World empty = {0};
+    *world = empty;
+
+    world->space = cpSpaceNew();
+    if (!world->space) {
+        fprintf(stderr, "Failed to create Chipmunk space\n");
+        return false;
+    }
+    cpSpaceSetGravity(world->space, cpv(0, -980));
+
+    int maxJoints = maxBoxes * WORLD_JOINTS_PER_BOX;
+    world->boxes = allocMalloc(ALLOC_TAG_PHYSICS, sizeof(Box) * maxBoxes);
+    world->joints = allocMalloc(ALLOC_TAG_PHYSICS, sizeof(cpConstraint *) * maxJoints);
+    if (!world->boxes || !world->joints || !boxPoolInit(&world->pool, maxBoxes) ||
+        !jointPoolInit(&world->jointPool, maxJoints)) {
+        fprintf(stderr, "Failed to allocate memory for %d boxes\n", maxBoxes);
+        allocFree(ALLOC_TAG_PHYSICS, world->boxes);
+        allocFree(ALLOC_TAG_PHYSICS, world->joints);
+        boxPoolDestroy(&world->pool);
+        cpSpaceFree(world->space);
+        world->space = NULL;
+        return false;
+    }
+    world->maxBoxes = maxBoxes;
+    world->maxJoints = maxJoints;
+    world->minX = 0;
+    world->maxX = WINDOW_WIDTH;
+
+    // Create static ground body
+    cpBody *groundBody = cpSpaceGetStaticBody(world->space);
+    world->ground = cpSegmentShapeNew(groundBody,
+        cpv(0, GROUND_HEIGHT),
+        cpv(WINDOW_WIDTH, GROUND_HEIGHT),
+        0.0f);
+    cpShapeSetFriction(world->ground, 0.3f);
+    cpSpaceAddShape(world->space, world->ground);
+
+    CollisionMatrix layers;
+    collisionMatrixDefault(&layers);
+    setCollisionMatrix(world, &layers);
+
+    return true;
+}
+
+void removeGround(World *world) {
+    if (world->ground) {
+        cpSpaceRemoveShape(world->space, world->ground);
+        cpShapeFree(world->ground);
+        world->ground = NULL;
+    }
+}
+
+void setCollisionMatrix(World *world, const CollisionMatrix *matrix) {
+    world->layers = *matrix;
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        world->filters[layer] = layerShapeFilter(matrix, (CollisionLayer)layer);
+    }
+
+    if (world->ground) {
+        cpShapeSetFilter(world->ground, world->filters[LAYER_STATIC]);
+    }
+    for (int i = 0; i < world->boxCount; i++) {
+        cpShapeSetFilter(world->boxes[i].shape, world->filters[world->boxes[i].layer]);
+    }
+}
+
+// The shape id counter is private to Chipmunk and only read or written here.
+// Its place in cpSpace is only known for the 7.0 series; recheck it before
+// building against anything else.
+#if CP_VERSION_MAJOR != 7 || CP_VERSION_MINOR != 0
+#error "worldNextShapeId/worldReaddBoxShapes use cpSpace internals verified against Chipmunk 7.0"
+#endif
+
+cpHashValue worldNextShapeId(const World *world) {
+    return world->space->shapeIDCounter;
+}
+
+void worldReaddBoxShapes(World *world, cpHashValue firstShapeId) {
+    for (int i = 0; i < world->boxCount; i++) {
+        cpSpaceRemoveShape(world->space, world->boxes[i].shape);
+    }
+    world->space->shapeIDCounter = firstShapeId;
+    for (int i = 0; i < world->boxCount; i++) {
+        cpSpaceAddShape(world->space, world->boxes[i].shape);
+    }
+}
+
+void destroyWorld(World *world) {
+    // Despawn from the end so no boxes have to be moved
+    while (world->boxCount > 0) {
+        despawnBox(world, world->boxCount - 1);
+    }
+    removeGround(world);
+    if (world->space) {
+        cpSpaceFree(world->space);
+    }
+    allocFree(ALLOC_TAG_PHYSICS, world->boxes);
+    allocFree(ALLOC_TAG_PHYSICS, world->joints);
+    boxPoolDestroy(&world->pool);
+    jointPoolDestroy(&world->jointPool);
+
+    World empty = {0};
+    *world = empty;
+}
+
+Box *spawnBox(World *world, cpVect position, cpFloat width, cpFloat height) {
+    return spawnBoxOnLayer(world, position, width, height, LAYER_PROPS);
+}
+
+Box *spawnBoxOnLayer(World *world, cpVect position, cpFloat width, cpFloat height, CollisionLayer layer) {
+    if (world->boxCount >= world->maxBoxes) {
+        return NULL;
+    }
+
+    cpFloat mass = 1.0f;
+    int slot = boxPoolAcquire(&world->pool, mass, width, height);
+    if (slot < 0) {
+        return NULL;
+    }
+
+    cpBody *body = cpSpaceAddBody(world->space, boxPoolBody(&world->pool, slot));
+    cpBodySetPosition(body, position);
+
+    cpShape *shape = cpSpaceAddShape(world->space, boxPoolShape(&world->pool, slot));
+    cpShapeSetFriction(shape, 0.4f);
+    cpShapeSetFilter(shape, world->filters[layer]);
+
+    Box *box = &world->boxes[world->boxCount++];
+    box->body = body;
+    box->shape = shape;
+    box->width = width;
+    box->height = height;
+    box->slot = slot;
+    box->layer = layer;
+    box->lod = LOD_FULL;
+    return box;
+}
+
+// cpBodyEachConstraint fetches the next joint before calling us, so removing is safe
+static void removeBodyJoint(cpBody *body, cpConstraint *joint, void *data) {
+    (void)body;
+    removeJoint(data, joint);
+}
+
+void despawnBox(World *world, int index) {
+    Box *box = &world->boxes[index];
+    cpBodyEachConstraint(box->body, removeBodyJoint, world);
+    cpSpaceRemoveShape(world->space, box->shape);
+    cpSpaceRemoveBody(world->space, box->body);
+    boxPoolRelease(&world->pool, box->slot);
+
+    if (box->body == world->playerBody) {
+        world->playerBody = NULL;
+        world->playerShape = NULL;
+    }
+
+    world->boxes[index] = world->boxes[--world->boxCount];
+}
+
+cpConstraint *addJoint(World *world, JointType type, cpBody *a, cpBody *b,
+                       cpVect anchorA, cpVect anchorB, cpFloat min, cpFloat max) {
+    cpConstraint *joint = jointPoolAcquire(&world->jointPool, type, a, b, anchorA, anchorB, min, max);
+    if (!joint) {
+        return NULL;
+    }
+    cpConstraintSetCollideBodies(joint, cpFalse);
+    cpSpaceAddConstraint(world->space, joint);
+
+    // The user data holds the joint's index in `joints` so removal is O(1)
+    cpConstraintSetUserData(joint, (cpDataPointer)(intptr_t)world->jointCount);
+    world->joints[world->jointCount++] = joint;
+    return joint;
+}
+
+void removeJoint(World *world, cpConstraint *joint) {
+    int index = (int)(intptr_t)cpConstraintGetUserData(joint);
+    cpConstraint *last = world->joints[--world->jointCount];
+    world->joints[index] = last;
+    cpConstraintSetUserData(last, (cpDataPointer)(intptr_t)index);
+
+    cpSpaceRemoveConstraint(world->space, joint);
+    jointPoolRelease(&world->jointPool, joint);
+}
+
+static void countJoint(cpBody *body, cpConstraint *joint, void *data) {
+    (void)body;
+    (void)joint;
+    (*(int *)data)++;
+}
+
+bool bodyHasJoints(cpBody *body) {
+    int joints = 0;
+    cpBodyEachConstraint(body, countJoint, &joints);
+    return joints > 0;
+}
+
+int despawnOutOfBounds(World *world) {
+    int removed = 0;
+    for (int i = world->boxCount - 1; i >= 0; i--) {
+        Box *box = &world->boxes[i];
+        if (box->body == world->playerBody) {
+            continue;
+        }
+
+        cpVect pos = cpBodyGetPosition(box->body);
+        if (pos.x < world->minX - WORLD_DESPAWN_MARGIN || pos.x > world->maxX + WORLD_DESPAWN_MARGIN ||
+            pos.y < -WORLD_DESPAWN_MARGIN) {
+            despawnBox(world, i);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+Box *spawnPlayer(World *world) {
+    Box *player = spawnBoxOnLayer(world, cpv(WINDOW_WIDTH / 2, WINDOW_HEIGHT - 50),
+                                  BOX_SIZE, BOX_SIZE, LAYER_PLAYER);
+    if (player) {
+        world->playerBody = player->body;
+        world->playerShape = player->shape;
+    }
+    return player;
+}
+
+typedef struct {
+    cpBody *self;
+    bool hit;
+} GroundQuery;
+
+// Any shape under the player counts except its own; other players are ground too
+static void groundHit(cpShape *shape, cpVect point, cpVect normal, cpFloat alpha, void *data) {
+    (void)point;
+    (void)normal;
+    (void)alpha;
+    GroundQuery *query = data;
+    if (cpShapeGetBody(shape) != query->self) {
+        query->hit = true;
+    }
+}
+
+// Check if player is on any surface (ground or other boxes) using collision detection
+bool isOnGround(cpSpace *space, cpBody *body) {
+    cpVect pos = cpBodyGetPosition(body);
+    cpVect vel = cpBodyGetVelocity(body);
+
+    // Don't allow jumping if moving upward quickly
+    if (vel.y > 10.0f) {
+        return false;
+    }
+
+    // Cast a short ray downward from the bottom of the player box
+    cpVect start = cpv(pos.x, pos.y - BOX_SIZE/2);
+    cpVect end = cpv(pos.x, pos.y - BOX_SIZE/2 - 10.0f); // Check 10 pixels below
+
+    // Only surfaces you can stand on; triggers are skipped, and so is our own shape in the callback
+    cpShapeFilter filter = layerQueryFilter(LAYER_BIT(LAYER_STATIC) | LAYER_BIT(LAYER_PROPS) |
+                                            LAYER_BIT(LAYER_DEBRIS) | LAYER_BIT(LAYER_PLAYER));
+
+    // Perform ray cast to detect any surface below
+    GroundQuery query = {body, false};
+    cpSpaceSegmentQuery(space, start, end, 0.0f, filter, groundHit, &query);
+
+    // Also check if we're very close to the static ground level
+    bool nearGround = (pos.y <= GROUND_HEIGHT + BOX_SIZE/2 + 5.0f);
+
+    return query.hit || nearGround;
+}
+
+// Apply player movement forces
+bool updatePlayerMovement(cpSpace *space, cpBody *playerBody, bool left, bool right, bool jump) {
+    cpVect vel = cpBodyGetVelocity(playerBody);
+    cpVect pos = cpBodyGetPosition(playerBody);
+
+    // Limit rotation to prevent coordinate system flipping
+    cpFloat angVel = cpBodyGetAngularVelocity(playerBody);
+    if (fabs(angVel) > 2.0f) {
+        cpBodySetAngularVelocity(playerBody, angVel * 0.5f); // Dampen rotation
+    }
+
+    // Keep player mostly upright
+    cpFloat angle = cpBodyGetAngle(playerBody);
+    if (fabs(angle) > M_PI/6) { // If rotated more than 30 degrees
+        cpBodySetAngle(playerBody, angle * 0.9f); // Gradually return to upright
+    }
+
+    // Horizontal movement - use WORLD coordinates, not local
+    if (left && vel.x > -MAX_HORIZONTAL_SPEED) {
+        cpBodyApplyForceAtWorldPoint(playerBody, cpv(-PLAYER_MOVE_FORCE, 0), pos);
+    }
+    if (right && vel.x < MAX_HORIZONTAL_SPEED) {
+        cpBodyApplyForceAtWorldPoint(playerBody, cpv(PLAYER_MOVE_FORCE, 0), pos);
+    }
+
+    // Apply horizontal damping for better control
+    if (!left && !right) {
+        cpFloat damping = 0.8f;
+        cpBodySetVelocity(playerBody, cpv(vel.x * damping, vel.y));
+    }
+
+    // Jumping - use WORLD coordinates
+    if (jump && isOnGround(space, playerBody)) {
+        cpBodyApplyImpulseAtWorldPoint(playerBody, cpv(0, PLAYER_JUMP_IMPULSE), pos);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,130 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <chipmunk/chipmunk.h>
+#include <stdbool.h>
+#include "boxpool.h"
+#include "jointpool.h"
+#include "layers.h"
+
+#define WINDOW_WIDTH 800
+#define WINDOW_HEIGHT 600
+#define BOX_SIZE 50
+#define GROUND_HEIGHT 50
+#define MAX_BOXES 8192
+
+// Joint pool size per box slot; no linkage uses more than two joints per body
+#define WORLD_JOINTS_PER_BOX 2
+
+// Boxes further than this outside the window are despawned
+#define WORLD_DESPAWN_MARGIN 200
+
+// Player movement constants
+#define PLAYER_MOVE_FORCE 1500.0f
+#define PLAYER_JUMP_IMPULSE 400.0f
+#define MAX_HORIZONTAL_SPEED 250.0f
+
+// Simulation level of detail, managed by lod.c
+typedef enum {
+    LOD_FULL,               // Stepped normally
+    LOD_SLEEPING,           // Put to sleep early because it is far away
+    LOD_FROZEN              // Static until approached; mass kept for thawing
+} LodTier;
+
+// Box structure to track multiple boxes
+typedef struct {
+    cpBody *body;
+    cpShape *shape;
+    cpFloat width, height;  // Physics size, used for rendering
+    int slot;               // Slot in the world's box pool
+    CollisionLayer layer;
+    LodTier lod;
+    cpFloat lodMass, lodMoment; // Restored when a frozen box thaws
+} Box;
+
+// Physics world: space, static ground and every spawned box
+typedef struct {
+    cpSpace *space;
+    cpShape *ground;
+    Box *boxes;
+    int boxCount;
+    int maxBoxes;
+    BoxPool pool;           // Preallocated body/shape storage
+    cpConstraint **joints;  // Live joints, densely packed like `boxes`
+    int jointCount;
+    int maxJoints;
+    JointPool jointPool;    // Preallocated joint storage
+    cpBody *playerBody;     // NULL until spawnPlayer() is called
+    cpShape *playerShape;
+    cpFloat minX, maxX;                 // Horizontal extent; boxes beyond it (plus margin) despawn
+    CollisionMatrix layers;             // Which layers collide
+    cpShapeFilter filters[LAYER_COUNT]; // Compiled from `layers`
+} World;
+
+// Convert Chipmunk coordinates to SDL coordinates
+static inline void cpToSDL(cpVect pos, int *x, int *y) {
+    *x = (int)pos.x;
+    *y = WINDOW_HEIGHT - (int)pos.y;
+}
+
+// Convert SDL coordinates to Chipmunk coordinates
+static inline cpVect sdlToCP(int x, int y) {
+    return cpv(x, WINDOW_HEIGHT - y);
+}
+
+// Create space, gravity and ground. Returns false on allocation failure.
+bool createWorld(World *world, int maxBoxes);
+
+// Free every box, the ground and the space
+void destroyWorld(World *world);
+
+// Remove the built-in ground segment (level geometry provides its own)
+void removeGround(World *world);
+
+// Replace the collision matrix and refilter every existing shape
+void setCollisionMatrix(World *world, const CollisionMatrix *matrix);
+
+// Id Chipmunk gives the next shape added to the space
+cpHashValue worldNextShapeId(const World *world);
+
+// Remove and re-add every box shape, with ids counted from `firstShapeId`, so
+// the space's cached contacts and broadphase tree depend only on body state.
+// Drops every arbiter, so the next step can't warm-start.
+void worldReaddBoxShapes(World *world, cpHashValue firstShapeId);
+
+// Spawn a box from the pool. Returns NULL when the world is full.
+// The returned pointer is only valid until the next despawn.
+Box *spawnBox(World *world, cpVect position, cpFloat width, cpFloat height);
+
+// Same as spawnBox, on a specific collision layer (spawnBox uses LAYER_PROPS)
+Box *spawnBoxOnLayer(World *world, cpVect position, cpFloat width, cpFloat height, CollisionLayer layer);
+
+// Remove a box and its joints from the space and recycle its pool slot.
+// The last box moves into `index`.
+void despawnBox(World *world, int index);
+
+// Despawn every non-player box that has left the world. Returns the number removed.
+int despawnOutOfBounds(World *world);
+
+// Connect two bodies with a joint from the pool. Anchors are body-local; min and
+// max only apply to JOINT_SLIDE. Jointed bodies don't collide with each other.
+// Returns NULL when the pool is full.
+cpConstraint *addJoint(World *world, JointType type, cpBody *a, cpBody *b,
+                       cpVect anchorA, cpVect anchorB, cpFloat min, cpFloat max);
+
+// Remove a joint from the space and recycle its pool slot
+void removeJoint(World *world, cpConstraint *joint);
+
+// True when any joint is attached to the body
+bool bodyHasJoints(cpBody *body);
+
+// Spawn the player box at the top center of the window
+Box *spawnPlayer(World *world);
+
+// Check if player is on any surface (ground or other boxes) using collision detection
+bool isOnGround(cpSpace *space, cpBody *body);
+
+// Apply player movement forces. Returns true if the player jumped this tick.
+bool updatePlayerMovement(cpSpace *space, cpBody *playerBody, bool left, bool right, bool jump);
+
+#endif // WORLD_H